@@ -23,10 +23,24 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "client.h"
 #include "snd_local.h"
 
-#define INDEX_FILE_EXTENSION ".index.dat"
+#ifdef USE_LOCAL_HEADERS
+#	include "SDL_thread.h"
+#	include "SDL_mutex.h"
+#else
+#	include <SDL_thread.h>
+#	include <SDL_mutex.h>
+#endif
 
 #define MAX_RIFF_CHUNKS 16
 
+// Number of movi chunks, and bytes, that can be waiting for the writer
+// thread before the main thread blocks
+#define AVI_QUEUE_SIZE 8
+#define AVI_QUEUE_MAX_BYTES ( 32 * 1024 * 1024 )
+
+#define AVI_INDEX_ENTRY_SIZE 16
+#define AVI_INDEX_MIN_SIZE ( AVI_INDEX_ENTRY_SIZE * 1024 )
+
 typedef struct audioFormat_s
 {
   int rate;
@@ -47,7 +61,8 @@ typedef struct aviFileData_s
   int           moviOffset;
   int           moviSize;
 
-  fileHandle_t  idxF;
+  byte          *index;
+  int           indexSize;
   int           numIndices;
 
   int           frameRate;
@@ -69,6 +84,37 @@ typedef struct aviFileData_s
 
 static aviFileData_t afd;
 
+typedef struct aviChunk_s
+{
+  char          id[ 4 ];
+  byte          *data;
+  int           size;
+  int           allocSize;
+} aviChunk_t;
+
+// Chunks are copied into a bounded ring on the main thread and written
+// to disk by a separate thread so that file I/O never stalls a frame.
+// The thread only uses stdio on the file, the file system and console
+// are left to the main thread.  Chunk buffers come from malloc, as a
+// few raw frames at high resolutions would not fit the zone
+typedef struct aviWriter_s
+{
+  SDL_Thread    *thread;
+  SDL_mutex     *lock;
+  SDL_cond      *cond;
+  FILE          *file;
+
+  aviChunk_t    chunks[ AVI_QUEUE_SIZE ];
+  int           head;   // next chunk to be written
+  int           tail;   // next free slot
+  int           queuedBytes;
+
+  qboolean      quit;
+  qboolean      failed;
+} aviWriter_t;
+
+static aviWriter_t aviWriter;
+
 #define MAX_AVI_BUFFER 2048
 
 static byte buffer[ MAX_AVI_BUFFER ];
@@ -85,6 +131,240 @@ static ID_INLINE void SafeFS_Write( const void *buffer, int len, fileHandle_t f
     Com_Error( ERR_DROP, "Failed to write avi file" );
 }
 
+/*
+===============
+CL_AVIWriterThread
+
+Writes queued movi chunks to the avi file
+===============
+*/
+static int CL_AVIWriterThread( void *arg )
+{
+  aviChunk_t  *chunk;
+  byte        header[ 8 ];
+  byte        padding[ 4 ] = { 0 };
+  int         paddingSize;
+  qboolean    failed;
+
+  while( 1 )
+  {
+    SDL_LockMutex( aviWriter.lock );
+    while( aviWriter.head == aviWriter.tail && !aviWriter.quit )
+      SDL_CondWait( aviWriter.cond, aviWriter.lock );
+
+    if( aviWriter.head == aviWriter.tail )
+    {
+      SDL_UnlockMutex( aviWriter.lock );
+      break;
+    }
+
+    chunk = &aviWriter.chunks[ aviWriter.head % AVI_QUEUE_SIZE ];
+    failed = aviWriter.failed;
+    SDL_UnlockMutex( aviWriter.lock );
+
+    Com_Memcpy( header, chunk->id, 4 );
+    header[ 4 ] = (byte)( ( chunk->size >>  0 ) & 0xFF );
+    header[ 5 ] = (byte)( ( chunk->size >>  8 ) & 0xFF );
+    header[ 6 ] = (byte)( ( chunk->size >> 16 ) & 0xFF );
+    header[ 7 ] = (byte)( ( chunk->size >> 24 ) & 0xFF );
+    paddingSize = PADLEN( chunk->size, 2 );
+
+    // errors can't be thrown from here, the main thread picks them up
+    if( !failed )
+    {
+      if( fwrite( header, 1, 8, aviWriter.file ) != 8 ||
+          fwrite( chunk->data, 1, chunk->size, aviWriter.file ) != chunk->size ||
+          fwrite( padding, 1, paddingSize, aviWriter.file ) != paddingSize )
+        failed = qtrue;
+    }
+
+    SDL_LockMutex( aviWriter.lock );
+    aviWriter.failed = failed;
+    aviWriter.queuedBytes -= chunk->size;
+    aviWriter.head++;
+    SDL_CondBroadcast( aviWriter.cond );
+    SDL_UnlockMutex( aviWriter.lock );
+  }
+
+  return 0;
+}
+
+/*
+===============
+CL_AVIStartWriter
+===============
+*/
+static qboolean CL_AVIStartWriter( void )
+{
+  aviWriter.head = aviWriter.tail = 0;
+  aviWriter.queuedBytes = 0;
+  aviWriter.quit = qfalse;
+  aviWriter.failed = qfalse;
+
+  aviWriter.file = FS_FileForHandle( afd.f );
+  aviWriter.lock = SDL_CreateMutex( );
+  aviWriter.cond = SDL_CreateCond( );
+
+  if( aviWriter.lock && aviWriter.cond )
+    aviWriter.thread = SDL_CreateThread( CL_AVIWriterThread, NULL );
+
+  if( !aviWriter.thread )
+  {
+    Com_Printf( S_COLOR_RED "Failed to start avi writer thread\n" );
+
+    if( aviWriter.cond )
+      SDL_DestroyCond( aviWriter.cond );
+    if( aviWriter.lock )
+      SDL_DestroyMutex( aviWriter.lock );
+
+    aviWriter.cond = NULL;
+    aviWriter.lock = NULL;
+    return qfalse;
+  }
+
+  return qtrue;
+}
+
+/*
+===============
+CL_AVIStopWriter
+
+Blocks until all queued chunks are on disk
+===============
+*/
+static qboolean CL_AVIStopWriter( void )
+{
+  int       i;
+  qboolean  failed;
+
+  if( !aviWriter.thread )
+    return qfalse;
+
+  SDL_LockMutex( aviWriter.lock );
+  aviWriter.quit = qtrue;
+  SDL_CondBroadcast( aviWriter.cond );
+  SDL_UnlockMutex( aviWriter.lock );
+
+  SDL_WaitThread( aviWriter.thread, NULL );
+
+  SDL_LockMutex( aviWriter.lock );
+  failed = aviWriter.failed;
+  SDL_UnlockMutex( aviWriter.lock );
+
+  SDL_DestroyCond( aviWriter.cond );
+  SDL_DestroyMutex( aviWriter.lock );
+
+  aviWriter.thread = NULL;
+  aviWriter.cond = NULL;
+  aviWriter.lock = NULL;
+  aviWriter.file = NULL;
+
+  for( i = 0; i < AVI_QUEUE_SIZE; i++ )
+  {
+    free( aviWriter.chunks[ i ].data );
+
+    aviWriter.chunks[ i ].data = NULL;
+    aviWriter.chunks[ i ].allocSize = 0;
+  }
+
+  return !failed;
+}
+
+/*
+===============
+CL_AVIQueueChunk
+
+Copies a movi chunk into the writer ring, blocking if it is full
+===============
+*/
+static void CL_AVIQueueChunk( const char *id, const byte *data, int size )
+{
+  aviChunk_t  *chunk;
+  qboolean    failed;
+
+  SDL_LockMutex( aviWriter.lock );
+  failed = aviWriter.failed;
+  SDL_UnlockMutex( aviWriter.lock );
+
+  if( failed )
+    Com_Error( ERR_DROP, "Failed to write avi file" );
+
+  // a chunk bigger than the byte limit still goes in once the ring is empty
+  SDL_LockMutex( aviWriter.lock );
+  while( aviWriter.tail - aviWriter.head >= AVI_QUEUE_SIZE ||
+      ( aviWriter.tail != aviWriter.head &&
+        aviWriter.queuedBytes + size > AVI_QUEUE_MAX_BYTES ) )
+    SDL_CondWait( aviWriter.cond, aviWriter.lock );
+  SDL_UnlockMutex( aviWriter.lock );
+
+  // the slot is free, so the writer thread won't touch it
+  chunk = &aviWriter.chunks[ aviWriter.tail % AVI_QUEUE_SIZE ];
+  if( chunk->allocSize < size )
+  {
+    free( chunk->data );
+
+    chunk->allocSize = size;
+    chunk->data = malloc( chunk->allocSize );
+    if( !chunk->data )
+    {
+      chunk->allocSize = 0;
+      Com_Error( ERR_DROP, "Out of memory for avi chunk of %d bytes", size );
+    }
+  }
+
+  Com_Memcpy( chunk->id, id, 4 );
+  Com_Memcpy( chunk->data, data, size );
+  chunk->size = size;
+
+  SDL_LockMutex( aviWriter.lock );
+  aviWriter.queuedBytes += size;
+  aviWriter.tail++;
+  SDL_CondBroadcast( aviWriter.cond );
+  SDL_UnlockMutex( aviWriter.lock );
+}
+
+/*
+===============
+CL_AVIAddIndex
+
+Appends an idx1 entry; the index lives in memory until CL_CloseAVI,
+doubling in size as it fills
+===============
+*/
+static void CL_AVIAddIndex( const char *id, int flags, int offset, int size )
+{
+  byte  *entry;
+
+  if( ( afd.numIndices + 1 ) * AVI_INDEX_ENTRY_SIZE > afd.indexSize )
+  {
+    int   newSize = afd.indexSize ? afd.indexSize * 2 : AVI_INDEX_MIN_SIZE;
+    byte  *newIndex = realloc( afd.index, newSize );
+
+    if( !newIndex )
+      Com_Error( ERR_DROP, "Out of memory for avi index of %d bytes", newSize );
+
+    afd.index = newIndex;
+    afd.indexSize = newSize;
+  }
+
+  entry = afd.index + afd.numIndices * AVI_INDEX_ENTRY_SIZE;
+  Com_Memcpy( entry, id, 4 );
+  entry[ 4 ] = (byte)( ( flags >>  0 ) & 0xFF );
+  entry[ 5 ] = (byte)( ( flags >>  8 ) & 0xFF );
+  entry[ 6 ] = (byte)( ( flags >> 16 ) & 0xFF );
+  entry[ 7 ] = (byte)( ( flags >> 24 ) & 0xFF );
+  entry[ 8 ] = (byte)( ( offset >>  0 ) & 0xFF );
+  entry[ 9 ] = (byte)( ( offset >>  8 ) & 0xFF );
+  entry[ 10 ] = (byte)( ( offset >> 16 ) & 0xFF );
+  entry[ 11 ] = (byte)( ( offset >> 24 ) & 0xFF );
+  entry[ 12 ] = (byte)( ( size >>  0 ) & 0xFF );
+  entry[ 13 ] = (byte)( ( size >>  8 ) & 0xFF );
+  entry[ 14 ] = (byte)( ( size >> 16 ) & 0xFF );
+  entry[ 15 ] = (byte)( ( size >> 24 ) & 0xFF );
+
+  afd.numIndices++;
+}
+
 /*
 ===============
 WRITE_STRING
@@ -349,13 +629,6 @@ qboolean CL_OpenAVIForWriting( const char *fileName )
   if( ( afd.f = FS_FOpenFileWrite( fileName ) ) <= 0 )
     return qfalse;
 
-  if( ( afd.idxF = FS_FOpenFileWrite(
-          va( "%s" INDEX_FILE_EXTENSION, fileName ) ) ) <= 0 )
-  {
-    FS_FCloseFile( afd.f );
-    return qfalse;
-  }
-
   Q_strncpyz( afd.fileName, fileName, MAX_QPATH );
 
   afd.frameRate = cl_aviFrameRate->integer;
@@ -422,9 +695,13 @@ qboolean CL_OpenAVIForWriting( const char *fileName )
   SafeFS_Write( buffer, bufIndex, afd.f );
   afd.fileSize = bufIndex;
 
-  bufIndex = 0;
-  START_CHUNK( "idx1" );
-  SafeFS_Write( buffer, bufIndex, afd.idxF );
+  if( !CL_AVIStartWriter( ) )
+  {
+    Z_Free( afd.cBuffer );
+    Z_Free( afd.eBuffer );
+    FS_FCloseFile( afd.f );
+    return qfalse;
+  }
 
   afd.moviSize = 4; // For the "movi"
   afd.fileOpen = qtrue;
@@ -473,7 +750,6 @@ void CL_WriteAVIVideoFrame( const byte *imageBuffer, int size )
   int   chunkOffset = afd.fileSize - afd.moviOffset - 8;
   int   chunkSize = 8 + size;
   int   paddingSize = PADLEN(size, 2);
-  byte  padding[ 4 ] = { 0 };
 
   if( !afd.fileOpen )
     return;
@@ -482,13 +758,7 @@ void CL_WriteAVIVideoFrame( const byte *imageBuffer, int size )
   if( CL_CheckFileSize( 8 + size + 2 ) )
     return;
 
-  bufIndex = 0;
-  WRITE_STRING( "00dc" );
-  WRITE_4BYTES( size );
-
-  SafeFS_Write( buffer, 8, afd.f );
-  SafeFS_Write( imageBuffer, size, afd.f );
-  SafeFS_Write( padding, paddingSize, afd.f );
+  CL_AVIQueueChunk( "00dc", imageBuffer, size );
   afd.fileSize += ( chunkSize + paddingSize );
 
   afd.numVideoFrames++;
@@ -497,15 +767,8 @@ void CL_WriteAVIVideoFrame( const byte *imageBuffer, int size )
   if( size > afd.maxRecordSize )
     afd.maxRecordSize = size;
 
-  // Index
-  bufIndex = 0;
-  WRITE_STRING( "00dc" );           //dwIdentifier
-  WRITE_4BYTES( 0x00000010 );       //dwFlags (all frames are KeyFrames)
-  WRITE_4BYTES( chunkOffset );      //dwOffset
-  WRITE_4BYTES( size );             //dwLength
-  SafeFS_Write( buffer, 16, afd.idxF );
-
-  afd.numIndices++;
+  // Index (all frames are KeyFrames)
+  CL_AVIAddIndex( "00dc", 0x00000010, chunkOffset, size );
 }
 
 #define PCM_BUFFER_SIZE 44100
@@ -547,15 +810,8 @@ void CL_WriteAVIAudioFrame( const byte *pcmBuffer, int size )
     int   chunkOffset = afd.fileSize - afd.moviOffset - 8;
     int   chunkSize = 8 + bytesInBuffer;
     int   paddingSize = PADLEN(bytesInBuffer, 2);
-    byte  padding[ 4 ] = { 0 };
 
-    bufIndex = 0;
-    WRITE_STRING( "01wb" );
-    WRITE_4BYTES( bytesInBuffer );
-
-    SafeFS_Write( buffer, 8, afd.f );
-    SafeFS_Write( pcmCaptureBuffer, bytesInBuffer, afd.f );
-    SafeFS_Write( padding, paddingSize, afd.f );
+    CL_AVIQueueChunk( "01wb", pcmCaptureBuffer, bytesInBuffer );
     afd.fileSize += ( chunkSize + paddingSize );
 
     afd.numAudioFrames++;
@@ -563,14 +819,7 @@ void CL_WriteAVIAudioFrame( const byte *pcmBuffer, int size )
     afd.a.totalBytes += bytesInBuffer;
 
     // Index
-    bufIndex = 0;
-    WRITE_STRING( "01wb" );           //dwIdentifier
-    WRITE_4BYTES( 0 );                //dwFlags
-    WRITE_4BYTES( chunkOffset );      //dwOffset
-    WRITE_4BYTES( bytesInBuffer );    //dwLength
-    SafeFS_Write( buffer, 16, afd.idxF );
-
-    afd.numIndices++;
+    CL_AVIAddIndex( "01wb", 0, chunkOffset, bytesInBuffer );
 
     bytesInBuffer = 0;
   }
@@ -595,54 +844,52 @@ void CL_TakeVideoFrame( void )
 ===============
 CL_CloseAVI
 
-Closes the AVI file and writes an index chunk
+Waits for the writer thread, then appends the index chunk
 ===============
 */
 qboolean CL_CloseAVI( void )
 {
-  int indexRemainder;
-  int indexSize = afd.numIndices * 16;
-  const char *idxFileName = va( "%s" INDEX_FILE_EXTENSION, afd.fileName );
+  int indexSize = afd.numIndices * AVI_INDEX_ENTRY_SIZE;
+  qboolean written;
 
   // AVI file isn't open
   if( !afd.fileOpen )
     return qfalse;
 
+  // the last captured frame is still waiting on its readback
+  if( re.FlushVideoFrame )
+    re.FlushVideoFrame( afd.width, afd.height,
+        afd.cBuffer, afd.eBuffer, afd.motionJpeg );
+
   afd.fileOpen = qfalse;
 
-  FS_Seek( afd.idxF, 4, FS_SEEK_SET );
-  bufIndex = 0;
-  WRITE_4BYTES( indexSize );
-  SafeFS_Write( buffer, bufIndex, afd.idxF );
-  FS_FCloseFile( afd.idxF );
+  written = CL_AVIStopWriter( );
 
-  // Write index
+  Z_Free( afd.cBuffer );
+  Z_Free( afd.eBuffer );
 
-  // Open the temp index file
-  if( ( indexSize = FS_FOpenFileRead( idxFileName,
-          &afd.idxF, qtrue ) ) <= 0 )
+  if( !written )
   {
+    free( afd.index );
     FS_FCloseFile( afd.f );
+    Com_Printf( S_COLOR_RED "Failed to write avi file %s\n", afd.fileName );
     return qfalse;
   }
 
-  indexRemainder = indexSize;
+  // Write index
+  bufIndex = 0;
+  WRITE_STRING( "idx1" );
+  WRITE_4BYTES( indexSize );
+  SafeFS_Write( buffer, bufIndex, afd.f );
+  afd.fileSize += bufIndex;
 
-  // Append index to end of avi file
-  while( indexRemainder > MAX_AVI_BUFFER )
+  if( indexSize > 0 )
   {
-    FS_Read( buffer, MAX_AVI_BUFFER, afd.idxF );
-    SafeFS_Write( buffer, MAX_AVI_BUFFER, afd.f );
-    afd.fileSize += MAX_AVI_BUFFER;
-    indexRemainder -= MAX_AVI_BUFFER;
+    SafeFS_Write( afd.index, indexSize, afd.f );
+    afd.fileSize += indexSize;
   }
-  FS_Read( buffer, indexRemainder, afd.idxF );
-  SafeFS_Write( buffer, indexRemainder, afd.f );
-  afd.fileSize += indexRemainder;
-  FS_FCloseFile( afd.idxF );
 
-  // Remove temp index file
-  FS_HomeRemove( idxFileName );
+  free( afd.index );
 
   // Write the real header
   FS_Seek( afd.f, 0, FS_SEEK_SET );
@@ -656,8 +903,6 @@ qboolean CL_CloseAVI( void )
 
   SafeFS_Write( buffer, bufIndex, afd.f );
 
-  Z_Free( afd.cBuffer );
-  Z_Free( afd.eBuffer );
   FS_FCloseFile( afd.f );
 
   Com_Printf( "Wrote %d:%d frames to %s\n", afd.numVideoFrames, afd.numAudioFrames, afd.fileName );
@@ -590,6 +590,10 @@ intptr_t CL_CgameSystemCalls( intptr_t *args ) {
 		return 0;
 	case CG_R_LERPTAG:
 		return re.LerpTag( VMA(1), args[2], args[3], args[4], VMF(5), VMA(6) );
+	case CG_R_REGISTERTAG:
+		return re.TagIndex( args[1], VMA(2) );
+	case CG_R_LERPTAGS:
+		return re.LerpTags( VMA(1), args[2], args[3], args[4], VMF(5), VMA(6), args[7] );
 	case CG_GETGLCONFIG:
 		CL_GetGlconfig( VMA(1) );
 		return 0;
@@ -796,8 +800,18 @@ CL_CGameRendering
 =====================
 */
 void CL_CGameRendering( stereoFrame_t stereo ) {
+	int		startTime = 0;
+
+	if ( clc.benchmark ) {
+		startTime = Sys_Milliseconds();
+	}
+
 	VM_Call( cgvm, CG_DRAW_ACTIVE_FRAME, cl.serverTime, stereo, clc.demoplaying );
 	VM_Debug( 0 );
+
+	if ( clc.benchmark ) {
+		clc.benchmarkCGameMsec += Sys_Milliseconds() - startTime;
+	}
 }
 
 
@@ -1077,7 +1091,11 @@ void CL_SetCGameTime( void ) {
 		}
 
 		clc.timeDemoFrames++;
-		cl.serverTime = clc.timeDemoBaseTime + clc.timeDemoFrames * 50;
+		if ( clc.benchmark ) {
+			cl.serverTime = clc.timeDemoBaseTime + clc.timeDemoFrames * cl_benchmarkMsec->integer;
+		} else {
+			cl.serverTime = clc.timeDemoBaseTime + clc.timeDemoFrames * 50;
+		}
 	}
 
 	while ( cl.serverTime >= cl.snap.serverTime ) {
@@ -70,9 +70,14 @@ cvar_t	*cl_showTimeDelta;
 cvar_t	*cl_freezeDemo;
 
 cvar_t	*cl_shownet;
+cvar_t	*cl_benchPlayerstate;
 cvar_t	*cl_showSend;
 cvar_t	*cl_timedemo;
 cvar_t	*cl_timedemoLog;
+cvar_t	*cl_benchmarkMsec;
+cvar_t	*cl_benchmarkSeed;
+cvar_t	*cl_benchmarkLog;
+cvar_t	*cl_benchmarkQuit;
 cvar_t	*cl_autoRecordDemo;
 cvar_t	*cl_aviFrameRate;
 cvar_t	*cl_aviMotionJpeg;
@@ -850,6 +855,151 @@ static float CL_DemoFrameDurationSDev( void )
 	return sqrt( variance );
 }
 
+/*
+=================
+CL_BenchmarkFrame
+
+Splits the cost of the frame that just finished into its stages
+=================
+*/
+static void CL_BenchmarkFrame( int frameMsec )
+{
+	short	*durations;
+	int		cgame, client;
+
+	if( !clc.benchmark || clc.state != CA_ACTIVE || clc.timeDemoFrames < 2 )
+	{
+		clc.benchmarkCGameMsec = 0;
+		return;
+	}
+
+	// the renderer front end runs from inside the cgame, the back end
+	// from SCR_UpdateScreen
+	cgame = clc.benchmarkCGameMsec - time_frontend;
+	client = frameMsec - clc.benchmarkCGameMsec - time_backend;
+
+	durations = clc.benchmarkDurations[ clc.benchmarkFrames % MAX_TIMEDEMO_DURATIONS ];
+	durations[ BENCH_TOTAL ] = frameMsec;
+	durations[ BENCH_CLIENT ] = MAX( client, 0 );
+	durations[ BENCH_CGAME ] = MAX( cgame, 0 );
+	durations[ BENCH_FRONTEND ] = time_frontend;
+	durations[ BENCH_BACKEND ] = time_backend;
+
+	clc.benchmarkFrames++;
+	clc.benchmarkCGameMsec = 0;
+}
+
+/*
+=================
+CL_BenchmarkCompare
+=================
+*/
+static int CL_BenchmarkCompare( const void *a, const void *b )
+{
+	return *(const int *)a - *(const int *)b;
+}
+
+/*
+=================
+CL_BenchmarkWriteStage
+
+Writes mean and percentile frame times of one stage
+=================
+*/
+static void CL_BenchmarkWriteStage( fileHandle_t f, const char *name,
+		benchStage_t stage, int numFrames, qboolean last )
+{
+	static int	sorted[ MAX_TIMEDEMO_DURATIONS ];
+	float		mean = 0.0f;
+	int			i;
+
+	for( i = 0; i < numFrames; i++ )
+	{
+		sorted[ i ] = clc.benchmarkDurations[ i ][ stage ];
+		mean += sorted[ i ];
+	}
+	mean /= numFrames;
+
+	qsort( sorted, numFrames, sizeof( int ), CL_BenchmarkCompare );
+
+	Com_Printf( "%-9s mean %5.2f  p50 %3d  p95 %3d  p99 %3d  max %3d ms\n", name, mean,
+			sorted[ ( numFrames - 1 ) * 50 / 100 ],
+			sorted[ ( numFrames - 1 ) * 95 / 100 ],
+			sorted[ ( numFrames - 1 ) * 99 / 100 ],
+			sorted[ numFrames - 1 ] );
+
+	if( f )
+	{
+		FS_Printf( f, "\t\t\"%s\": { \"mean\": %.3f, \"p50\": %d, \"p95\": %d, \"p99\": %d, \"max\": %d }%s\n",
+				name, mean,
+				sorted[ ( numFrames - 1 ) * 50 / 100 ],
+				sorted[ ( numFrames - 1 ) * 95 / 100 ],
+				sorted[ ( numFrames - 1 ) * 99 / 100 ],
+				sorted[ numFrames - 1 ],
+				last ? "" : "," );
+	}
+}
+
+/*
+=================
+CL_BenchmarkReport
+
+Prints the per stage frame time summary and writes it to
+cl_benchmarkLog as JSON
+=================
+*/
+static void CL_BenchmarkReport( int time )
+{
+	fileHandle_t	f = 0;
+	int				numFrames;
+
+	if( clc.benchmarkFrames > MAX_TIMEDEMO_DURATIONS )
+		numFrames = MAX_TIMEDEMO_DURATIONS;
+	else
+		numFrames = clc.benchmarkFrames;
+
+	if( numFrames <= 0 )
+	{
+		Com_Printf( "benchmark: no frames were profiled\n" );
+		return;
+	}
+
+	if( strlen( cl_benchmarkLog->string ) > 0 )
+	{
+		f = FS_FOpenFileWrite( cl_benchmarkLog->string );
+		if( !f )
+			Com_Printf( "Couldn't open %s for writing\n", cl_benchmarkLog->string );
+	}
+
+	if( f )
+	{
+		FS_Printf( f, "{\n" );
+		FS_Printf( f, "\t\"demo\": \"%s\",\n", clc.demoName );
+		FS_Printf( f, "\t\"version\": \"%s\",\n", Cvar_VariableString( "version" ) );
+		FS_Printf( f, "\t\"renderer\": \"%s\",\n", cls.glconfig.renderer_string );
+		FS_Printf( f, "\t\"frameMsec\": %d,\n", cl_benchmarkMsec->integer );
+		FS_Printf( f, "\t\"seed\": %d,\n", cl_benchmarkSeed->integer );
+		FS_Printf( f, "\t\"frames\": %d,\n", clc.timeDemoFrames );
+		FS_Printf( f, "\t\"profiledFrames\": %d,\n", numFrames );
+		FS_Printf( f, "\t\"seconds\": %.3f,\n", time / 1000.0 );
+		FS_Printf( f, "\t\"fps\": %.2f,\n", clc.timeDemoFrames * 1000.0 / time );
+		FS_Printf( f, "\t\"stages\": {\n" );
+	}
+
+	CL_BenchmarkWriteStage( f, "total", BENCH_TOTAL, numFrames, qfalse );
+	CL_BenchmarkWriteStage( f, "client", BENCH_CLIENT, numFrames, qfalse );
+	CL_BenchmarkWriteStage( f, "cgame", BENCH_CGAME, numFrames, qfalse );
+	CL_BenchmarkWriteStage( f, "frontend", BENCH_FRONTEND, numFrames, qfalse );
+	CL_BenchmarkWriteStage( f, "backend", BENCH_BACKEND, numFrames, qtrue );
+
+	if( f )
+	{
+		FS_Printf( f, "\t}\n}\n" );
+		FS_FCloseFile( f );
+		Com_Printf( "%s written\n", cl_benchmarkLog->string );
+	}
+}
+
 /*
 =================
 CL_DemoCompleted
@@ -858,6 +1008,10 @@ CL_DemoCompleted
 void CL_DemoCompleted( void )
 {
 	char buffer[ MAX_STRING_CHARS ];
+	qboolean benchmark = clc.benchmark;
+
+	if( cl_benchPlayerstate->integer )
+		MSG_ReportPlayerstateBenchmark();
 
 	if( cl_timedemo && cl_timedemo->integer )
 	{
@@ -908,10 +1062,25 @@ void CL_DemoCompleted( void )
 							cl_timedemoLog->string );
 				}
 			}
+
+			if( benchmark )
+				CL_BenchmarkReport( time );
 		}
 	}
 
 	CL_Disconnect( qtrue );
+
+	if( benchmark )
+	{
+		Cvar_Set( "timedemo", "0" );
+
+		if( cl_benchmarkQuit->integer )
+		{
+			Cbuf_AddText( "quit\n" );
+			return;
+		}
+	}
+
 	CL_NextDemo();
 }
 
@@ -975,7 +1144,7 @@ CL_WalkDemoExt
 */
 static int CL_WalkDemoExt(char *arg, char *name, int *demofile)
 {
-	int i = 0;
+	int i;
 	*demofile = 0;
 
 #ifdef LEGACY_PROTOCOL
@@ -1006,7 +1175,7 @@ static int CL_WalkDemoExt(char *arg, char *name, int *demofile)
 
 	Com_Printf("Not found: %s\n", name);
 
-	while(demo_protocols[i])
+	for(i = 0; demo_protocols[i]; i++)
 	{
 #ifdef LEGACY_PROTOCOL
 		if(demo_protocols[i] == com_legacyprotocol->integer)
@@ -1025,7 +1194,6 @@ static int CL_WalkDemoExt(char *arg, char *name, int *demofile)
 		}
 		else
 			Com_Printf("Not found: %s\n", name);
-		i++;
 	}
 	
 	return -1;
@@ -1125,6 +1293,7 @@ void CL_PlayDemo_f( void ) {
 
 	clc.state = CA_CONNECTED;
 	clc.demoplaying = qtrue;
+	clc.protocol = protocol;
 	Q_strncpyz( clc.servername, Cmd_Argv(1), sizeof( clc.servername ) );
 
 #ifdef LEGACY_PROTOCOL
@@ -1144,6 +1313,39 @@ void CL_PlayDemo_f( void ) {
 }
 
 
+/*
+====================
+CL_Benchmark_f
+
+benchmark <demoname>
+
+Plays back a demo as a timedemo with a fixed frame step and random seed,
+then reports per stage frame times
+====================
+*/
+void CL_Benchmark_f( void ) {
+	if (Cmd_Argc() != 2) {
+		Com_Printf ("benchmark <demoname>\n");
+		return;
+	}
+
+	if ( cl_benchmarkMsec->integer < 1 ) {
+		Cvar_Set( "cl_benchmarkMsec", "1" );
+	}
+
+	Cvar_Set( "timedemo", "1" );
+	CL_PlayDemo_f();
+
+	if ( !clc.demoplaying ) {
+		Cvar_Set( "timedemo", "0" );
+		return;
+	}
+
+	clc.benchmark = qtrue;
+	srand( cl_benchmarkSeed->integer );
+}
+
+
 /*
 ====================
 CL_StartDemoLoop
@@ -2237,10 +2439,12 @@ void CL_CheckForResend( void ) {
 			clc.compat = qtrue;
 
 		if(clc.compat)
-			Info_SetValueForKey(info, "protocol", va("%i", com_legacyprotocol->integer));
+			clc.protocol = com_legacyprotocol->integer;
 		else
 #endif
-			Info_SetValueForKey(info, "protocol", va("%i", com_protocol->integer));
+			clc.protocol = com_protocol->integer;
+
+		Info_SetValueForKey(info, "protocol", va("%i", clc.protocol));
 		Info_SetValueForKey( info, "qport", va("%i", port ) );
 		Info_SetValueForKey( info, "challenge", va("%i", clc.challenge ) );
 		
@@ -2811,11 +3015,16 @@ CL_Frame
 ==================
 */
 void CL_Frame ( int msec ) {
+	int		frameStart = 0;
 
 	if ( !com_cl_running->integer ) {
 		return;
 	}
 
+	if ( clc.benchmark ) {
+		frameStart = Sys_Milliseconds();
+	}
+
 #ifdef USE_CURL
 	if(clc.downloadCURLM) {
 		CL_cURL_PerformDownload();
@@ -2941,6 +3150,10 @@ void CL_Frame ( int msec ) {
 
 	Con_RunConsole();
 
+	if ( clc.benchmark ) {
+		CL_BenchmarkFrame( Sys_Milliseconds() - frameStart );
+	}
+
 	cls.framecount++;
 }
 
@@ -3339,6 +3552,7 @@ void CL_Init( void ) {
 
 	cl_timeNudge = Cvar_Get ("cl_timeNudge", "0", CVAR_TEMP );
 	cl_shownet = Cvar_Get ("cl_shownet", "0", CVAR_TEMP );
+	cl_benchPlayerstate = Cvar_Get ("cl_benchPlayerstate", "0", CVAR_TEMP );
 	cl_showSend = Cvar_Get ("cl_showSend", "0", CVAR_TEMP );
 	cl_showTimeDelta = Cvar_Get ("cl_showTimeDelta", "0", CVAR_TEMP );
 	cl_freezeDemo = Cvar_Get ("cl_freezeDemo", "0", CVAR_TEMP );
@@ -3347,6 +3561,10 @@ void CL_Init( void ) {
 
 	cl_timedemo = Cvar_Get ("timedemo", "0", 0);
 	cl_timedemoLog = Cvar_Get ("cl_timedemoLog", "", CVAR_ARCHIVE);
+	cl_benchmarkMsec = Cvar_Get ("cl_benchmarkMsec", "16", 0);
+	cl_benchmarkSeed = Cvar_Get ("cl_benchmarkSeed", "0", 0);
+	cl_benchmarkLog = Cvar_Get ("cl_benchmarkLog", "benchmark.json", 0);
+	cl_benchmarkQuit = Cvar_Get ("cl_benchmarkQuit", "1", 0);
 	cl_autoRecordDemo = Cvar_Get ("cl_autoRecordDemo", "0", CVAR_ARCHIVE);
 	cl_aviFrameRate = Cvar_Get ("cl_aviFrameRate", "25", CVAR_ARCHIVE);
 	cl_aviMotionJpeg = Cvar_Get ("cl_aviMotionJpeg", "1", CVAR_ARCHIVE);
@@ -3492,7 +3710,9 @@ void CL_Init( void ) {
 	Cmd_AddCommand ("disconnect", CL_Disconnect_f);
 	Cmd_AddCommand ("record", CL_Record_f);
 	Cmd_AddCommand ("demo", CL_PlayDemo_f);
+	Cmd_AddCommand ("benchmark", CL_Benchmark_f);
 	Cmd_SetCommandCompletionFunc( "demo", CL_CompleteDemoName );
+	Cmd_SetCommandCompletionFunc( "benchmark", CL_CompleteDemoName );
 	Cmd_AddCommand ("cinematic", CL_PlayCinematic_f);
 	Cmd_AddCommand ("stoprecord", CL_StopRecord_f);
 	Cmd_AddCommand ("connect", CL_Connect_f);
@@ -3563,6 +3783,7 @@ void CL_Shutdown(char *finalmsg, qboolean disconnect, qboolean quit)
 	Cmd_RemoveCommand ("disconnect");
 	Cmd_RemoveCommand ("record");
 	Cmd_RemoveCommand ("demo");
+	Cmd_RemoveCommand ("benchmark");
 	Cmd_RemoveCommand ("cinematic");
 	Cmd_RemoveCommand ("stoprecord");
 	Cmd_RemoveCommand ("connect");
@@ -273,9 +273,14 @@ void CL_ParseSnapshot( msg_t *msg ) {
 	// read playerinfo
 	SHOWNET( msg, "playerstate" );
 	if ( old ) {
-		MSG_ReadDeltaPlayerstate( msg, &old->ps, &newSnap.ps );
+		MSG_ReadDeltaPlayerstate( msg, &old->ps, &newSnap.ps, clc.protocol );
 	} else {
-		MSG_ReadDeltaPlayerstate( msg, NULL, &newSnap.ps );
+		MSG_ReadDeltaPlayerstate( msg, NULL, &newSnap.ps, clc.protocol );
+	}
+
+	// size both encodings of the delta the server sent
+	if ( cl_benchPlayerstate->integer ) {
+		MSG_BenchmarkPlayerstate( old ? &old->ps : NULL, &newSnap.ps );
 	}
 
 	// read packet entities
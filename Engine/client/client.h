@@ -163,6 +163,17 @@ demo through a file.
 
 #define MAX_TIMEDEMO_DURATIONS	4096
 
+// per-frame cost buckets recorded by the benchmark command
+typedef enum {
+	BENCH_TOTAL,
+	BENCH_CLIENT,
+	BENCH_CGAME,
+	BENCH_FRONTEND,
+	BENCH_BACKEND,
+
+	BENCH_NUM_STAGES
+} benchStage_t;
+
 typedef struct {
 
 	connstate_t	state;				// connection status
@@ -236,6 +247,11 @@ typedef struct {
 	int			timeDemoMaxDuration;	// maximum frame duration
 	unsigned char	timeDemoDurations[ MAX_TIMEDEMO_DURATIONS ];	// log of frame durations
 
+	qboolean	benchmark;			// timedemo started with the benchmark command
+	int			benchmarkFrames;	// counter of profiled frames
+	int			benchmarkCGameMsec;	// time spent in CG_DRAW_ACTIVE_FRAME this frame
+	short		benchmarkDurations[ MAX_TIMEDEMO_DURATIONS ][ BENCH_NUM_STAGES ];	// per stage log of frame durations
+
 #ifdef USE_VOIP
 	qboolean voipEnabled;
 	qboolean speexInitialized;
@@ -271,6 +287,7 @@ typedef struct {
 #ifdef LEGACY_PROTOCOL
 	qboolean compat;
 #endif
+	int protocol;	// of the server or demo, picks the playerState encoding
 
 	// big stuff at end of structure so most offsets are 15 bits or less
 	netchan_t	netchan;
@@ -374,6 +391,7 @@ extern	cvar_t	*cl_timegraph;
 extern	cvar_t	*cl_maxpackets;
 extern	cvar_t	*cl_packetdup;
 extern	cvar_t	*cl_shownet;
+extern	cvar_t	*cl_benchPlayerstate;
 extern	cvar_t	*cl_showSend;
 extern	cvar_t	*cl_timeNudge;
 extern	cvar_t	*cl_showTimeDelta;
@@ -410,6 +428,7 @@ extern	cvar_t	*j_side_axis;
 extern	cvar_t	*j_up_axis;
 
 extern	cvar_t	*cl_timedemo;
+extern	cvar_t	*cl_benchmarkMsec;
 extern	cvar_t	*cl_aviFrameRate;
 extern	cvar_t	*cl_aviMotionJpeg;
 
@@ -574,4 +574,36 @@ void RE_TakeVideoFrame( int width, int height,
 	cmd->captureBuffer = captureBuffer;
 	cmd->encodeBuffer = encodeBuffer;
 	cmd->motionJpeg = motionJpeg;
+	cmd->flush = qfalse;
+}
+
+/*
+=============
+RE_FlushVideoFrame
+
+Writes the video frame whose readback is still pending, called when
+a recording stops
+=============
+*/
+void RE_FlushVideoFrame( int width, int height,
+		byte *captureBuffer, byte *encodeBuffer, qboolean motionJpeg )
+{
+	videoFrameCommand_t	cmd;
+
+	if( !tr.registered ) {
+		return;
+	}
+
+	R_SyncRenderThread();
+
+	cmd.commandId = RC_VIDEOFRAME;
+
+	cmd.width = width;
+	cmd.height = height;
+	cmd.captureBuffer = captureBuffer;
+	cmd.encodeBuffer = encodeBuffer;
+	cmd.motionJpeg = motionJpeg;
+	cmd.flush = qtrue;
+
+	RB_TakeVideoFrameCmd( &cmd );
 }
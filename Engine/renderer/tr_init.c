@@ -105,6 +105,7 @@ cvar_t	*r_ext_multitexture;
 cvar_t	*r_ext_compiled_vertex_array;
 cvar_t	*r_ext_texture_env_add;
 cvar_t	*r_ext_texture_filter_anisotropic;
+cvar_t	*r_ext_pixel_buffer_object;
 cvar_t	*r_ext_max_anisotropy;
 cvar_t	*r_ext_vertex_shader;
 
@@ -779,6 +780,95 @@ void R_ScreenShotJPEG_f (void) {
 
 //============================================================================
 
+/*
+==================
+Video capture readback
+
+With pixel buffer objects the glReadPixels of a video frame only queues the
+transfer, and the pixels are mapped and encoded on the next capture instead of
+stalling the pipeline. Every queued frame is written exactly once and in order;
+the one still pending when the recording stops is written by
+RE_FlushVideoFrame. Without pixel buffer objects the readback is synchronous.
+==================
+*/
+#define NUM_VIDEO_PBOS	2
+
+static GLuint	videoPBOs[ NUM_VIDEO_PBOS ];
+static int		videoPBOSize;
+static int		videoPBOIndex;
+static int		videoPBOPending = -1;	// PBO holding a frame not yet written
+
+/*
+==================
+R_ShutdownVideoCapture
+==================
+*/
+static void R_ShutdownVideoCapture( void )
+{
+	if ( videoPBOSize && qglDeleteBuffersARB ) {
+		qglDeleteBuffersARB( NUM_VIDEO_PBOS, videoPBOs );
+	}
+
+	Com_Memset( videoPBOs, 0, sizeof( videoPBOs ) );
+	videoPBOSize = 0;
+	videoPBOIndex = 0;
+	videoPBOPending = -1;
+}
+
+/*
+==================
+RB_ReadVideoPixelsAsync
+
+Copies the frame queued by the previous capture to buffer and, unless
+flushing, queues the readback of the current frame. Returns qfalse if
+nothing was pending, which only happens on the first capture of a recording.
+==================
+*/
+static qboolean RB_ReadVideoPixelsAsync( int width, int height, byte *buffer, int size, qboolean flush )
+{
+	int		i, pending;
+	void	*pixels = NULL;
+
+	if ( videoPBOSize != size ) {
+		if ( flush ) {
+			return qfalse;
+		}
+
+		R_ShutdownVideoCapture();
+
+		qglGenBuffersARB( NUM_VIDEO_PBOS, videoPBOs );
+		for ( i = 0; i < NUM_VIDEO_PBOS; i++ ) {
+			qglBindBufferARB( GL_PIXEL_PACK_BUFFER_ARB, videoPBOs[ i ] );
+			qglBufferDataARB( GL_PIXEL_PACK_BUFFER_ARB, size, NULL, GL_STREAM_READ_ARB );
+		}
+		videoPBOSize = size;
+	}
+
+	pending = videoPBOPending;
+	videoPBOPending = -1;
+
+	if ( !flush ) {
+		qglBindBufferARB( GL_PIXEL_PACK_BUFFER_ARB, videoPBOs[ videoPBOIndex ] );
+		qglReadPixels( 0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, 0 );
+		videoPBOPending = videoPBOIndex;
+		videoPBOIndex = ( videoPBOIndex + 1 ) % NUM_VIDEO_PBOS;
+	}
+
+	if ( pending >= 0 ) {
+		qglBindBufferARB( GL_PIXEL_PACK_BUFFER_ARB, videoPBOs[ pending ] );
+		pixels = qglMapBufferARB( GL_PIXEL_PACK_BUFFER_ARB, GL_READ_ONLY_ARB );
+
+		if ( pixels ) {
+			Com_Memcpy( buffer, pixels, size );
+			qglUnmapBufferARB( GL_PIXEL_PACK_BUFFER_ARB );
+		}
+	}
+
+	qglBindBufferARB( GL_PIXEL_PACK_BUFFER_ARB, 0 );
+
+	return pixels != NULL;
+}
+
 /*
 ==================
 RB_TakeVideoFrameCmd
@@ -806,12 +896,20 @@ const void *RB_TakeVideoFrameCmd( const void *data )
 	avipadlen = avipadwidth - linelen;
 
 	cBuf = PADP(cmd->captureBuffer, packAlign);
-		
-	qglReadPixels(0, 0, cmd->width, cmd->height, GL_RGB,
-		GL_UNSIGNED_BYTE, cBuf);
 
 	memcount = padwidth * cmd->height;
 
+	if ( qglBindBufferARB ) {
+		if ( !RB_ReadVideoPixelsAsync( cmd->width, cmd->height, cBuf, memcount, cmd->flush ) ) {
+			return (const void *)(cmd + 1);
+		}
+	} else if ( cmd->flush ) {
+		return (const void *)(cmd + 1);
+	} else {
+		qglReadPixels(0, 0, cmd->width, cmd->height, GL_RGB,
+			GL_UNSIGNED_BYTE, cBuf);
+	}
+
 	// gamma correct
 	if(glConfig.deviceSupportsGamma)
 		R_GammaCorrect(cBuf, memcount);
@@ -977,6 +1075,7 @@ void GfxInfo_f( void )
 	ri.Printf( PRINT_ALL, "texture bits: %d\n", r_texturebits->integer );
 	ri.Printf( PRINT_ALL, "multitexture: %s\n", enablestrings[qglActiveTextureARB != 0] );
 	ri.Printf( PRINT_ALL, "compiled vertex arrays: %s\n", enablestrings[qglLockArraysEXT != 0 ] );
+	ri.Printf( PRINT_ALL, "pixel buffer objects: %s\n", enablestrings[qglBindBufferARB != 0 ] );
 	ri.Printf( PRINT_ALL, "texenv add: %s\n", enablestrings[glConfig.textureEnvAddAvailable != 0] );
 	ri.Printf( PRINT_ALL, "compressed textures: %s\n", enablestrings[glConfig.textureCompression!=TC_NONE] );
 	ri.Printf( PRINT_ALL, "glsl programs: %s\n", enablestrings[vertexShaders] );
@@ -1023,6 +1122,7 @@ void R_Register( void )
 	r_ext_texture_filter_anisotropic = ri.Cvar_Get( "r_ext_texture_filter_anisotropic",
 			"0", CVAR_ARCHIVE | CVAR_LATCH );
 	r_ext_max_anisotropy = ri.Cvar_Get( "r_ext_max_anisotropy", "2", CVAR_ARCHIVE | CVAR_LATCH );
+	r_ext_pixel_buffer_object = ri.Cvar_Get( "r_ext_pixel_buffer_object", "1", CVAR_ARCHIVE | CVAR_LATCH );
 
 	r_ext_vertex_shader = ri.Cvar_Get( "r_ext_vertex_shader", "0", CVAR_ARCHIVE|CVAR_LATCH );
 
@@ -1310,6 +1410,7 @@ void RE_Shutdown( qboolean destroyWindow ) {
 	if ( tr.registered ) {
 		R_SyncRenderThread();
 		R_ShutdownCommandBuffers();
+		R_ShutdownVideoCapture();
 		R_DeleteTextures();
 	}
 
@@ -1381,6 +1482,8 @@ refexport_t *GetRefAPI ( int apiVersion, refimport_t *rimp ) {
 
 	re.MarkFragments = R_MarkFragments;
 	re.LerpTag = R_LerpTag;
+	re.TagIndex = R_TagIndex;
+	re.LerpTags = R_LerpTags;
 	re.ModelBounds = R_ModelBounds;
 
 	re.ClearScene = RE_ClearScene;
@@ -1403,6 +1506,7 @@ refexport_t *GetRefAPI ( int apiVersion, refimport_t *rimp ) {
 	re.inPVS = R_inPVS;
 
 	re.TakeVideoFrame = RE_TakeVideoFrame;
+	re.FlushVideoFrame = RE_FlushVideoFrame;
 
 	return &re;
 }
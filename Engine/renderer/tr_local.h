@@ -883,6 +883,9 @@ void		R_ModelInit (void);
 model_t		*R_GetModelByHandle( qhandle_t hModel );
 int			R_LerpTag( orientation_t *tag, qhandle_t handle, int startFrame, int endFrame, 
 					 float frac, const char *tagName );
+int			R_TagIndex( qhandle_t handle, const char *tagName );
+int			R_LerpTags( orientation_t *tags, qhandle_t handle, int startFrame, int endFrame,
+					 float frac, const int *tagIndexes, int numTags );
 void		R_ModelBounds( qhandle_t handle, vec3_t mins, vec3_t maxs );
 
 void		R_Modellist_f (void);
@@ -1199,6 +1202,7 @@ extern cvar_t	*r_ext_compiled_vertex_array;
 extern cvar_t	*r_ext_texture_env_add;
 
 extern cvar_t	*r_ext_texture_filter_anisotropic;
+extern cvar_t	*r_ext_pixel_buffer_object;
 extern cvar_t	*r_ext_max_anisotropy;
 
 extern cvar_t	*r_ext_vertex_shader;
@@ -1871,6 +1875,10 @@ void RB_IQMSurfaceAnim( surfaceType_t *surface );
 int R_IQMLerpTag( orientation_t *tag, iqmData_t *data,
                   int startFrame, int endFrame,
                   float frac, const char *tagName );
+int R_IQMTagIndex( iqmData_t *data, const char *tagName );
+int R_IQMLerpTags( orientation_t *tags, iqmData_t *data,
+                   int startFrame, int endFrame,
+                   float frac, const int *joints, int numTags );
 
 /*
 =============================================================
@@ -2013,6 +2021,7 @@ typedef struct {
 	byte					*captureBuffer;
 	byte					*encodeBuffer;
 	qboolean			motionJpeg;
+	qboolean			flush;
 } videoFrameCommand_t;
 
 typedef struct
@@ -2091,6 +2100,8 @@ size_t RE_SaveJPGToBuffer(byte *buffer, size_t bufSize, int quality,
 		          int image_width, int image_height, byte *image_buffer, int padding);
 void RE_TakeVideoFrame( int width, int height,
 		byte *captureBuffer, byte *encodeBuffer, qboolean motionJpeg );
+void RE_FlushVideoFrame( int width, int height,
+		byte *captureBuffer, byte *encodeBuffer, qboolean motionJpeg );
 
 // font stuff
 void R_InitFreeType( void );
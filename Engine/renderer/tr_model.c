@@ -587,6 +587,122 @@ static md3Tag_t *R_GetTag( md3Header_t *mod, int frame, const char *tagName ) {
 	return NULL;
 }
 
+/*
+================
+R_LerpMD3Tag
+================
+*/
+static void R_LerpMD3Tag( orientation_t *tag, md3Tag_t *start, md3Tag_t *end, float frac ) {
+	int		i;
+	float		frontLerp, backLerp;
+
+	frontLerp = frac;
+	backLerp = 1.0f - frac;
+
+	for ( i = 0 ; i < 3 ; i++ ) {
+		tag->origin[i] = start->origin[i] * backLerp +  end->origin[i] * frontLerp;
+		tag->axis[0][i] = start->axis[0][i] * backLerp +  end->axis[0][i] * frontLerp;
+		tag->axis[1][i] = start->axis[1][i] * backLerp +  end->axis[1][i] * frontLerp;
+		tag->axis[2][i] = start->axis[2][i] * backLerp +  end->axis[2][i] * frontLerp;
+	}
+	VectorNormalize( tag->axis[0] );
+	VectorNormalize( tag->axis[1] );
+	VectorNormalize( tag->axis[2] );
+}
+
+/*
+================
+R_TagIndex
+
+Resolves a tag name to its slot in the model's tag table, so it can be
+handed to R_LerpTags without any further string compares.
+Returns -1 if the model has no such tag.
+================
+*/
+int R_TagIndex( qhandle_t handle, const char *tagName ) {
+	model_t		*model;
+	md3Header_t	*mod;
+	md3Tag_t	*tag;
+	int		i;
+
+	model = R_GetModelByHandle( handle );
+
+	if ( model->md3[0] ) {
+		// every frame lists its tags in the same order
+		mod = model->md3[0];
+		tag = (md3Tag_t *)((byte *)mod + mod->ofsTags);
+		for ( i = 0 ; i < mod->numTags ; i++, tag++ ) {
+			if ( !strcmp( tag->name, tagName ) ) {
+				return i;
+			}
+		}
+	}
+	else if ( model->type == MOD_IQM ) {
+		return R_IQMTagIndex( model->modelData, tagName );
+	}
+
+	return -1;
+}
+
+/*
+================
+R_LerpTags
+
+Lerps a whole set of tags resolved with R_TagIndex in one go. Tags that
+can't be found come back as an identity orientation at the origin.
+Returns the number of tags that were found.
+================
+*/
+int R_LerpTags( orientation_t *tags, qhandle_t handle, int startFrame, int endFrame,
+					 float frac, const int *tagIndexes, int numTags ) {
+	md3Header_t	*mod;
+	md3Tag_t	*start, *end;
+	model_t		*model;
+	int		i, found;
+
+	model = R_GetModelByHandle( handle );
+
+	if ( !model->md3[0] ) {
+		if ( model->type == MOD_IQM ) {
+			return R_IQMLerpTags( tags, model->modelData, startFrame, endFrame,
+					frac, tagIndexes, numTags );
+		}
+
+		for ( i = 0 ; i < numTags ; i++ ) {
+			AxisClear( tags[i].axis );
+			VectorClear( tags[i].origin );
+		}
+		return 0;
+	}
+
+	mod = model->md3[0];
+
+	// it is possible to have a bad frame while changing models, so don't error
+	if ( startFrame >= mod->numFrames ) {
+		startFrame = mod->numFrames - 1;
+	}
+	if ( endFrame >= mod->numFrames ) {
+		endFrame = mod->numFrames - 1;
+	}
+
+	start = (md3Tag_t *)((byte *)mod + mod->ofsTags) + startFrame * mod->numTags;
+	end = (md3Tag_t *)((byte *)mod + mod->ofsTags) + endFrame * mod->numTags;
+
+	found = 0;
+	for ( i = 0 ; i < numTags ; i++ ) {
+		if ( tagIndexes[i] < 0 || tagIndexes[i] >= mod->numTags ) {
+			AxisClear( tags[i].axis );
+			VectorClear( tags[i].origin );
+			continue;
+		}
+
+		R_LerpMD3Tag( &tags[i], start + tagIndexes[i], end + tagIndexes[i], frac );
+		found++;
+	}
+
+	return found;
+}
+
 /*
 ================
 R_LerpTag
@@ -595,8 +711,6 @@ R_LerpTag
 int R_LerpTag( orientation_t *tag, qhandle_t handle, int startFrame, int endFrame, 
 					 float frac, const char *tagName ) {
 	md3Tag_t	*start, *end;
-	int		i;
-	float		frontLerp, backLerp;
 	model_t		*model;
 
 	model = R_GetModelByHandle( handle );
@@ -625,19 +739,8 @@ int R_LerpTag( orientation_t *tag, qhandle_t handle, int startFrame, int endFram
 			return qfalse;
 		}
 	}
-	
-	frontLerp = frac;
-	backLerp = 1.0f - frac;
 
-	for ( i = 0 ; i < 3 ; i++ ) {
-		tag->origin[i] = start->origin[i] * backLerp +  end->origin[i] * frontLerp;
-		tag->axis[0][i] = start->axis[0][i] * backLerp +  end->axis[0][i] * frontLerp;
-		tag->axis[1][i] = start->axis[1][i] * backLerp +  end->axis[1][i] * frontLerp;
-		tag->axis[2][i] = start->axis[2][i] * backLerp +  end->axis[2][i] * frontLerp;
-	}
-	VectorNormalize( tag->axis[0] );
-	VectorNormalize( tag->axis[1] );
-	VectorNormalize( tag->axis[2] );
+	R_LerpMD3Tag( tag, start, end, frac );
 	return qtrue;
 }
 
@@ -1020,39 +1020,73 @@ void RB_IQMSurfaceAnim( surfaceType_t *surface ) {
 	tess.numVertexes += surf->num_vertexes;
 }
 
-int R_IQMLerpTag( orientation_t *tag, iqmData_t *data,
-		  int startFrame, int endFrame, 
-		  float frac, const char *tagName ) {
-	float	jointMats[IQM_MAX_JOINTS * 12];
+static void IQM_JointToTag( orientation_t *tag, const float *jointMats, int joint ) {
+	tag->axis[0][0] = jointMats[12 * joint + 0];
+	tag->axis[1][0] = jointMats[12 * joint + 1];
+	tag->axis[2][0] = jointMats[12 * joint + 2];
+	tag->origin[0] = jointMats[12 * joint + 3];
+	tag->axis[0][1] = jointMats[12 * joint + 4];
+	tag->axis[1][1] = jointMats[12 * joint + 5];
+	tag->axis[2][1] = jointMats[12 * joint + 6];
+	tag->origin[1] = jointMats[12 * joint + 7];
+	tag->axis[0][2] = jointMats[12 * joint + 8];
+	tag->axis[1][2] = jointMats[12 * joint + 9];
+	tag->axis[2][2] = jointMats[12 * joint + 10];
+	tag->origin[2] = jointMats[12 * joint + 11];
+}
+
+int R_IQMTagIndex( iqmData_t *data, const char *tagName ) {
 	int	joint;
 	char	*names = data->names;
 
 	// get joint number by reading the joint names
 	for( joint = 0; joint < data->num_joints; joint++ ) {
 		if( !strcmp( tagName, names ) )
-			break;
+			return joint;
 		names += strlen( names ) + 1;
 	}
-	if( joint >= data->num_joints ) {
+
+	return -1;
+}
+
+int R_IQMLerpTag( orientation_t *tag, iqmData_t *data,
+		  int startFrame, int endFrame, 
+		  float frac, const char *tagName ) {
+	float	jointMats[IQM_MAX_JOINTS * 12];
+	int	joint;
+
+	joint = R_IQMTagIndex( data, tagName );
+	if( joint < 0 ) {
 		AxisClear( tag->axis );
 		VectorClear( tag->origin );
 		return qfalse;
 	}
 
 	ComputeJointMats( data, startFrame, endFrame, frac, jointMats );
-
-	tag->axis[0][0] = jointMats[12 * joint + 0];
-	tag->axis[1][0] = jointMats[12 * joint + 1];
-	tag->axis[2][0] = jointMats[12 * joint + 2];
-	tag->origin[0] = jointMats[12 * joint + 3];
-	tag->axis[0][1] = jointMats[12 * joint + 4];
-	tag->axis[1][1] = jointMats[12 * joint + 5];
-	tag->axis[2][1] = jointMats[12 * joint + 6];
-	tag->origin[1] = jointMats[12 * joint + 7];
-	tag->axis[0][2] = jointMats[12 * joint + 8];
-	tag->axis[1][2] = jointMats[12 * joint + 9];
-	tag->axis[2][2] = jointMats[12 * joint + 10];
-	tag->origin[2] = jointMats[12 * joint + 11];
+	IQM_JointToTag( tag, jointMats, joint );
 
 	return qtrue;
 }
+
+// the joint matrices are computed once for the whole set
+int R_IQMLerpTags( orientation_t *tags, iqmData_t *data,
+		   int startFrame, int endFrame,
+		   float frac, const int *joints, int numTags ) {
+	float	jointMats[IQM_MAX_JOINTS * 12];
+	int	i, found = 0;
+
+	ComputeJointMats( data, startFrame, endFrame, frac, jointMats );
+
+	for( i = 0; i < numTags; i++ ) {
+		if( joints[i] < 0 || joints[i] >= data->num_joints ) {
+			AxisClear( tags[i].axis );
+			VectorClear( tags[i].origin );
+			continue;
+		}
+
+		IQM_JointToTag( &tags[i], jointMats, joints[i] );
+		found++;
+	}
+
+	return found;
+}
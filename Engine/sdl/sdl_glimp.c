@@ -83,6 +83,14 @@ void (APIENTRYP qglMultiTexCoord2fARB) (GLenum target, GLfloat s, GLfloat t);
 void (APIENTRYP qglLockArraysEXT) (GLint first, GLsizei count);
 void (APIENTRYP qglUnlockArraysEXT) (void);
 
+// GL_ARB_pixel_buffer_object
+void (APIENTRYP qglGenBuffersARB) (GLsizei n, GLuint *buffers);
+void (APIENTRYP qglDeleteBuffersARB) (GLsizei n, const GLuint *buffers);
+void (APIENTRYP qglBindBufferARB) (GLenum target, GLuint buffer);
+void (APIENTRYP qglBufferDataARB) (GLenum target, GLsizeiptrARB size, const GLvoid *data, GLenum usage);
+GLvoid *(APIENTRYP qglMapBufferARB) (GLenum target, GLenum access);
+GLboolean (APIENTRYP qglUnmapBufferARB) (GLenum target);
+
 // GL_ARB_shader_objects
 GLvoid (APIENTRYP qglDeleteObjectARB) (GLhandleARB obj);
 GLhandleARB (APIENTRYP qglGetHandleARB) (GLenum pname);
@@ -761,6 +769,46 @@ static void GLimp_InitExtensions( void )
 		ri.Printf( PRINT_ALL, "...GL_EXT_texture_filter_anisotropic not found\n" );
 	}
 
+	// GL_ARB_pixel_buffer_object, used for asynchronous video capture readback
+	qglGenBuffersARB = NULL;
+	qglDeleteBuffersARB = NULL;
+	qglBindBufferARB = NULL;
+	qglBufferDataARB = NULL;
+	qglMapBufferARB = NULL;
+	qglUnmapBufferARB = NULL;
+	if ( GLimp_HaveExtension( "GL_ARB_pixel_buffer_object" ) &&
+	     GLimp_HaveExtension( "GL_ARB_vertex_buffer_object" ) )
+	{
+		if ( r_ext_pixel_buffer_object->integer )
+		{
+			qglGenBuffersARB = SDL_GL_GetProcAddress( "glGenBuffersARB" );
+			qglDeleteBuffersARB = SDL_GL_GetProcAddress( "glDeleteBuffersARB" );
+			qglBindBufferARB = SDL_GL_GetProcAddress( "glBindBufferARB" );
+			qglBufferDataARB = SDL_GL_GetProcAddress( "glBufferDataARB" );
+			qglMapBufferARB = SDL_GL_GetProcAddress( "glMapBufferARB" );
+			qglUnmapBufferARB = SDL_GL_GetProcAddress( "glUnmapBufferARB" );
+
+			if ( qglGenBuffersARB && qglDeleteBuffersARB && qglBindBufferARB &&
+			     qglBufferDataARB && qglMapBufferARB && qglUnmapBufferARB )
+			{
+				ri.Printf( PRINT_ALL, "...using GL_ARB_pixel_buffer_object\n" );
+			}
+			else
+			{
+				qglBindBufferARB = NULL;
+				ri.Printf( PRINT_ALL, "...GL_ARB_pixel_buffer_object not properly supported!\n" );
+			}
+		}
+		else
+		{
+			ri.Printf( PRINT_ALL, "...ignoring GL_ARB_pixel_buffer_object\n" );
+		}
+	}
+	else
+	{
+		ri.Printf( PRINT_ALL, "...GL_ARB_pixel_buffer_object not found\n" );
+	}
+
 	vertexShaders = qfalse;
 	if ( GLimp_HaveExtension( "GL_ARB_shader_objects" )
 	     && GLimp_HaveExtension( "GL_ARB_fragment_shader" )
@@ -193,6 +193,8 @@ typedef struct client_s {
 
 	int				oldServerTime;
 	qboolean		csUpdated[MAX_CONFIGSTRINGS+1];	
+
+	int				entityUpdateTime[MAX_GENTITIES];	// svs.time the current state of an entity was last sent
 	
 #ifdef LEGACY_PROTOCOL
 	qboolean		compat;
@@ -283,6 +285,10 @@ extern	cvar_t	*sv_pure;
 extern	cvar_t	*sv_floodProtect;
 extern	cvar_t	*sv_lanForceRate;
 extern	cvar_t	*sv_banFile;
+extern	cvar_t	*sv_interest;
+extern	cvar_t	*sv_interestDistance;
+extern	cvar_t	*sv_interestMaxDelay;
+extern	cvar_t	*sv_recordGame;
 
 extern	serverBan_t serverBans[SERVER_MAXBANS];
 extern	int serverBansCount;
@@ -308,6 +314,9 @@ void SV_RemoveOperatorCommands (void);
 void SV_MasterShutdown (void);
 int SV_RateMsec(client_t *client);
 
+void SV_QueryCacheInvalidate( void );
+void SV_QueryBenchmark_f( void );
+
 
 
 //
@@ -362,6 +371,32 @@ void SV_SendMessageToClient( msg_t *msg, client_t *client );
 void SV_SendClientMessages( void );
 void SV_SendClientSnapshot( client_t *client );
 
+//
+// sv_replay.c
+//
+typedef enum {
+	GR_END,
+	GR_FRAME,
+	GR_CONNECT,
+	GR_RECONNECT,		// carried over from the previous map, firstTime = qfalse
+	GR_BEGIN,
+	GR_USERINFO,
+	GR_DISCONNECT,
+	GR_USERCMD,
+	GR_CLIENTCOMMAND,
+	GR_CONSOLECOMMAND
+} gameRecord_t;
+
+int			SV_GameRandomSeed( void );
+unsigned	SV_GameStateHash( void );
+void		SV_GameRecordBegin( void );
+void		SV_GameRecordStop( void );
+void		SV_GameRecordFrame( int time );
+void		SV_GameRecordClient( gameRecord_t type, client_t *cl );
+void		SV_GameRecordCommand( void );
+void		SV_ReplayGame_f( void );
+void		SV_ReplayShutdown( void );
+
 //
 // sv_game.c
 //
@@ -1164,6 +1164,8 @@ void SV_AddOperatorCommands( void ) {
 	Cmd_AddCommand("bandel", SV_BanDel_f);
 	Cmd_AddCommand("exceptdel", SV_ExceptDel_f);
 	Cmd_AddCommand("flushbans", SV_FlushBans_f);
+	Cmd_AddCommand("querybench", SV_QueryBenchmark_f);
+	Cmd_AddCommand("replaygame", SV_ReplayGame_f);
 }
 
 /*
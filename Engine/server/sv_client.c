@@ -25,6 +25,135 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 static void SV_CloseDownload( client_t *cl );
 
+/*
+=============================================================================
+
+DOWNLOAD CACHE
+
+Download blocks are read from disk in large segments that are shared by
+all clients downloading the same file, so a pk3 that several clients
+are fetching is read once instead of once per client, 1KB at a time.
+
+=============================================================================
+*/
+
+#define DLCACHE_SEGMENT_BLOCKS	64
+#define DLCACHE_SEGMENT_SIZE	( DLCACHE_SEGMENT_BLOCKS * MAX_DOWNLOAD_BLKSIZE )
+#define MAX_DLCACHE_SEGMENTS	32
+
+typedef struct {
+	char	fileName[MAX_QPATH];	// empty if unused
+	int		fileSize;
+	int		segment;
+	int		size;
+	int		lastUsed;
+	byte	*data;
+} dlSegment_t;
+
+static dlSegment_t	dlCache[MAX_DLCACHE_SEGMENTS];
+static int			dlCacheSequence;
+
+/*
+==================
+SV_DownloadCacheFree
+==================
+*/
+static void SV_DownloadCacheFree( void ) {
+	int i;
+
+	for ( i = 0; i < MAX_DLCACHE_SEGMENTS; i++ ) {
+		if ( dlCache[i].data ) {
+			Z_Free( dlCache[i].data );
+		}
+	}
+
+	Com_Memset( dlCache, 0, sizeof( dlCache ) );
+	dlCacheSequence = 0;
+}
+
+/*
+==================
+SV_DownloadCacheSegment
+
+Returns the cached segment holding the given block of the client's
+download, reading it through the client's file handle on a miss
+==================
+*/
+static dlSegment_t *SV_DownloadCacheSegment( client_t *cl, int block ) {
+	dlSegment_t	*seg, *oldest = NULL;
+	int			segment = block / DLCACHE_SEGMENT_BLOCKS;
+	int			i;
+
+	for ( i = 0; i < MAX_DLCACHE_SEGMENTS; i++ ) {
+		seg = &dlCache[i];
+
+		if ( seg->fileName[0] && seg->segment == segment && seg->fileSize == cl->downloadSize &&
+			!strcmp( seg->fileName, cl->downloadName ) ) {
+			seg->lastUsed = ++dlCacheSequence;
+			return seg;
+		}
+
+		if ( !oldest || seg->lastUsed < oldest->lastUsed ) {
+			oldest = seg;
+		}
+	}
+
+	// replace the least recently used segment
+	seg = oldest;
+	seg->fileName[0] = 0;
+
+	if ( !seg->data ) {
+		seg->data = Z_Malloc( DLCACHE_SEGMENT_SIZE );
+	}
+
+	if ( FS_Seek( cl->download, segment * DLCACHE_SEGMENT_SIZE, FS_SEEK_SET ) < 0 ) {
+		return NULL;
+	}
+
+	seg->size = FS_Read( seg->data, DLCACHE_SEGMENT_SIZE, cl->download );
+	if ( seg->size < 0 ) {
+		return NULL;
+	}
+
+	Q_strncpyz( seg->fileName, cl->downloadName, sizeof( seg->fileName ) );
+	seg->fileSize = cl->downloadSize;
+	seg->segment = segment;
+	seg->lastUsed = ++dlCacheSequence;
+
+	return seg;
+}
+
+/*
+==================
+SV_ReadDownloadBlock
+
+Copies a download block out of the cache, returns its size or -1 on EOF
+==================
+*/
+static int SV_ReadDownloadBlock( client_t *cl, int block, byte *buffer ) {
+	dlSegment_t	*seg;
+	int			offset, size;
+
+	seg = SV_DownloadCacheSegment( cl, block );
+	if ( !seg ) {
+		return -1;
+	}
+
+	offset = ( block % DLCACHE_SEGMENT_BLOCKS ) * MAX_DOWNLOAD_BLKSIZE;
+	size = seg->size - offset;
+
+	if ( size <= 0 ) {
+		return -1;
+	}
+	if ( size > MAX_DOWNLOAD_BLKSIZE ) {
+		size = MAX_DOWNLOAD_BLKSIZE;
+	}
+
+	Com_Memcpy( buffer, seg->data + offset, size );
+
+	return size;
+}
+
 /*
 =================
 SV_GetChallenge
@@ -396,6 +525,7 @@ gotnewcl:
 	Q_strncpyz( newcl->userinfo, userinfo, sizeof(newcl->userinfo) );
 
 	// get the game a chance to reject this connection or modify the userinfo
+	SV_GameRecordClient( GR_CONNECT, newcl );
 	denied = VM_Call( gvm, GAME_CLIENT_CONNECT, clientNum, qtrue, qfalse ); // firstTime = qtrue
 	if ( denied ) {
 		// we can't just use VM_ArgPtr, because that is only valid inside a VM_Call
@@ -499,6 +629,7 @@ void SV_DropClient( client_t *drop, const char *reason ) {
 
 	// call the prog function for removing a client
 	// this will remove the body, among other things
+	SV_GameRecordClient( GR_DISCONNECT, drop );
 	VM_Call( gvm, GAME_CLIENT_DISCONNECT, drop - svs.clients );
 
 	// add the disconnect command
@@ -509,6 +640,7 @@ void SV_DropClient( client_t *drop, const char *reason ) {
 	
 	Com_DPrintf( "Going to CS_ZOMBIE for %s\n", drop->name );
 	drop->state = CS_ZOMBIE;		// become free in a few seconds
+	SV_QueryCacheInvalidate();
 
 	// if this was the last client on the server, send a heartbeat
 	// to the master so it is known the server is empty
@@ -631,6 +763,7 @@ void SV_ClientEnterWorld( client_t *client, usercmd_t *cmd ) {
 		memset(&client->lastUsercmd, '\0', sizeof(client->lastUsercmd));
 
 	// call the game begin function
+	SV_GameRecordClient( GR_BEGIN, client );
 	VM_Call( gvm, GAME_CLIENT_BEGIN, client - svs.clients );
 }
 
@@ -667,6 +800,16 @@ static void SV_CloseDownload( client_t *cl ) {
 		}
 	}
 
+	// release the cache once nobody is downloading anymore
+	if ( svs.clients ) {
+		for ( i = 0; i < sv_maxclients->integer; i++ ) {
+			if ( *svs.clients[i].downloadName ) {
+				return;
+			}
+		}
+	}
+
+	SV_DownloadCacheFree();
 }
 
 /*
@@ -842,10 +985,7 @@ int SV_WriteDownloadToClient(client_t *cl, msg_t *msg)
 			MSG_WriteLong( msg, -1 ); // illegal file size
 			MSG_WriteString( msg, errorMessage );
 
-			*cl->downloadName = 0;
-			
-			if(cl->download)
-				FS_FCloseFile(cl->download);
+			SV_CloseDownload( cl );
 			
 			return 0;
 		}
@@ -867,7 +1007,7 @@ int SV_WriteDownloadToClient(client_t *cl, msg_t *msg)
 		if (!cl->downloadBlocks[curindex])
 			cl->downloadBlocks[curindex] = Z_Malloc(MAX_DOWNLOAD_BLKSIZE);
 
-		cl->downloadBlockSize[curindex] = FS_Read( cl->downloadBlocks[curindex], MAX_DOWNLOAD_BLKSIZE, cl->download );
+		cl->downloadBlockSize[curindex] = SV_ReadDownloadBlock( cl, cl->downloadCurrentBlock, cl->downloadBlocks[curindex] );
 
 		if (cl->downloadBlockSize[curindex] < 0) {
 			// EOF right now
@@ -1203,6 +1343,7 @@ void SV_UserinfoChanged( client_t *cl ) {
 
 	// name for C code
 	Q_strncpyz( cl->name, Info_ValueForKey (cl->userinfo, "name"), sizeof(cl->name) );
+	SV_QueryCacheInvalidate();
 
 	// rate command
 
@@ -1293,6 +1434,7 @@ static void SV_UpdateUserinfo_f( client_t *cl ) {
 
 	SV_UserinfoChanged( cl );
 	// call prog code to allow overrides
+	SV_GameRecordClient( GR_USERINFO, cl );
 	VM_Call( gvm, GAME_CLIENT_USERINFO_CHANGED, cl - svs.clients );
 }
 
@@ -1375,6 +1517,7 @@ void SV_ExecuteClientCommand( client_t *cl, const char *s, qboolean clientOK ) {
 		// pass unknown strings to the game
 		if (!u->name && sv.state == SS_GAME && (cl->state == CS_ACTIVE || cl->state == CS_PRIMED)) {
 			Cmd_Args_Sanitize();
+			SV_GameRecordClient( GR_CLIENTCOMMAND, cl );
 			VM_Call( gvm, GAME_CLIENT_COMMAND, cl - svs.clients );
 		}
 	}
@@ -1453,6 +1596,7 @@ void SV_ClientThink (client_t *cl, usercmd_t *cmd) {
 		return;		// may have been kicked during the last usercmd
 	}
 
+	SV_GameRecordClient( GR_USERCMD, cl );
 	VM_Call( gvm, GAME_CLIENT_THINK, cl - svs.clients );
 }
 
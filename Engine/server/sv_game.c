@@ -474,6 +474,7 @@ void SV_ShutdownGameProgs( void ) {
 	if ( !gvm ) {
 		return;
 	}
+	SV_GameRecordStop();
 	VM_Call( gvm, GAME_SHUTDOWN, qfalse );
 	VM_Free( gvm );
 	gvm = NULL;
@@ -500,9 +501,10 @@ static void SV_InitGameVM( qboolean restart ) {
 		svs.clients[i].gentity = NULL;
 	}
 	
-	// use the current msec count for a random seed
+	// use the current msec count for a random seed, or the
+	// recorded one when replaying
 	// init for this gamestate
-	VM_Call (gvm, GAME_INIT, sv.time, Com_Milliseconds(), restart);
+	VM_Call (gvm, GAME_INIT, sv.time, SV_GameRandomSeed(), restart);
 }
 
 
@@ -518,6 +520,7 @@ void SV_RestartGameProgs( void ) {
 	if ( !gvm ) {
 		return;
 	}
+	SV_GameRecordStop();
 	VM_Call( gvm, GAME_SHUTDOWN, qtrue );
 
 	// do a restart instead of a free
@@ -562,6 +565,7 @@ qboolean SV_GameCommand( void ) {
 		return qfalse;
 	}
 
+	SV_GameRecordCommand();
 	return VM_Call( gvm, GAME_CONSOLE_COMMAND );
 }
 
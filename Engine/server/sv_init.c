@@ -583,6 +583,9 @@ void SV_SpawnServer( char *server ) {
 
 	Hunk_SetMark();
 
+	// start recording the game module's input if sv_recordGame is set
+	SV_GameRecordBegin();
+
 	Com_Printf ("-----------------------------------\n");
 }
 
@@ -652,6 +655,10 @@ void SV_Init (void)
 	sv_mapChecksum = Cvar_Get ("sv_mapChecksum", "", CVAR_ROM);
 	sv_lanForceRate = Cvar_Get ("sv_lanForceRate", "1", CVAR_ARCHIVE );
 	sv_banFile = Cvar_Get("sv_banFile", "serverbans.dat", CVAR_ARCHIVE);
+	sv_recordGame = Cvar_Get ("sv_recordGame", "", CVAR_TEMP );
+	sv_interest = Cvar_Get ("sv_interest", "1", CVAR_ARCHIVE );
+	sv_interestDistance = Cvar_Get ("sv_interestDistance", "4096", CVAR_ARCHIVE );
+	sv_interestMaxDelay = Cvar_Get ("sv_interestMaxDelay", "1000", CVAR_ARCHIVE );
 
 
 	// Load saved bans
@@ -701,6 +708,7 @@ before Sys_Quit or Sys_Error
 */
 void SV_Shutdown( char *finalmsg ) {
 	if ( !com_sv_running || !com_sv_running->integer ) {
+		SV_ReplayShutdown();
 		return;
 	}
 
@@ -736,6 +744,8 @@ void SV_Shutdown( char *finalmsg ) {
 
 	Com_Printf( "---------------------------\n" );
 
+	SV_ReplayShutdown();
+
 	// disconnect any local clients
 	if( sv_killserver->integer != 2 )
 		CL_Disconnect( qfalse );
@@ -58,6 +58,10 @@ cvar_t	*sv_pure;
 cvar_t	*sv_floodProtect;
 cvar_t	*sv_lanForceRate; // dedicated 1 (LAN) server forces local client rates to 99999 (bug #491)
 cvar_t	*sv_banFile;
+cvar_t	*sv_interest;			// slow down updates of distant entities to fit the client's rate
+cvar_t	*sv_interestDistance;	// distance at which a small entity drops below full rate
+cvar_t	*sv_interestMaxDelay;	// msec an entity can go without an update
+cvar_t	*sv_recordGame;			// record the game module's input to replays/<name>.rpl
 
 serverBan_t serverBans[SERVER_MAXBANS];
 int serverBansCount = 0;
@@ -357,18 +361,18 @@ struct leakyBucket_s {
 
 	int						lastTime;
 	signed char		burst;
-
-	long					hash;
-
-	leakyBucket_t *prev, *next;
 };
 
-// This is deliberately quite large to make it more of an effort to DoS
+// This is deliberately quite large to make it more of an effort to DoS.
+// Buckets live in an open addressing table, an address is only ever
+// looked for within MAX_BUCKET_PROBES slots of its hash.
 #define MAX_BUCKETS			16384
-#define MAX_HASHES			1024
+#define MAX_BUCKET_PROBES	16
 
 static leakyBucket_t buckets[ MAX_BUCKETS ];
-static leakyBucket_t *bucketHashes[ MAX_HASHES ];
+
+// SV_QueryBenchmark_f points this at a scratch table for its fake queries
+static leakyBucket_t *bucketTable = buckets;
 
 /*
 ================
@@ -392,11 +396,37 @@ static long SVC_HashForAddress( netadr_t address ) {
 	}
 
 	hash = ( hash ^ ( hash >> 10 ) ^ ( hash >> 20 ) );
-	hash &= ( MAX_HASHES - 1 );
+	hash &= ( MAX_BUCKETS - 1 );
 
 	return hash;
 }
 
+/*
+================
+SVC_BucketMatchesAddress
+================
+*/
+static qboolean SVC_BucketMatchesAddress( leakyBucket_t *bucket, netadr_t address ) {
+	if ( bucket->type != address.type ) {
+		return qfalse;
+	}
+
+	switch ( bucket->type ) {
+		case NA_IP:
+			return memcmp( bucket->ipv._4, address.ip, 4 ) == 0;
+
+		case NA_IP6:
+			return memcmp( bucket->ipv._6, address.ip6, 16 ) == 0;
+
+		case NA_BAD:
+			return qfalse;
+
+		default:
+			// loopback and bots all come from the same place
+			return qtrue;
+	}
+}
+
 /*
 ================
 SVC_BucketForAddress
@@ -405,79 +435,47 @@ Find or allocate a bucket for an address
 ================
 */
 static leakyBucket_t *SVC_BucketForAddress( netadr_t address, int burst, int period ) {
-	leakyBucket_t	*bucket = NULL;
+	leakyBucket_t	*bucket, *freeBucket = NULL;
 	int						i;
 	long					hash = SVC_HashForAddress( address );
 	int						now = Sys_Milliseconds();
 
-	for ( bucket = bucketHashes[ hash ]; bucket; bucket = bucket->next ) {
-		switch ( bucket->type ) {
-			case NA_IP:
-				if ( memcmp( bucket->ipv._4, address.ip, 4 ) == 0 ) {
-					return bucket;
-				}
-				break;
+	for ( i = 0; i < MAX_BUCKET_PROBES; i++ ) {
+		int interval;
 
-			case NA_IP6:
-				if ( memcmp( bucket->ipv._6, address.ip6, 16 ) == 0 ) {
-					return bucket;
-				}
-				break;
+		bucket = &bucketTable[ ( hash + i ) & ( MAX_BUCKETS - 1 ) ];
 
-			default:
-				break;
+		if ( SVC_BucketMatchesAddress( bucket, address ) ) {
+			return bucket;
 		}
-	}
 
-	for ( i = 0; i < MAX_BUCKETS; i++ ) {
-		int interval;
+		if ( freeBucket ) {
+			continue;
+		}
 
-		bucket = &buckets[ i ];
+		// Unused and expired buckets can be taken over
 		interval = now - bucket->lastTime;
-
-		// Reclaim expired buckets
-		if ( bucket->lastTime > 0 && ( interval > ( burst * period ) ||
-					interval < 0 ) ) {
-			if ( bucket->prev != NULL ) {
-				bucket->prev->next = bucket->next;
-			} else {
-				bucketHashes[ bucket->hash ] = bucket->next;
-			}
-			
-			if ( bucket->next != NULL ) {
-				bucket->next->prev = bucket->prev;
-			}
-
-			Com_Memset( bucket, 0, sizeof( leakyBucket_t ) );
+		if ( bucket->type == NA_BAD || interval > ( burst * period ) || interval < 0 ) {
+			freeBucket = bucket;
 		}
+	}
 
-		if ( bucket->type == NA_BAD ) {
-			bucket->type = address.type;
-			switch ( address.type ) {
-				case NA_IP:  Com_Memcpy( bucket->ipv._4, address.ip, 4 );   break;
-				case NA_IP6: Com_Memcpy( bucket->ipv._6, address.ip6, 16 ); break;
-				default: break;
-			}
-
-			bucket->lastTime = now;
-			bucket->burst = 0;
-			bucket->hash = hash;
-
-			// Add to the head of the relevant hash chain
-			bucket->next = bucketHashes[ hash ];
-			if ( bucketHashes[ hash ] != NULL ) {
-				bucketHashes[ hash ]->prev = bucket;
-			}
-
-			bucket->prev = NULL;
-			bucketHashes[ hash ] = bucket;
+	if ( freeBucket ) {
+		Com_Memset( freeBucket, 0, sizeof( leakyBucket_t ) );
 
-			return bucket;
+		freeBucket->type = address.type;
+		switch ( address.type ) {
+			case NA_IP:  Com_Memcpy( freeBucket->ipv._4, address.ip, 4 );   break;
+			case NA_IP6: Com_Memcpy( freeBucket->ipv._6, address.ip6, 16 ); break;
+			default: break;
 		}
+
+		freeBucket->lastTime = now;
+		freeBucket->burst = 0;
 	}
 
-	// Couldn't allocate a bucket for this address
-	return NULL;
+	// NULL if we couldn't allocate a bucket for this address
+	return freeBucket;
 }
 
 /*
@@ -523,23 +521,129 @@ static qboolean SVC_RateLimitAddress( netadr_t from, int burst, int period ) {
 	return SVC_RateLimit( bucket, burst, period );
 }
 
+/*
+==============================================================================
+
+Cached getinfo / getstatus responses. Building them walks every cvar and
+client, so they are only rebuilt when serverinfo or the client roster
+changes. Scores and pings in the status player list are refreshed at most
+every STATUS_CACHE_MSEC.
+
+==============================================================================
+*/
+
+#define STATUS_CACHE_MSEC	1000
+
+typedef struct {
+	int		version;		// queryCacheVersion it was built for
+	int		clients;		// connected client count it was built for
+	int		time;
+	char	string[MAX_MSGLEN];
+} queryCache_t;
+
+static int			queryCacheVersion = 1;
+static queryCache_t	infoCache;
+static queryCache_t	statusInfoCache;
+static queryCache_t	statusPlayerCache;
+
 /*
 ================
-SVC_Status
+SV_QueryCacheInvalidate
 
-Responds with all the info that qplug or qspy can see about the server
-and all connected players.  Used for getting detailed information after
-the simple info query.
+Serverinfo or the client roster has changed
 ================
 */
-static void SVC_Status( netadr_t from ) {
+void SV_QueryCacheInvalidate( void ) {
+	queryCacheVersion++;
+}
+
+/*
+================
+SVC_QueryCacheVersion
+================
+*/
+static int SVC_QueryCacheVersion( void ) {
+	// SV_Frame hasn't seen the change yet
+	if ( cvar_modifiedFlags & CVAR_SERVERINFO ) {
+		SV_QueryCacheInvalidate();
+	}
+
+	return queryCacheVersion;
+}
+
+/*
+================
+SVC_BuildStatusResponse
+
+Builds the statusResponse body with the challenge echoed back
+================
+*/
+static void SVC_BuildStatusResponse( const char *challenge, char *infostring ) {
 	char	player[1024];
-	char	status[MAX_MSGLEN];
 	int		i;
 	client_t	*cl;
 	playerState_t	*ps;
 	int		statusLength;
 	int		playerLength;
+	int		version = SVC_QueryCacheVersion();
+	int		now = Sys_Milliseconds();
+	int		count = 0;
+
+	for ( i = 0 ; i < sv_maxclients->integer ; i++ ) {
+		if ( svs.clients[i].state >= CS_CONNECTED ) {
+			count++;
+		}
+	}
+
+	if ( statusInfoCache.version != version ) {
+		Q_strncpyz( statusInfoCache.string, Cvar_InfoString( CVAR_SERVERINFO ), MAX_INFO_STRING );
+		statusInfoCache.version = version;
+	}
+
+	if ( statusPlayerCache.version != version || statusPlayerCache.clients != count ||
+		now - statusPlayerCache.time >= STATUS_CACHE_MSEC || now < statusPlayerCache.time ) {
+		char	*status = statusPlayerCache.string;
+
+		status[0] = 0;
+		statusLength = 0;
+
+		for (i=0 ; i < sv_maxclients->integer ; i++) {
+			cl = &svs.clients[i];
+			if ( cl->state >= CS_CONNECTED ) {
+				ps = SV_GameClientNum( i );
+				Com_sprintf (player, sizeof(player), "%i %i \"%s\"\n", 
+					ps->persistant[PERS_SCORE], cl->ping, cl->name);
+				playerLength = strlen(player);
+				if (statusLength + playerLength >= sizeof(statusPlayerCache.string) ) {
+					break;		// can't hold any more
+				}
+				strcpy (status + statusLength, player);
+				statusLength += playerLength;
+			}
+		}
+
+		statusPlayerCache.version = version;
+		statusPlayerCache.clients = count;
+		statusPlayerCache.time = now;
+	}
+
+	strcpy( infostring, statusInfoCache.string );
+
+	// echo back the parameter to status. so master servers can use it as a challenge
+	// to prevent timed spoofed reply packets that add ghost servers
+	Info_SetValueForKey( infostring, "challenge", challenge );
+}
+
+/*
+================
+SVC_Status
+
+Responds with all the info that qplug or qspy can see about the server
+and all connected players.  Used for getting detailed information after
+the simple info query.
+================
+*/
+static void SVC_Status( netadr_t from ) {
 	char	infostring[MAX_INFO_STRING];
 	static leakyBucket_t bucket;
 
@@ -562,31 +666,81 @@ static void SVC_Status( netadr_t from ) {
 		return;
 	}
 
-	strcpy( infostring, Cvar_InfoString( CVAR_SERVERINFO ) );
+	SVC_BuildStatusResponse( Cmd_Argv(1), infostring );
 
-	// echo back the parameter to status. so master servers can use it as a challenge
-	// to prevent timed spoofed reply packets that add ghost servers
-	Info_SetValueForKey( infostring, "challenge", Cmd_Argv(1) );
+	NET_OutOfBandPrint( NS_SERVER, from, "statusResponse\n%s\n%s", infostring, statusPlayerCache.string );
+}
 
-	status[0] = 0;
-	statusLength = 0;
+/*
+================
+SVC_BuildInfoResponse
 
-	for (i=0 ; i < sv_maxclients->integer ; i++) {
-		cl = &svs.clients[i];
-		if ( cl->state >= CS_CONNECTED ) {
-			ps = SV_GameClientNum( i );
-			Com_sprintf (player, sizeof(player), "%i %i \"%s\"\n", 
-				ps->persistant[PERS_SCORE], cl->ping, cl->name);
-			playerLength = strlen(player);
-			if (statusLength + playerLength >= sizeof(status) ) {
-				break;		// can't hold any more
-			}
-			strcpy (status + statusLength, player);
-			statusLength += playerLength;
+Builds the infoResponse body with the challenge echoed back
+================
+*/
+static void SVC_BuildInfoResponse( const char *challenge, char *infostring ) {
+	int		i, count, humans;
+	int		version = SVC_QueryCacheVersion();
+	char	*gamedir;
+	char	*info = infoCache.string;
+
+	// don't count privateclients
+	count = humans = 0;
+	for ( i = sv_privateClients->integer ; i < sv_maxclients->integer ; i++ ) {
+		if ( svs.clients[i].state >= CS_CONNECTED ) {
+			count++;
+			humans++;
 		}
 	}
 
-	NET_OutOfBandPrint( NS_SERVER, from, "statusResponse\n%s\n%s", infostring, status );
+	if ( infoCache.version != version || infoCache.clients != count ) {
+		info[0] = 0;
+
+		Info_SetValueForKey( info, "gamename", com_gamename->string );
+
+#ifdef LEGACY_PROTOCOL
+		if(com_legacyprotocol->integer > 0)
+			Info_SetValueForKey(info, "protocol", va("%i", com_legacyprotocol->integer));
+		else
+#endif
+			Info_SetValueForKey(info, "protocol", va("%i", com_protocol->integer));
+
+		Info_SetValueForKey( info, "hostname", sv_hostname->string );
+		Info_SetValueForKey( info, "mapname", sv_mapname->string );
+		Info_SetValueForKey( info, "clients", va("%i", count) );
+		Info_SetValueForKey(info, "g_humanplayers", va("%i", humans));
+		Info_SetValueForKey( info, "sv_maxclients", 
+			va("%i", sv_maxclients->integer - sv_privateClients->integer ) );
+		Info_SetValueForKey( info, "gametype", va("%i", sv_gametype->integer ) );
+		Info_SetValueForKey( info, "pure", va("%i", sv_pure->integer ) );
+		Info_SetValueForKey(info, "g_needpass", va("%d", Cvar_VariableIntegerValue("g_needpass")));
+
+#ifdef USE_VOIP
+		if (sv_voip->integer) {
+			Info_SetValueForKey( info, "voip", va("%i", sv_voip->integer ) );
+		}
+#endif
+
+		if( sv_minPing->integer ) {
+			Info_SetValueForKey( info, "minPing", va("%i", sv_minPing->integer) );
+		}
+		if( sv_maxPing->integer ) {
+			Info_SetValueForKey( info, "maxPing", va("%i", sv_maxPing->integer) );
+		}
+		gamedir = Cvar_VariableString( "fs_game" );
+		if( *gamedir ) {
+			Info_SetValueForKey( info, "game", gamedir );
+		}
+
+		infoCache.version = version;
+		infoCache.clients = count;
+	}
+
+	strcpy( infostring, info );
+
+	// echo back the parameter to status. so servers can use it as a challenge
+	// to prevent timed spoofed reply packets that add ghost servers
+	Info_SetValueForKey( infostring, "challenge", challenge );
 }
 
 /*
@@ -598,8 +752,6 @@ if a user is interested in a server to do a full status
 ================
 */
 void SVC_Info( netadr_t from ) {
-	int		i, count, humans;
-	char	*gamedir;
 	char	infostring[MAX_INFO_STRING];
 
 	// ignore if we are in single player
@@ -616,58 +768,81 @@ void SVC_Info( netadr_t from ) {
 	if(strlen(Cmd_Argv(1)) > 128)
 		return;
 
-	// don't count privateclients
-	count = humans = 0;
-	for ( i = sv_privateClients->integer ; i < sv_maxclients->integer ; i++ ) {
-		if ( svs.clients[i].state >= CS_CONNECTED ) {
-			count++;
-			humans++;
-		}
-	}
+	SVC_BuildInfoResponse( Cmd_Argv(1), infostring );
 
-	infostring[0] = 0;
-
-	// echo back the parameter to status. so servers can use it as a challenge
-	// to prevent timed spoofed reply packets that add ghost servers
-	Info_SetValueForKey( infostring, "challenge", Cmd_Argv(1) );
+	NET_OutOfBandPrint( NS_SERVER, from, "infoResponse\n%s", infostring );
+}
 
-	Info_SetValueForKey( infostring, "gamename", com_gamename->string );
+/*
+================
+SV_QueryBenchmark_f
 
-#ifdef LEGACY_PROTOCOL
-	if(com_legacyprotocol->integer > 0)
-		Info_SetValueForKey(infostring, "protocol", va("%i", com_legacyprotocol->integer));
-	else
-#endif
-		Info_SetValueForKey(infostring, "protocol", va("%i", com_protocol->integer));
-
-	Info_SetValueForKey( infostring, "hostname", sv_hostname->string );
-	Info_SetValueForKey( infostring, "mapname", sv_mapname->string );
-	Info_SetValueForKey( infostring, "clients", va("%i", count) );
-	Info_SetValueForKey(infostring, "g_humanplayers", va("%i", humans));
-	Info_SetValueForKey( infostring, "sv_maxclients", 
-		va("%i", sv_maxclients->integer - sv_privateClients->integer ) );
-	Info_SetValueForKey( infostring, "gametype", va("%i", sv_gametype->integer ) );
-	Info_SetValueForKey( infostring, "pure", va("%i", sv_pure->integer ) );
-	Info_SetValueForKey(infostring, "g_needpass", va("%d", Cvar_VariableIntegerValue("g_needpass")));
+querybench [packets] [addresses]
 
-#ifdef USE_VOIP
-	if (sv_voip->integer) {
-		Info_SetValueForKey( infostring, "voip", va("%i", sv_voip->integer ) );
+Replays a flood of getinfo/getstatus queries from random addresses through
+the rate limiter and response builders, without sending anything.
+The limiter runs on a scratch bucket table, so real clients on the same
+addresses aren't limited afterwards
+================
+*/
+void SV_QueryBenchmark_f( void ) {
+	char		infostring[MAX_INFO_STRING];
+	netadr_t	from;
+	int			numPackets = 100000;
+	int			numAddresses = 4096;
+	int			i, start, msec, answered = 0;
+
+	if ( !com_sv_running->integer ) {
+		Com_Printf( "Server is not running.\n" );
+		return;
 	}
-#endif
 
-	if( sv_minPing->integer ) {
-		Info_SetValueForKey( infostring, "minPing", va("%i", sv_minPing->integer) );
+	if ( Cmd_Argc() > 1 ) {
+		numPackets = atoi( Cmd_Argv( 1 ) );
 	}
-	if( sv_maxPing->integer ) {
-		Info_SetValueForKey( infostring, "maxPing", va("%i", sv_maxPing->integer) );
+	if ( Cmd_Argc() > 2 ) {
+		numAddresses = atoi( Cmd_Argv( 2 ) );
 	}
-	gamedir = Cvar_VariableString( "fs_game" );
-	if( *gamedir ) {
-		Info_SetValueForKey( infostring, "game", gamedir );
+	if ( numPackets <= 0 || numAddresses <= 0 ) {
+		Com_Printf( "querybench [packets] [addresses]\n" );
+		return;
 	}
 
-	NET_OutOfBandPrint( NS_SERVER, from, "infoResponse\n%s", infostring );
+	Com_Memset( &from, 0, sizeof( from ) );
+	from.type = NA_IP;
+
+	bucketTable = Z_Malloc( MAX_BUCKETS * sizeof( leakyBucket_t ) );
+
+	start = Sys_Milliseconds();
+
+	for ( i = 0; i < numPackets; i++ ) {
+		int host = ( i * 2654435761u ) % numAddresses;
+
+		from.ip[0] = 10;
+		from.ip[1] = ( host >> 16 ) & 0xff;
+		from.ip[2] = ( host >> 8 ) & 0xff;
+		from.ip[3] = host & 0xff;
+
+		if ( SVC_RateLimitAddress( from, 10, 1000 ) ) {
+			continue;
+		}
+
+		if ( i & 1 ) {
+			SVC_BuildStatusResponse( "benchmark", infostring );
+		} else {
+			SVC_BuildInfoResponse( "benchmark", infostring );
+		}
+		answered++;
+	}
+
+	msec = Sys_Milliseconds() - start;
+
+	Z_Free( bucketTable );
+	bucketTable = buckets;
+
+	Com_Printf( "%i packets from %i addresses in %i msec, %i answered, %.0f packets/s\n",
+		numPackets, numAddresses, msec, answered,
+		msec > 0 ? numPackets * 1000.0f / msec : 0.0f );
 }
 
 /*
@@ -1095,6 +1270,7 @@ void SV_Frame( int msec ) {
 	if ( cvar_modifiedFlags & CVAR_SERVERINFO ) {
 		SV_SetConfigstring( CS_SERVERINFO, Cvar_InfoString( CVAR_SERVERINFO ) );
 		cvar_modifiedFlags &= ~CVAR_SERVERINFO;
+		SV_QueryCacheInvalidate();
 	}
 	if ( cvar_modifiedFlags & CVAR_SYSTEMINFO ) {
 		SV_SetConfigstring( CS_SYSTEMINFO, Cvar_InfoString_Big( CVAR_SYSTEMINFO ) );
@@ -1117,6 +1293,7 @@ void SV_Frame( int msec ) {
 		sv.time += frameMsec;
 
 		// let everything in the world think and move
+		SV_GameRecordFrame( sv.time );
 		VM_Call (gvm, GAME_RUN_FRAME, sv.time);
 	}
 
@@ -1201,6 +1378,8 @@ int SV_SendQueuedPackets()
 	static int dlNextRound = 0;
 	int timeVal = INT_MAX;
 
+	NET_BeginSendBatch();
+
 	// Send out fragmented packets now that we're idle
 	delayT = SV_SendQueuedMessages();
 	if(delayT >= 0)
@@ -1261,5 +1440,7 @@ int SV_SendQueuedPackets()
 			timeVal = 0;
 	}
 
+	NET_EndSendBatch();
+
 	return timeVal;
 }
@@ -0,0 +1,708 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Quake III Arena source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+
+#include "server.h"
+
+/*
+=============================================================================
+
+GAME RECORDING
+
+When sv_recordGame is set, every map load writes replays/<name>.rpl with
+the random seed handed to the game and everything the game module is told
+afterwards: client connects, userinfo changes, usercmds, client and
+console commands and frame times.  replaygame feeds a recording back into
+the game module with no network and no clients, as fast as it will go.
+
+=============================================================================
+*/
+
+#define	GAMERECORD_IDENT		(('L'<<24)+('P'<<16)+('R'<<8)+'Z')
+#define	GAMERECORD_VERSION		1
+
+static fileHandle_t	sv_recordFile;
+static int			sv_gameSeed;			// seed of the running game, for the header
+
+static qboolean		sv_replaying;
+static int			sv_replaySeed;
+
+/*
+==================
+SV_GameRandomSeed
+
+Seed for GAME_INIT, taken from the recording while replaying so
+the game module makes the same random choices
+==================
+*/
+int SV_GameRandomSeed( void ) {
+	if ( sv_replaying ) {
+		sv_gameSeed = sv_replaySeed;
+	} else {
+		sv_gameSeed = Com_Milliseconds();
+	}
+	return sv_gameSeed;
+}
+
+/*
+==================
+SV_GameStateHash
+
+FNV-1a over the entity state of every linked entity and the
+player state of every active client
+==================
+*/
+unsigned SV_GameStateHash( void ) {
+	unsigned		hash;
+	int				i, j;
+	sharedEntity_t	*ent;
+	const byte		*b;
+
+	hash = 2166136261u;
+	for ( i = 0 ; i < sv.num_entities ; i++ ) {
+		ent = SV_GentityNum( i );
+		if ( !ent->r.linked ) {
+			continue;
+		}
+		b = (const byte *)&ent->s;
+		for ( j = 0 ; j < sizeof( ent->s ) ; j++ ) {
+			hash = ( hash ^ b[j] ) * 16777619u;
+		}
+	}
+
+	for ( i = 0 ; i < sv_maxclients->integer ; i++ ) {
+		if ( svs.clients[i].state != CS_ACTIVE ) {
+			continue;
+		}
+		b = (const byte *)SV_GameClientNum( i );
+		for ( j = 0 ; j < sizeof( playerState_t ) ; j++ ) {
+			hash = ( hash ^ b[j] ) * 16777619u;
+		}
+	}
+
+	return hash;
+}
+
+/*
+=============================================================================
+
+WRITING
+
+=============================================================================
+*/
+
+static void SV_RecordInt( int value ) {
+	value = LittleLong( value );
+	FS_Write( &value, 4, sv_recordFile );
+}
+
+static void SV_RecordByte( int value ) {
+	byte	b;
+
+	b = value;
+	FS_Write( &b, 1, sv_recordFile );
+}
+
+static void SV_RecordString( const char *s ) {
+	int		len;
+
+	len = strlen( s );
+	SV_RecordInt( len );
+	FS_Write( s, len, sv_recordFile );
+}
+
+static void SV_RecordUsercmd( const usercmd_t *cmd ) {
+	SV_RecordInt( cmd->serverTime );
+	SV_RecordInt( cmd->angles[0] );
+	SV_RecordInt( cmd->angles[1] );
+	SV_RecordInt( cmd->angles[2] );
+	SV_RecordInt( cmd->buttons );
+	SV_RecordByte( cmd->weapon );
+	SV_RecordByte( cmd->forwardmove );
+	SV_RecordByte( cmd->rightmove );
+	SV_RecordByte( cmd->upmove );
+	SV_RecordByte( cmd->tier );
+	SV_RecordByte( cmd->weaponSelectionMode );
+	SV_RecordByte( cmd->tierSelectionMode );
+}
+
+/*
+==================
+SV_RecordArgs
+
+The current command line, with every argument quoted so
+that Cmd_TokenizeString gives back the same arguments
+==================
+*/
+static void SV_RecordArgs( void ) {
+	char	line[MAX_STRING_CHARS];
+	int		i;
+
+	line[0] = 0;
+	for ( i = 0 ; i < Cmd_Argc() ; i++ ) {
+		Q_strcat( line, sizeof( line ), va( "%s\"%s\"", i ? " " : "", Cmd_Argv( i ) ) );
+	}
+	SV_RecordString( line );
+}
+
+/*
+==================
+SV_GameRecordBegin
+
+Called at the end of SV_SpawnServer.  Clients that were carried over
+from the previous map were reconnected before recording could start,
+so they are written out as reconnects.
+==================
+*/
+void SV_GameRecordBegin( void ) {
+	int		i;
+
+	SV_GameRecordStop();
+
+	if ( sv_replaying || !sv_recordGame->string[0] ) {
+		return;
+	}
+
+	sv_recordFile = FS_FOpenFileWrite( va( "replays/%s.rpl", sv_recordGame->string ) );
+	if ( !sv_recordFile ) {
+		Com_Printf( "ERROR: couldn't open replays/%s.rpl\n", sv_recordGame->string );
+		return;
+	}
+	Com_Printf( "recording game to replays/%s.rpl\n", sv_recordGame->string );
+
+	SV_RecordInt( GAMERECORD_IDENT );
+	SV_RecordInt( GAMERECORD_VERSION );
+	SV_RecordString( sv_mapname->string );
+	SV_RecordInt( sv_gametype->integer );
+	SV_RecordInt( sv_maxclients->integer );
+	SV_RecordInt( sv_gameSeed );
+	SV_RecordInt( sv.time );
+
+	for ( i = 0 ; i < sv_maxclients->integer ; i++ ) {
+		if ( svs.clients[i].state >= CS_CONNECTED ) {
+			SV_GameRecordClient( GR_RECONNECT, &svs.clients[i] );
+		}
+	}
+}
+
+/*
+==================
+SV_GameRecordStop
+
+Ends the recording with a hash of the final game state
+==================
+*/
+void SV_GameRecordStop( void ) {
+	if ( !sv_recordFile ) {
+		return;
+	}
+
+	SV_RecordByte( GR_END );
+	SV_RecordInt( SV_GameStateHash() );
+	FS_FCloseFile( sv_recordFile );
+	sv_recordFile = 0;
+}
+
+/*
+==================
+SV_GameRecordFrame
+==================
+*/
+void SV_GameRecordFrame( int time ) {
+	if ( !sv_recordFile ) {
+		return;
+	}
+	SV_RecordByte( GR_FRAME );
+	SV_RecordInt( time );
+}
+
+/*
+==================
+SV_GameRecordClient
+
+Records a client event just before it is passed to the game
+==================
+*/
+void SV_GameRecordClient( gameRecord_t type, client_t *cl ) {
+	if ( !sv_recordFile ) {
+		return;
+	}
+
+	SV_RecordByte( type );
+	SV_RecordByte( cl - svs.clients );
+
+	switch ( type ) {
+	case GR_CONNECT:
+	case GR_RECONNECT:
+	case GR_USERINFO:
+		SV_RecordString( cl->userinfo );
+		break;
+	case GR_BEGIN:
+	case GR_USERCMD:
+		SV_RecordUsercmd( &cl->lastUsercmd );
+		break;
+	case GR_CLIENTCOMMAND:
+		SV_RecordArgs();
+		break;
+	default:
+		break;
+	}
+}
+
+/*
+==================
+SV_GameRecordCommand
+
+Records a console command offered to the game
+==================
+*/
+void SV_GameRecordCommand( void ) {
+	if ( !sv_recordFile ) {
+		return;
+	}
+	SV_RecordByte( GR_CONSOLECOMMAND );
+	SV_RecordArgs();
+}
+
+/*
+=============================================================================
+
+REPLAY
+
+=============================================================================
+*/
+
+typedef struct {
+	byte	*data;
+	int		size;
+	int		readcount;
+	qboolean	overflowed;
+} replayFile_t;
+
+// owned by replaygame until it finishes or SV_ReplayShutdown cleans up
+static replayFile_t	sv_replayFile;
+static char			sv_replayOldProfile[MAX_CVAR_VALUE_STRING];
+static char			sv_replayOldGametype[MAX_CVAR_VALUE_STRING];
+static char			sv_replayOldMaxclients[MAX_CVAR_VALUE_STRING];
+
+static int SV_ReplayInt( replayFile_t *rf ) {
+	int		value;
+
+	if ( rf->readcount + 4 > rf->size ) {
+		rf->overflowed = qtrue;
+		return 0;
+	}
+	Com_Memcpy( &value, rf->data + rf->readcount, 4 );
+	rf->readcount += 4;
+	return LittleLong( value );
+}
+
+static int SV_ReplayByte( replayFile_t *rf ) {
+	if ( rf->readcount + 1 > rf->size ) {
+		rf->overflowed = qtrue;
+		return 0;
+	}
+	return rf->data[rf->readcount++];
+}
+
+static void SV_ReplayString( replayFile_t *rf, char *buffer, int bufferSize ) {
+	int		len;
+
+	len = SV_ReplayInt( rf );
+	if ( len < 0 || rf->readcount + len > rf->size ) {
+		rf->overflowed = qtrue;
+		buffer[0] = 0;
+		return;
+	}
+	Q_strncpyz( buffer, (char *)rf->data + rf->readcount, len + 1 < bufferSize ? len + 1 : bufferSize );
+	rf->readcount += len;
+}
+
+static void SV_ReplayUsercmd( replayFile_t *rf, usercmd_t *cmd ) {
+	cmd->serverTime = SV_ReplayInt( rf );
+	cmd->angles[0] = SV_ReplayInt( rf );
+	cmd->angles[1] = SV_ReplayInt( rf );
+	cmd->angles[2] = SV_ReplayInt( rf );
+	cmd->buttons = SV_ReplayInt( rf );
+	cmd->weapon = SV_ReplayByte( rf );
+	cmd->forwardmove = (signed char)SV_ReplayByte( rf );
+	cmd->rightmove = (signed char)SV_ReplayByte( rf );
+	cmd->upmove = (signed char)SV_ReplayByte( rf );
+	cmd->tier = (signed char)SV_ReplayByte( rf );
+	cmd->weaponSelectionMode = SV_ReplayByte( rf );
+	cmd->tierSelectionMode = SV_ReplayByte( rf );
+}
+
+/*
+==================
+SV_ReplayClientConnect
+
+Stands in for SV_DirectConnect without a network address
+==================
+*/
+static void SV_ReplayClientConnect( client_t *cl, const char *userinfo, qboolean firstTime ) {
+	int		clientNum;
+
+	clientNum = cl - svs.clients;
+
+	Com_Memset( cl, 0, sizeof( *cl ) );
+	cl->gentity = SV_GentityNum( clientNum );
+	cl->netchan_end_queue = &cl->netchan_start_queue;
+	Q_strncpyz( cl->userinfo, userinfo, sizeof( cl->userinfo ) );
+	Q_strncpyz( cl->name, Info_ValueForKey( userinfo, "name" ), sizeof( cl->name ) );
+
+	if ( VM_Call( gvm, GAME_CLIENT_CONNECT, clientNum, firstTime, qfalse ) ) {
+		cl->state = CS_FREE;
+		return;
+	}
+	cl->state = CS_CONNECTED;
+}
+
+/*
+==================
+SV_ReplayRun
+
+Plays one recording through the game module.  Returns the
+final state hash, or 0 with *error set if the file is bad.
+==================
+*/
+static unsigned SV_ReplayRun( replayFile_t *rf, int startTime, qboolean *error ) {
+	char		text[MAX_INFO_STRING];
+	usercmd_t	cmd;
+	client_t	*cl;
+	int			type, clientNum, time, i;
+	int			startMsec, eventMsec, totalMsec;
+	int			thinkMsec, frameMsec;
+	int			frames, usercmds;
+	int			totalThink, totalFrame, maxThink, maxFrame;
+	unsigned	hash, recordedHash;
+	qboolean	ended;
+
+	*error = qfalse;
+	frames = usercmds = 0;
+	thinkMsec = 0;
+	totalThink = totalFrame = maxThink = maxFrame = 0;
+	recordedHash = 0;
+	ended = qfalse;
+	sv.time = startTime;
+
+	totalMsec = Sys_Milliseconds();
+	while ( !ended && !rf->overflowed && rf->readcount < rf->size ) {
+		type = SV_ReplayByte( rf );
+
+		if ( type == GR_END ) {
+			recordedHash = SV_ReplayInt( rf );
+			ended = qtrue;
+			break;
+		}
+
+		if ( type == GR_FRAME ) {
+			time = SV_ReplayInt( rf );
+
+			svs.time += time - sv.time;
+			sv.time = time;
+
+			startMsec = Sys_Milliseconds();
+			VM_Call( gvm, GAME_RUN_FRAME, sv.time );
+			frameMsec = Sys_Milliseconds() - startMsec;
+
+			totalThink += thinkMsec;
+			totalFrame += frameMsec;
+			if ( thinkMsec > maxThink ) {
+				maxThink = thinkMsec;
+			}
+			if ( frameMsec > maxFrame ) {
+				maxFrame = frameMsec;
+			}
+			thinkMsec = 0;
+			frames++;
+
+			// nobody acknowledges the reliable commands the game sends,
+			// don't let them overflow and drop the client
+			for ( i = 0, cl = svs.clients ; i < sv_maxclients->integer ; i++, cl++ ) {
+				cl->reliableAcknowledge = cl->reliableSequence;
+			}
+			continue;
+		}
+
+		if ( type == GR_CONSOLECOMMAND ) {
+			SV_ReplayString( rf, text, sizeof( text ) );
+			Cmd_TokenizeString( text );
+			VM_Call( gvm, GAME_CONSOLE_COMMAND );
+			continue;
+		}
+
+		clientNum = SV_ReplayByte( rf );
+		if ( clientNum >= sv_maxclients->integer ) {
+			Com_Printf( "replay: client %i out of range\n", clientNum );
+			*error = qtrue;
+			return 0;
+		}
+		cl = &svs.clients[clientNum];
+
+		switch ( type ) {
+		case GR_CONNECT:
+		case GR_RECONNECT:
+			SV_ReplayString( rf, text, sizeof( text ) );
+			SV_ReplayClientConnect( cl, text, type == GR_CONNECT );
+			break;
+		case GR_BEGIN:
+			SV_ReplayUsercmd( rf, &cmd );
+			if ( cl->state >= CS_CONNECTED ) {
+				SV_ClientEnterWorld( cl, &cmd );
+			}
+			break;
+		case GR_USERINFO:
+			SV_ReplayString( rf, text, sizeof( text ) );
+			if ( cl->state >= CS_CONNECTED ) {
+				Q_strncpyz( cl->userinfo, text, sizeof( cl->userinfo ) );
+				VM_Call( gvm, GAME_CLIENT_USERINFO_CHANGED, clientNum );
+			}
+			break;
+		case GR_DISCONNECT:
+			if ( cl->state >= CS_CONNECTED ) {
+				VM_Call( gvm, GAME_CLIENT_DISCONNECT, clientNum );
+				SV_SetUserinfo( clientNum, "" );
+				cl->state = CS_FREE;
+			}
+			break;
+		case GR_USERCMD:
+			SV_ReplayUsercmd( rf, &cmd );
+			eventMsec = Sys_Milliseconds();
+			SV_ClientThink( cl, &cmd );
+			thinkMsec += Sys_Milliseconds() - eventMsec;
+			usercmds++;
+			break;
+		case GR_CLIENTCOMMAND:
+			SV_ReplayString( rf, text, sizeof( text ) );
+			if ( cl->state == CS_ACTIVE || cl->state == CS_PRIMED ) {
+				Cmd_TokenizeString( text );
+				VM_Call( gvm, GAME_CLIENT_COMMAND, clientNum );
+			}
+			break;
+		default:
+			Com_Printf( "replay: bad record type %i\n", type );
+			*error = qtrue;
+			return 0;
+		}
+	}
+	totalMsec = Sys_Milliseconds() - totalMsec;
+
+	if ( rf->overflowed ) {
+		Com_Printf( "replay: recording is truncated\n" );
+	}
+
+	hash = SV_GameStateHash();
+
+	Com_Printf( "%i frames, %i usercmds in %i msec", frames, usercmds, totalMsec );
+	if ( totalMsec ) {
+		Com_Printf( " (%.1f frames/sec)", frames * 1000.0f / totalMsec );
+	}
+	Com_Printf( "\n" );
+	if ( frames ) {
+		Com_Printf( "stage        mean msec   max msec\n" );
+		Com_Printf( "clientthink %11.3f %10i\n", (float)totalThink / frames, maxThink );
+		Com_Printf( "runframe    %11.3f %10i\n", (float)totalFrame / frames, maxFrame );
+	}
+
+	if ( ended ) {
+		Com_Printf( "state hash %08x, recording ended with %08x%s\n", hash, recordedHash,
+			hash == recordedHash ? "" : " (MISMATCH)" );
+	} else {
+		Com_Printf( "state hash %08x, recording has no end\n", hash );
+	}
+
+	return hash;
+}
+
+/*
+==================
+SV_ReplayFinish
+
+Restores the cvars replaygame overrode and frees the recording
+==================
+*/
+static void SV_ReplayFinish( void ) {
+	sv_replaying = qfalse;
+
+	Cvar_Set( "g_profile", sv_replayOldProfile );
+	Cvar_Set( "g_gametype", sv_replayOldGametype );
+	Cvar_Set( "sv_maxclients", sv_replayOldMaxclients );
+
+	Z_Free( sv_replayFile.data );
+	Com_Memset( &sv_replayFile, 0, sizeof( sv_replayFile ) );
+}
+
+/*
+==================
+SV_ReplayShutdown
+
+Called from SV_Shutdown.  A replay run only shuts the server down
+itself after clearing sv_replaying, so if it is still set the map
+load or the game module threw an error mid replay.
+==================
+*/
+void SV_ReplayShutdown( void ) {
+	if ( sv_replaying ) {
+		SV_ReplayFinish();
+	}
+}
+
+/*
+==================
+SV_ReplayHeader
+
+Reads the recording header into the replay cvars.  Returns qfalse
+if the file is not a usable recording.
+==================
+*/
+static qboolean SV_ReplayHeader( replayFile_t *rf, const char *name, char *mapname, int mapnameSize,
+								 int *gametype, int *maxclients, int *startTime ) {
+	int		header;
+
+	rf->readcount = 0;
+	rf->overflowed = qfalse;
+
+	if ( SV_ReplayInt( rf ) != GAMERECORD_IDENT ) {
+		Com_Printf( "%s is not a game recording\n", name );
+		return qfalse;
+	}
+	if ( ( header = SV_ReplayInt( rf ) ) != GAMERECORD_VERSION ) {
+		Com_Printf( "%s has version %i, should be %i\n", name, header, GAMERECORD_VERSION );
+		return qfalse;
+	}
+	SV_ReplayString( rf, mapname, mapnameSize );
+	*gametype = SV_ReplayInt( rf );
+	*maxclients = SV_ReplayInt( rf );
+	sv_replaySeed = SV_ReplayInt( rf );
+	*startTime = SV_ReplayInt( rf );
+
+	return !rf->overflowed;
+}
+
+/*
+==================
+SV_ReplayGame_f
+
+replaygame <name> [runs]
+
+Loads the recorded map and plays the recording through the game
+module as fast as possible, reporting the cost of client thinks and
+game frames.  The game's own stage costs are printed by its
+gameprofile command.  With more than one run the final state hashes
+are compared.  The replayed clients take over the client slots, so
+this only runs while no server is up.
+==================
+*/
+void SV_ReplayGame_f( void ) {
+	replayFile_t	*rf = &sv_replayFile;
+	void		*buffer;
+	char		name[MAX_QPATH];
+	char		mapname[MAX_QPATH];
+	int			runs, run, gametype, maxclients, startTime, size, i;
+	unsigned	hash, firstHash;
+	qboolean	error;
+
+	if ( Cmd_Argc() < 2 ) {
+		Com_Printf( "usage: replaygame <name> [runs]\n" );
+		return;
+	}
+
+	if ( com_sv_running->integer ) {
+		Com_Printf( "replaygame can't run while a server is running, use killserver first\n" );
+		return;
+	}
+
+	Com_sprintf( name, sizeof( name ), "replays/%s.rpl", Cmd_Argv( 1 ) );
+	runs = Cmd_Argc() > 2 ? atoi( Cmd_Argv( 2 ) ) : 1;
+	if ( runs < 1 ) {
+		runs = 1;
+	}
+
+	size = FS_ReadFile( name, &buffer );
+	if ( size <= 0 ) {
+		Com_Printf( "Couldn't load %s\n", name );
+		return;
+	}
+
+	// the hunk is cleared by every map load, keep our own copy
+	rf->data = Z_Malloc( size );
+	rf->size = size;
+	Com_Memcpy( rf->data, buffer, size );
+	FS_FreeFile( buffer );
+
+	// check everything that can be checked before touching any state
+	if ( !SV_ReplayHeader( rf, name, mapname, sizeof( mapname ), &gametype, &maxclients, &startTime ) ) {
+		Z_Free( rf->data );
+		Com_Memset( rf, 0, sizeof( *rf ) );
+		return;
+	}
+	if ( FS_ReadFile( va( "maps/%s.bsp", mapname ), NULL ) <= 0 ) {
+		Com_Printf( "Can't find map maps/%s.bsp\n", mapname );
+		Z_Free( rf->data );
+		Com_Memset( rf, 0, sizeof( *rf ) );
+		return;
+	}
+
+	SV_GameRecordStop();
+	Cvar_VariableStringBuffer( "g_profile", sv_replayOldProfile, sizeof( sv_replayOldProfile ) );
+	Cvar_VariableStringBuffer( "g_gametype", sv_replayOldGametype, sizeof( sv_replayOldGametype ) );
+	Cvar_VariableStringBuffer( "sv_maxclients", sv_replayOldMaxclients, sizeof( sv_replayOldMaxclients ) );
+	Cvar_Set( "g_profile", "1" );
+	Cvar_Set( "g_gametype", va( "%i", gametype ) );
+	Cvar_Set( "sv_maxclients", va( "%i", maxclients ) );
+
+	firstHash = 0;
+	for ( run = 0 ; run < runs ; run++ ) {
+		SV_ReplayHeader( rf, name, mapname, sizeof( mapname ), &gametype, &maxclients, &startTime );
+
+		Com_Printf( "----- replay %i of %i: %s -----\n", run + 1, runs, mapname );
+
+		// an error from here on lands in SV_Shutdown, which cleans up
+		sv_replaying = qtrue;
+		SV_SpawnServer( mapname );
+
+		hash = SV_ReplayRun( rf, startTime, &error );
+		if ( !error ) {
+			Cmd_TokenizeString( "gameprofile" );
+			VM_Call( gvm, GAME_CONSOLE_COMMAND );
+		}
+
+		// the replayed clients have no connection to send a final message to
+		for ( i = 0 ; i < sv_maxclients->integer ; i++ ) {
+			svs.clients[i].state = CS_FREE;
+		}
+		sv_replaying = qfalse;
+		SV_Shutdown( "Replay finished\n" );
+
+		if ( error ) {
+			break;
+		}
+		if ( run == 0 ) {
+			firstHash = hash;
+		} else if ( hash != firstHash ) {
+			Com_Printf( "WARNING: run %i ended with state hash %08x, run 1 ended with %08x\n",
+				run + 1, hash, firstHash );
+		}
+	}
+
+	SV_ReplayFinish();
+}
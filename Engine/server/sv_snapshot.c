@@ -124,6 +124,7 @@ static void SV_WriteSnapshotToClient( client_t *client, msg_t *msg ) {
 	int					lastframe;
 	int					i;
 	int					snapFlags;
+	int					protocol;
 
 	// this is the snapshot we are creating
 	frame = &client->frames[ client->netchan.outgoingSequence & PACKET_MASK ];
@@ -190,10 +191,16 @@ static void SV_WriteSnapshotToClient( client_t *client, msg_t *msg ) {
 	MSG_WriteData (msg, frame->areabits, frame->areabytes);
 
 	// delta encode the playerstate
+	protocol = com_protocol->integer;
+#ifdef LEGACY_PROTOCOL
+	if ( client->compat ) {
+		protocol = com_legacyprotocol->integer;
+	}
+#endif
 	if ( oldframe ) {
-		MSG_WriteDeltaPlayerstate( msg, &oldframe->ps, &frame->ps );
+		MSG_WriteDeltaPlayerstate( msg, &oldframe->ps, &frame->ps, protocol );
 	} else {
-		MSG_WriteDeltaPlayerstate( msg, NULL, &frame->ps );
+		MSG_WriteDeltaPlayerstate( msg, NULL, &frame->ps, protocol );
 	}
 
 	// delta encode the entities
@@ -427,6 +434,218 @@ static void SV_AddEntitiesVisibleFromPoint( vec3_t origin, clientSnapshot_t *fra
 	}
 }
 
+/*
+=============================================================================
+
+Entity interest
+
+On open maps the PVS holds nearly everything, so after the PVS test each
+entity is scored by size and distance.  Distant or small entities keep the
+state the client last got from us, which costs nothing to delta, and only
+get fresh states every few snapshots.  Their trajectories keep them moving
+on the client in between.
+
+=============================================================================
+*/
+
+#define	INTEREST_MIN_RADIUS		32		// size every entity counts as at least
+#define	INTEREST_ENTITY_BYTES	24		// rough cost of a changed entity
+#define	INTEREST_FRAME_BYTES	200		// playerstate and message overhead
+
+typedef struct {
+	int				index;			// into snapshotEntityNumbers_t
+	float			interest;
+	entityState_t	*sent;			// state in the previous snapshot
+} interestEntity_t;
+
+static interestEntity_t	interestEntities[MAX_SNAPSHOT_ENTITIES];
+
+/*
+=============
+SV_EntityInterest
+
+How relevant an entity is to a viewer at org.  Returns -1 for entities
+that always get their current state: clients, broadcast entities, ones
+the game flags with SVF_RELEVANT, the viewer's own entities and the
+viewer's lock-on target.
+=============
+*/
+static float SV_EntityInterest( playerState_t *ps, sharedEntity_t *ent, vec3_t org ) {
+	vec3_t	center, size;
+	float	radius, dist;
+
+	if ( ent->s.number < sv_maxclients->integer ||
+		( ent->r.svFlags & ( SVF_BROADCAST | SVF_RELEVANT ) ) ||
+		ent->r.ownerNum == ps->clientNum ||
+		ent->s.number == ps->lockedTarget - 1 ) {
+		return -1;
+	}
+
+	VectorAdd( ent->r.absmin, ent->r.absmax, center );
+	VectorScale( center, 0.5f, center );
+	VectorSubtract( ent->r.absmax, ent->r.absmin, size );
+	radius = VectorLength( size ) * 0.5f;
+	if ( radius < INTEREST_MIN_RADIUS ) {
+		radius = INTEREST_MIN_RADIUS;
+	}
+
+	dist = Distance( center, org ) - radius;
+	if ( dist < 1 ) {
+		dist = 1;
+	}
+
+	return radius / dist;
+}
+
+/*
+=============
+SV_InterestChanged
+
+Changes that can't wait, because the client would lose an event
+or keep showing the wrong thing.
+=============
+*/
+static qboolean SV_InterestChanged( entityState_t *sent, entityState_t *current ) {
+	return sent->eType != current->eType || sent->event != current->event ||
+		sent->eventParm != current->eventParm || sent->modelindex != current->modelindex ||
+		sent->solid != current->solid || sent->pos.trType != current->pos.trType ||
+		( ( sent->eFlags ^ current->eFlags ) & EF_TELEPORT_BIT );
+}
+
+/*
+=============
+SV_QsortInterest
+=============
+*/
+static int QDECL SV_QsortInterest( const void *a, const void *b ) {
+	float	ia, ib;
+
+	ia = ((interestEntity_t *)a)->interest;
+	ib = ((interestEntity_t *)b)->interest;
+	if ( ia < ib ) {
+		return -1;
+	}
+	return ia > ib;
+}
+
+/*
+=============
+SV_InterestFilter
+
+Picks the state to send for every entity in eNums.  Entities of low
+interest keep the state from the previous snapshot, first by distance
+and then, least interesting first, until the changed ones fit into the
+client's rate.  Nothing is held back for longer than sv_interestMaxDelay.
+=============
+*/
+static void SV_InterestFilter( client_t *client, playerState_t *ps, vec3_t org,
+								snapshotEntityNumbers_t *eNums, entityState_t **states ) {
+	clientSnapshot_t	*prev;
+	entityState_t		*sent;
+	sharedEntity_t		*ent;
+	interestEntity_t	*ie;
+	int					i, num, prevIndex;
+	int					numCandidates, numHeld;
+	int					budget, cost, interval, fullRateMsec;
+	float				interest, fullRateInterest;
+
+	for ( i = 0 ; i < eNums->numSnapshotEntities ; i++ ) {
+		states[i] = &SV_GentityNum( eNums->snapshotEntities[i] )->s;
+	}
+
+	if ( !sv_interest->integer || client->state != CS_ACTIVE || client->deltaMessage <= 0 ||
+		client->netchan.outgoingSequence - 1 <= client->gamestateMessageNum ) {
+		return;
+	}
+
+	// the states sent last time have to still be around, and stay
+	// there while this snapshot is copied into svs.snapshotEntities
+	prev = &client->frames[ ( client->netchan.outgoingSequence - 1 ) & PACKET_MASK ];
+	if ( prev->first_entity <= svs.nextSnapshotEntities + eNums->numSnapshotEntities - svs.numSnapshotEntities ) {
+		return;
+	}
+
+	fullRateMsec = client->snapshotMsec > 0 ? client->snapshotMsec : 1000 / sv_fps->integer;
+	fullRateInterest = INTEREST_MIN_RADIUS / ( sv_interestDistance->value > 1 ? sv_interestDistance->value : 1 );
+
+	if ( client->rate > 0 ) {
+		budget = client->rate * fullRateMsec / 1000 - INTEREST_FRAME_BYTES;
+	} else {
+		budget = 0x7fffffff;
+	}
+
+	cost = 0;
+	numCandidates = 0;
+	numHeld = 0;
+	prevIndex = 0;
+	for ( i = 0 ; i < eNums->numSnapshotEntities ; i++ ) {
+		num = eNums->snapshotEntities[i];
+		ent = SV_GentityNum( num );
+
+		// find what the client got last time, both lists are sorted
+		sent = NULL;
+		for ( ; prevIndex < prev->num_entities ; prevIndex++ ) {
+			sent = &svs.snapshotEntities[ ( prev->first_entity + prevIndex ) % svs.numSnapshotEntities ];
+			if ( sent->number >= num ) {
+				break;
+			}
+		}
+		if ( prevIndex == prev->num_entities || sent->number != num ) {
+			sent = NULL;
+		}
+
+		interest = SV_EntityInterest( ps, ent, org );
+		if ( !sent || interest < 0 || SV_InterestChanged( sent, &ent->s ) ||
+			svs.time - client->entityUpdateTime[num] >= sv_interestMaxDelay->integer ) {
+			client->entityUpdateTime[num] = svs.time;
+			cost += INTEREST_ENTITY_BYTES;
+			continue;
+		}
+
+		// nothing to save on an entity that didn't change
+		if ( !memcmp( sent, &ent->s, sizeof( entityState_t ) ) ) {
+			client->entityUpdateTime[num] = svs.time;
+			continue;
+		}
+
+		// distant ones are only updated every few snapshots
+		if ( interest < fullRateInterest ) {
+			interval = fullRateMsec * fullRateInterest / interest;
+			if ( svs.time - client->entityUpdateTime[num] < interval ) {
+				states[i] = sent;
+				numHeld++;
+				continue;
+			}
+		}
+
+		ie = &interestEntities[numCandidates++];
+		ie->index = i;
+		ie->interest = interest;
+		ie->sent = sent;
+		cost += INTEREST_ENTITY_BYTES;
+	}
+
+	// hold back the least interesting until the rest fits
+	if ( cost > budget ) {
+		qsort( interestEntities, numCandidates, sizeof( interestEntities[0] ), SV_QsortInterest );
+	}
+	for ( i = 0 ; i < numCandidates ; i++ ) {
+		ie = &interestEntities[i];
+		if ( cost > budget ) {
+			states[ie->index] = ie->sent;
+			cost -= INTEREST_ENTITY_BYTES;
+			numHeld++;
+		} else {
+			client->entityUpdateTime[ eNums->snapshotEntities[ie->index] ] = svs.time;
+		}
+	}
+
+	if ( sv_interest->integer > 1 ) {
+		Com_Printf( "%s: %i entities, %i held back, ~%i of %i bytes\n", client->name,
+			eNums->numSnapshotEntities, numHeld, cost, budget );
+	}
+}
+
 /*
 =============
 SV_BuildClientSnapshot
@@ -445,12 +664,12 @@ static void SV_BuildClientSnapshot( client_t *client ) {
 	clientSnapshot_t			*frame;
 	snapshotEntityNumbers_t		entityNumbers;
 	int							i;
-	sharedEntity_t				*ent;
 	entityState_t				*state;
 	svEntity_t					*svEnt;
 	sharedEntity_t				*clent;
 	int							clientNum;
 	playerState_t				*ps;
+	entityState_t				*states[MAX_SNAPSHOT_ENTITIES];
 
 	// bump the counter used to prevent double adding
 	sv.snapshotCounter++;
@@ -499,6 +718,9 @@ static void SV_BuildClientSnapshot( client_t *client ) {
 	qsort( entityNumbers.snapshotEntities, entityNumbers.numSnapshotEntities, 
 		sizeof( entityNumbers.snapshotEntities[0] ), SV_QsortEntityNumbers );
 
+	// decide which entities get their current state
+	SV_InterestFilter( client, ps, org, &entityNumbers, states );
+
 	// now that all viewpoint's areabits have been OR'd together, invert
 	// all of them to make it a mask vector, which is what the renderer wants
 	for ( i = 0 ; i < MAX_MAP_AREA_BYTES/4 ; i++ ) {
@@ -509,9 +731,8 @@ static void SV_BuildClientSnapshot( client_t *client ) {
 	frame->num_entities = 0;
 	frame->first_entity = svs.nextSnapshotEntities;
 	for ( i = 0 ; i < entityNumbers.numSnapshotEntities ; i++ ) {
-		ent = SV_GentityNum(entityNumbers.snapshotEntities[i]);
 		state = &svs.snapshotEntities[svs.nextSnapshotEntities % svs.numSnapshotEntities];
-		*state = ent->s;
+		*state = *states[i];
 		svs.nextSnapshotEntities++;
 		// this should never hit, map should always be restarted first in SV_Frame
 		if ( svs.nextSnapshotEntities >= 0x7FFFFFFE ) {
@@ -640,6 +861,9 @@ void SV_SendClientMessages(void)
 	int		i;
 	client_t	*c;
 
+	// hand all snapshots of this frame to the kernel in one go
+	NET_BeginSendBatch();
+
 	// send a message to each connected client
 	for(i=0; i < sv_maxclients->integer; i++)
 	{
@@ -678,4 +902,6 @@ void SV_SendClientMessages(void)
 		c->lastSnapshotTime = svs.time;
 		c->rateDelayed = qfalse;
 	}
+
+	NET_EndSendBatch();
 }
@@ -79,61 +79,69 @@ void CG_Aura_MarkRootPoint( auraState_t *state){
 
 /*
 =======================
-CG_Aura_GetHullPoints
+CG_Aura_RegisterTags
 =======================
-  Reads and prepares the positions of the tags for a convex hull aura.
+  Resolves the tag_aura# names of one model part to tag handles.
+  Only redone when the part's model or the tag count changes.
 */
 #define MAX_AURATAGNAME 12
-static void CG_Aura_GetHullPoints( centity_t *player, auraState_t *state, auraConfig_t *config){
+static void CG_Aura_RegisterTags( auraState_t *state, int part, qhandle_t model, int numTags){
 	char		tagName[MAX_AURATAGNAME];
-	int			i, j;
-	clientInfo_t	*ci;
-	ci = &cgs.clientinfo[player->currentState.clientNum];
-	j = 0;
-	
+	int			i, handle;
+
+	if (numTags > MAX_AURATAGS_PER_PART) numTags = MAX_AURATAGS_PER_PART;
 
-	for (i = 0;i < config->numTags[0];i++){
-		orientation_t tagOrient;
-			
-		// Lerp the tag's position
+	state->tagModels[part] = model;
+	state->tagsRequested[part] = numTags;
+	state->numTagHandles[part] = 0;
+
+	for (i = 0;i < numTags;i++){
 		Com_sprintf( tagName, sizeof(tagName), "tag_aura%i", i);
-			
-		if (!CG_GetTagOrientationFromPlayerEntityHeadModel( player, tagName, &tagOrient)) continue;
-		VectorCopy( tagOrient.origin, state->convexHull[j].pos_world);
 
-		if (CG_WorldCoordToScreenCoordVec( state->convexHull[j].pos_world, state->convexHull[j].pos_screen)){
-			state->convexHull[j].is_tail = qfalse;
-			j++;
-		}
+		handle = trap_R_RegisterTag( model, tagName);
+		if (handle < 0) continue;
+		state->tagHandles[part][state->numTagHandles[part]++] = handle;
 	}
+}
 
-	for (i = 0;i < config->numTags[1];i++){
-		orientation_t tagOrient;
-			
-		// Lerp the tag's position
-		Com_sprintf( tagName, sizeof(tagName), "tag_aura%i", i);
-			
-		if(!CG_GetTagOrientationFromPlayerEntityTorsoModel( player, tagName, &tagOrient)) continue;
-		VectorCopy( tagOrient.origin, state->convexHull[j].pos_world);
 
-		if (CG_WorldCoordToScreenCoordVec( state->convexHull[j].pos_world, state->convexHull[j].pos_screen)){
-			state->convexHull[j].is_tail = qfalse;
-			j++;
+/*
+=======================
+CG_Aura_GetHullPoints
+=======================
+  Reads and prepares the positions of the tags for a convex hull aura.
+*/
+static void CG_Aura_GetHullPoints( centity_t *player, auraState_t *state, auraConfig_t *config){
+	orientation_t	tagOrients[MAX_AURATAGS_PER_PART];
+	int			i, j, part, numTags;
+	qhandle_t	model;
+	static const playerPart_t parts[3] = { PLAYERPART_HEAD, PLAYERPART_TORSO, PLAYERPART_LEGS };
+	j = 0;
+
+	for (part = 0;part < 3;part++){
+		if (config->numTags[part] <= 0) continue;
+
+		model = CG_GetPlayerEntityPartModel( player, parts[part]);
+		if (!model) continue;
+
+		// Numbers of tags can differ between tiers, so a tier change re-resolves as well
+		numTags = config->numTags[part] < MAX_AURATAGS_PER_PART ? config->numTags[part] : MAX_AURATAGS_PER_PART;
+		if (model != state->tagModels[part] || numTags != state->tagsRequested[part]){
+			CG_Aura_RegisterTags( state, part, model, numTags);
 		}
-	}
 
-	for (i = 0;i < config->numTags[2];i++){
-		orientation_t tagOrient;
-			
-		// Lerp the tag's position
-		Com_sprintf( tagName, sizeof(tagName), "tag_aura%i", i);
-			
-		if(!CG_GetTagOrientationFromPlayerEntityLegsModel( player, tagName, &tagOrient)) continue;
-		VectorCopy( tagOrient.origin, state->convexHull[j].pos_world);
+		// Lerp all of the part's tag positions at once
+		numTags = state->numTagHandles[part];
+		if (!CG_GetTagOrientationsFromPlayerEntity( player, parts[part], state->tagHandles[part], numTags, tagOrients)) continue;
+
+		for (i = 0;i < numTags;i++){
+			VectorCopy( tagOrients[i].origin, state->convexHull[j].pos_world);
 
-		if (CG_WorldCoordToScreenCoordVec( state->convexHull[j].pos_world, state->convexHull[j].pos_screen)){
-			state->convexHull[j].is_tail = qfalse;
-			j++;
+			if (CG_WorldCoordToScreenCoordVec( state->convexHull[j].pos_world, state->convexHull[j].pos_screen)){
+				state->convexHull[j].is_tail = qfalse;
+				state->convexHull[j].id = part * MAX_AURATAGS_PER_PART + i;
+				j++;
+			}
 		}
 	}
 	// Find the aura's tail point
@@ -143,6 +151,7 @@ static void CG_Aura_GetHullPoints( centity_t *player, auraState_t *state, auraCo
 	VectorCopy( state->tailPos, state->convexHull[j].pos_world);
 	if (CG_WorldCoordToScreenCoordVec( state->convexHull[j].pos_world, state->convexHull[j].pos_screen)){
 		state->convexHull[j].is_tail = qtrue;
+		state->convexHull[j].id = MAX_AURATAGS;
 		j++;
 	}
 
@@ -155,44 +164,26 @@ static void CG_Aura_GetHullPoints( centity_t *player, auraState_t *state, auraCo
 
 
 /*
-====================
-CG_Aura_QSortAngle
-====================
-  Quicksort by ascending angles
+=======================
+CG_Aura_HullTurn
+=======================
+  Positive if a, b, c make a counter-clockwise turn on the screen.
 */
-static void CG_Aura_QSortAngle( auraTag_t *points, float* angles, int lowbound, int highbound){
-	int			low, high;
-	float		mid;
-	auraTag_t	tempPoint;
-	float		tempAngle;
-
-	low = lowbound;
-	high = highbound;
-	mid = angles[(low + high) / 2];
-
-	do{
-		while(angles[low]  < mid) low++;
-		while(angles[high] > mid) high--;
-
-		if(low <= high){
-			// swap points
-			tempPoint = points[low];
-			points[low] = points[high];
-			points[high] = tempPoint;
-
-			// swap angles
-			tempAngle = angles[low];
-			angles[low] = angles[high];
-			angles[high] = tempAngle;
-
-			low++;
-			high--;
-		}
+static float CG_Aura_HullTurn( const auraTag_t *a, const auraTag_t *b, const auraTag_t *c){
+	return (b->pos_screen[0] - a->pos_screen[0]) * (c->pos_screen[1] - a->pos_screen[1]) -
+		   (b->pos_screen[1] - a->pos_screen[1]) * (c->pos_screen[0] - a->pos_screen[0]);
+}
 
-	} while(!(low > high));
 
-	if(high > lowbound) CG_Aura_QSortAngle( points, angles, lowbound, high);
-	if(low < highbound) CG_Aura_QSortAngle( points, angles, low, highbound);	
+/*
+=======================
+CG_Aura_HullBefore
+=======================
+  Lexicographic screen order used by the monotone chain; x first, then y.
+*/
+static qboolean CG_Aura_HullBefore( const auraTag_t *a, const auraTag_t *b){
+	if(a->pos_screen[0] != b->pos_screen[0]) return a->pos_screen[0] < b->pos_screen[0];
+	return a->pos_screen[1] < b->pos_screen[1];
 }
 
 
@@ -200,112 +191,100 @@ static void CG_Aura_QSortAngle( auraTag_t *points, float* angles, int lowbound,
 ===========================
 CG_Aura_ArrangeConvexHull
 ===========================
-  Rearranges *points to contain its convex hull in the first *nr_points points.
+  Rearranges the state's points to contain their convex hull in the first
+  convexHullCount points. The hull runs counter-clockwise and ends with the
+  pivot; the point with lowest y, or highest x among those.
+
+  Uses a monotone chain. The points are first laid out in the order they were
+  sorted in last frame, so the insertion sort that follows has next to nothing
+  left to do while the player moves smoothly.
 */
-static qboolean CG_Aura_ArrangeConvexHull( auraTag_t *points, int *nr_points){
-	float		angles[MAX_AURATAGS + 1];// +1 for tail
-	int			amount, index, pivotIndex;
-	auraTag_t	pivot;
-	auraTag_t	behind, infront;
-	qboolean	rightTurn;
-	auraTag_t	vecPoint;
+static qboolean CG_Aura_ArrangeConvexHull( auraState_t *state){
+	auraTag_t	*points;
 	auraTag_t	buffer[MAX_AURATAGS + 1];
-	
+	int			byRank[MAX_AURATAGS + 1];
+	int			order[MAX_AURATAGS + 1];
+	int			hull[2 * (MAX_AURATAGS + 1)];
+	int			amount, index, i, k, lower, pivot, rank, tmp;
 
-	amount = *nr_points;	
+	points = state->convexHull;
+	amount = state->convexHullCount;
 
-	if(amount == 3) return qtrue;// Already a convex hull
-	if(amount <  3){
+	if(amount < 3){
 		return qfalse;
 	}
 
-	pivotIndex = 0;
-	// Find pivot point, which is known to be on the hull.
-	// Point with lowest y - if there are multiple, point with highest x.
-	for(index = 1;index < amount;index++){
-
-		if(points[index].pos_screen[1] < points[pivotIndex].pos_screen[1]){
-			pivotIndex = index;
-
-		} else if(points[index].pos_screen[1] == points[pivotIndex].pos_screen[1]){
-			
-			if (points[index].pos_screen[0] > points[pivotIndex].pos_screen[0]){
-				pivotIndex = index;
-			}
+	// Warm start from last frame's order; points that weren't there go last.
+	for(rank = 0;rank < amount;rank++){
+		byRank[rank] = -1;
+	}
+	k = 0;
+	for(index = 0;index < amount;index++){
+		rank = state->hullRank[points[index].id];
+		if(rank < amount && byRank[rank] < 0){
+			byRank[rank] = index;
+		} else{
+			order[amount - 1 - k++] = index;
 		}
 	}
-
-	// Put pivot into seperate variable and remove from array.
-	pivot = points[pivotIndex];
-	points[pivotIndex] = points[amount - 1];
-	amount--;
-
-	// Calculate angle to pivot for each point in the array.
-    for(index = 0;index < amount;index++){
- 
-		// point vector
-		vecPoint.pos_screen[0] = pivot.pos_screen[0] - points[index].pos_screen[0];
-		vecPoint.pos_screen[1] = pivot.pos_screen[1] - points[index].pos_screen[1];
-    
-		// reduce to a unit-vector - length 1
-		angles[index] = vecPoint.pos_screen[0] / Q_hypot(vecPoint.pos_screen[0], vecPoint.pos_screen[1]);
+	i = 0;
+	for(rank = 0;rank < amount;rank++){
+		if(byRank[rank] >= 0) order[i++] = byRank[rank];
+	}
+	// new points were stored back to front, restore their order
+	for(index = 0;index < k / 2;index++){
+		tmp = order[i + index];
+		order[i + index] = order[amount - 1 - index];
+		order[amount - 1 - index] = tmp;
 	}
 
-	// Sort the points by angle.
-	CG_Aura_QSortAngle(points, angles, 0, amount - 1);
-
-	// Step through array to remove points that are not p of the convex hull.
-	index = 1;
-
-	do{
-		 // Assign points behind and in front of current point.
-		if(index == 0){
-			rightTurn = qtrue;
-		} else{
-			behind = points[index - 1];
+	// Insertion sort, linear on an almost sorted set.
+	for(index = 1;index < amount;index++){
+		tmp = order[index];
+		for(i = index - 1;i >= 0 && CG_Aura_HullBefore( &points[tmp], &points[order[i]]);i--){
+			order[i + 1] = order[i];
+		}
+		order[i + 1] = tmp;
+	}
 
-			if(index == (amount - 1)){
-				infront = pivot;
-			} else{
-				infront = points[index + 1];
-			}
+	// Remember the order for next frame.
+	memset( state->hullRank, 0xff, sizeof(state->hullRank));
+	for(index = 0;index < amount;index++){
+		state->hullRank[points[order[index]].id] = index;
+	}
 
-			// Work out if we are making a right or left turn using vector product.
-			if(( (behind.pos_screen[0]  - points[index].pos_screen[0]) * (infront.pos_screen[1] - points[index].pos_screen[1]) -
-				   (infront.pos_screen[0] - points[index].pos_screen[0]) * (behind.pos_screen[1] - points[index].pos_screen[1])) < 0){
-				rightTurn = qtrue;
-			}else{
-				rightTurn = qfalse;
-			}
-		}
+	// Lower hull, then upper hull. Collinear points are dropped.
+	k = 0;
+	for(index = 0;index < amount;index++){
+		while(k >= 2 && CG_Aura_HullTurn( &points[hull[k - 2]], &points[hull[k - 1]], &points[order[index]]) <= 0) k--;
+		hull[k++] = order[index];
+	}
+	lower = k + 1;
+	for(index = amount - 2;index >= 0;index--){
+		while(k >= lower && CG_Aura_HullTurn( &points[hull[k - 2]], &points[hull[k - 1]], &points[order[index]]) <= 0) k--;
+		hull[k++] = order[index];
+	}
+	k--;	// the first point closes the loop
 
-		if(rightTurn){
-			// point is currently considered part of the hull
-			index++;
-		} else{
-			// point is not part of the hull
-
-			// remove point from convex hull
-			if(index == (amount - 1)){
-				amount--;
-			} else{
-				// move everything after the current value one step forward
-				memcpy( buffer, &points[index + 1], sizeof(auraTag_t) * (amount - index - 1));
-				memcpy( &points[index], buffer, sizeof(auraTag_t) * (amount - index - 1));
-				amount--;
-			}
+	if(k < 3){
+		return qfalse;
+	}
 
-			// backtrack to previous point
-			index--;
+	// Rotate the hull so it ends with the pivot.
+	pivot = 0;
+	for(index = 1;index < k;index++){
+		if(points[hull[index]].pos_screen[1] < points[hull[pivot]].pos_screen[1] ||
+		  (points[hull[index]].pos_screen[1] == points[hull[pivot]].pos_screen[1] &&
+		   points[hull[index]].pos_screen[0] > points[hull[pivot]].pos_screen[0])){
+			pivot = index;
 		}
+	}
+	for(index = 0;index < k;index++){
+		buffer[index] = points[hull[(pivot + 1 + index) % k]];
+	}
+	memcpy( points, buffer, sizeof(auraTag_t) * k);
 
-	} while(!(index == (amount - 1)));
-	
-	// add pivot back into points array
-	points[amount] = pivot;
-	amount++;
-
-	*nr_points = amount;
+	state->convexHullCount = k;
 	return qtrue;
 }
 
@@ -390,7 +369,7 @@ static qboolean CG_Aura_BuildConvexHull( centity_t *player, auraState_t *state,
 	CG_Aura_GetHullPoints( player, state, config);
 
 	// Arrange hull. Don't continue if there aren't enough points to form a hull.
-	if(!CG_Aura_ArrangeConvexHull( state->convexHull, &state->convexHullCount)){
+	if(!CG_Aura_ArrangeConvexHull( state)){
 		return qfalse;
 	}
 
@@ -416,16 +395,36 @@ static qboolean CG_Aura_BuildConvexHull( centity_t *player, auraState_t *state,
 #define AURA_FLATTEN_NORMAL		0.75f
 #define AURA_ROOTCUTOFF_FRAQ	0.80f
 #define AURA_ROOTCUTOFF_DIST	7.00f
+#define MAX_AURAPOLYS			(NR_AURASPIKES * 16)
+
+// Spikes of all auras are collected here and handed to the renderer in as few
+// calls as possible; one per run of auras sharing a shader.
+static polyVert_t	auraPolyVerts[MAX_AURAPOLYS * 4];
+static int			auraNumPolys;
+static qhandle_t	auraPolyShader;
+
+/*
+===================
+CG_FlushAuraPolys
+===================
+  Submits all buffered aura spikes. Must be called before the scene is rendered.
+*/
+void CG_FlushAuraPolys( void){
+	if(auraNumPolys){
+		trap_R_AddPolysToScene( auraPolyShader, 4, auraPolyVerts, auraNumPolys);
+	}
+	auraNumPolys = 0;
+}
 
 /*
 ===================
 CG_Aura_DrawSpike
 ===================
-  Draws the polygons for one aura spike
+  Buffers the polygon for one aura spike
 */
 static void CG_Aura_DrawSpike (vec3_t start, vec3_t end, float width, qhandle_t shader, vec4_t RGBModulate){
 	vec3_t line, offset, viewLine;
-	polyVert_t verts[4];
+	polyVert_t *verts;
 	float len;
 	int i, j;
 	
@@ -437,6 +436,13 @@ static void CG_Aura_DrawSpike (vec3_t start, vec3_t end, float width, qhandle_t
 	if (!len){
 		return;
 	}
+
+	if(auraNumPolys && (shader != auraPolyShader || auraNumPolys >= MAX_AURAPOLYS)){
+		CG_FlushAuraPolys();
+	}
+	auraPolyShader = shader;
+	verts = &auraPolyVerts[auraNumPolys * 4];
+	auraNumPolys++;
 	
 	VectorMA (end, -width, offset, verts[0].xyz);
 	verts[0].st[0] = 1;
@@ -456,8 +462,6 @@ static void CG_Aura_DrawSpike (vec3_t start, vec3_t end, float width, qhandle_t
 			verts[i].modulate[j] = 255 * RGBModulate[j];
 		}
 	}
-
-	trap_R_AddPolyToScene( shader, 4, verts);
 }
 
 
@@ -614,10 +618,7 @@ static void CG_Aura_ConvexHullRender( centity_t *player, auraState_t *state, aur
 		return;
 	}
 
-	// Clear the poly buffer
-	
-	// For each spike add it to the poly buffer
-	// FIXME: Uses old style direct adding with trap call until buffer system is built
+	// For each spike add it to the poly buffer, CG_FlushAuraPolys submits it
 	for(i = 0;i < NR_AURASPIKES;i++){
 		CG_LerpSpike( state, config, i, state->modulate);		
 	}
@@ -674,10 +675,16 @@ static void CG_Aura_AddDebris( centity_t *player, auraState_t *state, auraConfig
 	if(!config->generatesDebris){
 		return;
 	}
+
+	// Leaving the aura unmarked lets an existing debris system die off while the
+	// player is out of view. It is spawned again once the player comes back.
+	if(CG_CullEffect(CULL_AURA_DEBRIS, player->lerpOrigin, 256)){
+		return;
+	}
 	
 	// Spawn the debris system if the player has just entered PVS
 	if(!CG_FrameHist_HadAura( player->currentState.number)){
-		PSys_SpawnCachedSystem( "AuraDebris", player->lerpOrigin, NULL, player, NULL, qtrue, qfalse);
+		PSys_SpawnSystemByID( cgs.media.auraDebrisSystem, player->lerpOrigin, NULL, player, NULL, qtrue, qfalse);
 	}
 
 	CG_FrameHist_SetAura( player->currentState.number);
@@ -847,7 +854,7 @@ void CG_AuraStart( centity_t *player){
 
 			VectorNormalize2( trace.plane.normal, tempAxis[0]);
 			MakeNormalVectors( tempAxis[0], tempAxis[1], tempAxis[2]);
-			PSys_SpawnCachedSystem( "AuraSmokeBurst", groundPoint, tempAxis, NULL, NULL, qfalse, qfalse);
+			PSys_SpawnSystemByID( cgs.media.auraSmokeBurstSystem, groundPoint, tempAxis, NULL, NULL, qfalse, qfalse);
 		}
 	}
 }
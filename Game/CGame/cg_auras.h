@@ -6,6 +6,7 @@
 #define AURATAGS_TORSO	1
 #define AURATAGS_HEAD	2
 #define MAX_AURATAGS	48 // 16 * 3; 16 tags per MD3, 3 MDS; head, upper, lower
+#define MAX_AURATAGS_PER_PART	16
 
 typedef enum {
 	AURA_VOLUMESPRITE,
@@ -18,6 +19,7 @@ typedef struct auraTag_s {
 	vec3_t		normal;
 	float		length;
 	qboolean	is_tail;
+	int			id;			// which tag this is, stable across frames
 } auraTag_t;
 
 typedef struct auraConfig_s {
@@ -51,6 +53,7 @@ typedef struct auraState_s {
 	qboolean		isActive;
 	auraTag_t		convexHull[MAX_AURATAGS + 1]; // Need MAX_AURATAGS + 1 extra for the tail position
 	int				convexHullCount;
+	byte			hullRank[MAX_AURATAGS + 1];	// sort position of each tag id last frame
 	float			convexHullCircumference;
 	vec3_t			origin;
 	vec3_t			rootPos; // Root position; Where the aura 'opens up'
@@ -60,5 +63,11 @@ typedef struct auraState_s {
 	float			lightAmt;
 	int				lightDev;
 
+	// tag handles of the tag_aura# tags, resolved whenever a part's model changes
+	qhandle_t		tagModels[3];
+	int				tagsRequested[3];
+	int				tagHandles[3][MAX_AURATAGS_PER_PART];
+	int				numTagHandles[3];
+
 	auraConfig_t	configurations[8]; // 8 = max tier
 } auraState_t;
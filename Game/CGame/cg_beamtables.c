@@ -11,10 +11,23 @@
 #define TESS_DISTANCE		  20    // The distance required for one tesselation of a
 									// beam segment.
 */
+#define MAX_BEAM_TESS		  40	// Most tesselations for one segment
+#define BEAM_TESS_PIXELS	   4.0f	// Allowed screen space error at r_beamDetail 1
+#define MAX_BEAM_QUADS		 512	// Quads handed to the renderer in one go
+
+// The view independent part of a segment's tesselation.
+typedef struct {
+	vec3_t						midPos1, midPos2;	// bezier control points
+	float						curvature;			// largest second difference of the control points
+	vec3_t						center;				// bounding sphere of the control points
+	float						radius;
+} beamSegment_t;
 
 typedef struct beamTableElem_s {
 	struct beamTableElem_s		*prev, *next;
 	vec3_t						pos, tangent;
+	beamSegment_t				segment;			// from the previous waypoint to this one
+	int							segmentGeneration;
 } beamTableElem_t;
 
 typedef struct {
@@ -24,6 +37,7 @@ typedef struct {
 	qboolean			activeThisFrame;
 	qboolean			alreadyWiped;
 	int					updateTime;
+	int					generation;		// bumped with every new waypoint, invalidates cached segments
 	qhandle_t			shader;
 	char				tagName[MAX_QPATH];
 	float				width;
@@ -60,6 +74,8 @@ static void CG_WipeBeamTable( beamTable_t *beamTable ) {
 			beamTable->table[i].next = &(beamTable->table[i+1]);
 		}
 
+		beamTable->generation = 1;
+
 		beamTable->alreadyWiped = qtrue;
 	}
 	
@@ -166,6 +182,7 @@ void CG_BeamTableUpdate( centity_t *cent, float width, qhandle_t shader, char *t
 
 		// set the next update time
 		currentTable->updateTime = cg.time + BEAMTABLE_UPDATE;
+		currentTable->generation++;
 	}
 
 	// mark the table as having been active
@@ -326,66 +343,89 @@ static int CG_TessCount (const vec3_t startPos, const vec3_t endPos) {
 	return tess;
 }
 */
-static int CG_TessCount( const beamTableElem_t *startElem, const beamTableElem_t *endElem ) {
-	float	directTangentRatio;
-	float	indirectTangentRatio;
-	float	tangentRatio;
-	float   dist;
-	vec3_t	dir;
-	int		detail;
-
-	VectorSubtract( endElem->pos, startElem->pos, dir );
-	if ( (dist = VectorNormalize( dir )) == 0.0f ) {
-		//If the distance is 0, then we don't make ANY tesselations at all.
-		return 0;
+/*
+======================
+CG_BeamSegmentInfo
+======================
+  Fills in everything about a segment's tesselation that doesn't depend on the view.
+*/
+static void CG_BeamSegmentInfo( const beamTableElem_t *startElem, const beamTableElem_t *endElem, beamSegment_t *segment ) {
+	vec3_t	diff1, diff2;
+	float	len1, len2;
+	float	dist;
+	int		i;
+
+	CG_BezierMidPoints( startElem->pos, endElem->pos,
+						startElem->tangent, endElem->tangent,
+						segment->midPos1, segment->midPos2 );
+
+	// The distance between a cubic bezier and its n-segment polyline stays below
+	// 3/4 * max| P[i] - 2 P[i+1] + P[i+2] | / n^2
+	for ( i = 0; i < 3; i++ ) {
+		diff1[i] = startElem->pos[i] - 2 * segment->midPos1[i] + segment->midPos2[i];
+		diff2[i] = segment->midPos1[i] - 2 * segment->midPos2[i] + endElem->pos[i];
 	}
+	len1 = VectorLength( diff1 );
+	len2 = VectorLength( diff2 );
+	segment->curvature = len1 > len2 ? len1 : len2;
 
-	directTangentRatio = 1 - DotProduct( startElem->tangent, endElem->tangent );
-	indirectTangentRatio = 1 - DotProduct( dir, endElem->tangent );
-	// NOTE: These should produce numbers between 0 and 2. 2 When the tangents
-	//       differ 180 degrees, 0 when they do not differ.
-	
-	// Pick the biggest one
-	tangentRatio = indirectTangentRatio > directTangentRatio ? indirectTangentRatio : directTangentRatio;
+	// The curve lies within the hull of its control points
+	for ( i = 0; i < 3; i++ ) {
+		segment->center[i] = 0.25f * ( startElem->pos[i] + segment->midPos1[i] + segment->midPos2[i] + endElem->pos[i] );
+	}
+	segment->radius = Distance( segment->center, startElem->pos );
+	if ( ( dist = Distance( segment->center, segment->midPos1 ) ) > segment->radius ) segment->radius = dist;
+	if ( ( dist = Distance( segment->center, segment->midPos2 ) ) > segment->radius ) segment->radius = dist;
+	if ( ( dist = Distance( segment->center, endElem->pos ) ) > segment->radius ) segment->radius = dist;
+}
+
+/*
+==================
+CG_TessCount
+==================
+  Picks the number of tesselations that keeps the segment's projected error
+  within BEAM_TESS_PIXELS / r_beamDetail pixels.
+*/
+static int CG_TessCount( const beamSegment_t *segment ) {
+	float	depth;
+	float	pixelsPerUnit;
+	float	error;
+	int		tess;
+
+	if ( segment->radius <= 0.0f ) {
+		//If the segment has no length, then we don't make ANY tesselations at all.
+		return 0;
+	}
 
-	// Clamp the detail value
 	if ( r_beamDetail.value <= 0 ) {
-		r_beamDetail.value = 0;
-		detail = 0;
+		return 1;
 	}
 
-	if ( r_beamDetail.value >= 4 ) {
-		detail = 40;
-		if ( tangentRatio < 1 ) {
-			tangentRatio = 1;
-		}
-	} else if ( r_beamDetail.value == 3 ) {
-		detail = 30;
-		if ( tangentRatio < 0.5 ) {
-			tangentRatio = 0.5;
-		}
-	} else if ( r_beamDetail.value == 2 ) {
-		detail = 20;
-		if ( tangentRatio < 0.25 ) {
-			tangentRatio = 0.25;
-		}
-	} else if ( r_beamDetail.value == 1 ) {
-		detail = 10;
-		if ( tangentRatio < 0.1 ) {
-			tangentRatio = 0.1;
-		}
+	// Nearest possible distance of the curve to the viewer
+	depth = Distance( cg.refdef.vieworg, segment->center ) - segment->radius;
+	if ( depth < 1.0f ) {
+		depth = 1.0f;
+	}
+	pixelsPerUnit = cg.refdef.width / ( 2.0f * tan( DEG2RAD( cg.refdef.fov_x ) * 0.5f ) * depth );
+
+	// Projected error of the straight chord, in units of the allowed error
+	error = 0.75f * segment->curvature * pixelsPerUnit * r_beamDetail.value / BEAM_TESS_PIXELS;
+	if ( error <= 1.0f ) {
+		return 1;
 	}
 
-	// On small distances always use the maximum tangent ratio
-	if ( dist < 100 ) {
-		tangentRatio = 2;
+	tess = ceil( sqrt( error ) );
+	if ( tess > MAX_BEAM_TESS ) {
+		tess = MAX_BEAM_TESS;
 	}
 
-	return 1 + floor( tangentRatio * detail );
+	return tess;
 }
 
 
 
+static polyVert_t	beamVerts[MAX_BEAM_QUADS * 4];
+
 /*
 ==================
 CG_DrawBeamTable
@@ -397,11 +437,12 @@ static void CG_DrawBeamTable ( int clientNum, qboolean alternate ) {
 	beamTableElem_t		*currentElem;
 	beamTableElem_t		*prevElem;
 	beamTableElem_t		starter;
+	beamSegment_t		segment;
+	const beamSegment_t	*currentSegment;
 
 	polyVert_t			verts[4];
-	
-	vec3_t				midPos1;
-	vec3_t				midPos2;
+	polyVert_t			*quad;
+	int					numQuads;
 	
 	int					tessSize;
 	vec3_t				tessPoint;
@@ -485,30 +526,44 @@ static void CG_DrawBeamTable ( int clientNum, qboolean alternate ) {
 	prevElem = &starter;
 	CG_BezierVerts( prevElem->pos, prevElem->tangent, currentTable->width, verts );
 	CG_ShiftVerts( verts );
+	numQuads = 0;
 
 	// Start going through the waypoint table
 	currentElem = currentTable->table_activeList.prev;
 	while ( 1 ) {
 
-		// get the tesselation count for this segment
-		//tessSize = CG_TessCount( prevElem->pos, currentElem->pos );
-		tessSize = CG_TessCount( prevElem, currentElem );
+		// Segments between two waypoints only change when a new waypoint is placed;
+		// the ones ending at the player's tag or the beam head change every frame.
+		if ( prevElem != &starter && currentElem != &currentTable->table_activeList ) {
+			if ( currentElem->segmentGeneration != currentTable->generation ) {
+				CG_BeamSegmentInfo( prevElem, currentElem, &currentElem->segment );
+				currentElem->segmentGeneration = currentTable->generation;
+			}
+			currentSegment = &currentElem->segment;
+		} else {
+			CG_BeamSegmentInfo( prevElem, currentElem, &segment );
+			currentSegment = &segment;
+		}
 
-		// get the midpoints for this segment
-		CG_BezierMidPoints( prevElem->pos, currentElem->pos,
-							prevElem->tangent, currentElem->tangent,
-							midPos1, midPos2 );
+		// get the tesselation count for this segment
+		tessSize = CG_TessCount( currentSegment );
 
 		// generate the tesselations
 		for ( i = 1; i <= tessSize; i++ ) {
 			t = (float)i / (float)tessSize;
 
 			// Get the next set of vertices to add to our polygon
-			CG_BezierPoint( prevElem->pos, midPos1, midPos2, currentElem->pos, t, tessPoint, tessTangent );
+			CG_BezierPoint( prevElem->pos, currentSegment->midPos1, currentSegment->midPos2, currentElem->pos, t, tessPoint, tessTangent );
 			CG_BezierVerts( tessPoint, tessTangent, currentTable->width, verts );
 			
-			// Draw our polygon
-			trap_R_AddPolyToScene( currentTable->shader, 4, verts );
+			// Queue our polygon
+			if ( numQuads == MAX_BEAM_QUADS ) {
+				trap_R_AddPolysToScene( currentTable->shader, 4, beamVerts, numQuads );
+				numQuads = 0;
+			}
+			quad = &beamVerts[numQuads * 4];
+			memcpy( quad, verts, sizeof(verts) );
+			numQuads++;
 
 			// Shift the new vertices to the back, over the old ones, to save them.
 			CG_ShiftVerts( verts );
@@ -524,6 +579,11 @@ static void CG_DrawBeamTable ( int clientNum, qboolean alternate ) {
 		currentElem = currentElem->prev;
 	}
 
+	// Hand the whole beam to the renderer at once
+	if ( numQuads ) {
+		trap_R_AddPolysToScene( currentTable->shader, 4, beamVerts, numQuads );
+	}
+
 	// reset the activeThisFrame marker for use by the next frame.
 	currentTable->activeThisFrame = qfalse;
 }
@@ -0,0 +1,114 @@
+// cg_cull.c -- visibility tests for cgame effects, done before they spend
+// any traces or spawn anything
+
+#include "cg_local.h"
+
+typedef struct {
+	float		maxDistance;	// Farther away than this is never worth it, 0 means no limit
+	float		minPixels;		// Skip if the projected radius is smaller than this many pixels
+	float		margin;			// Added to the radius for the frustum test, so effects that
+								// stay around for a while survive the camera turning
+} cullPolicy_t;
+
+static const cullPolicy_t cg_cullPolicies[CULL_NUM_EFFECTS] = {
+	{ 0,	 0,	 512 },		// CULL_AURA_DEBRIS: lives as long as the aura, respawns once back in view
+	{ 6000,	 2,	 64 },		// CULL_DIRT
+	{ 6000,	 2,	 64 },		// CULL_SPLASH
+	{ 8000,	 1,	 32 },		// CULL_LIGHTNING
+	{ 0,	 1,	 32 }		// CULL_MELEE
+};
+
+typedef struct {
+	qboolean	valid;
+	vec3_t		origin;
+	cplane_t	frustum[4];
+	float		projScale;		// Pixels per unit of radius at unit distance
+} cullView_t;
+
+static cullView_t	cg_cullView;
+
+
+/*
+===============
+CG_Cull_SetupView
+===============
+Builds the view frustum for CG_CullEffect out of the current refdef.
+Should be called once the view has been calculated. Effects spawned by
+events before that in the next frame will test against this view.
+*/
+void CG_Cull_SetupView( void ) {
+	float	xs, xc;
+	float	ang;
+	int		i;
+
+	VectorCopy( cg.refdef.vieworg, cg_cullView.origin );
+
+	ang = DEG2RAD( cg.refdef.fov_x * 0.5f );
+	xs = sin( ang );
+	xc = cos( ang );
+
+	VectorScale( cg.refdef.viewaxis[0], xs, cg_cullView.frustum[0].normal );
+	VectorMA( cg_cullView.frustum[0].normal, xc, cg.refdef.viewaxis[1], cg_cullView.frustum[0].normal );
+
+	VectorScale( cg.refdef.viewaxis[0], xs, cg_cullView.frustum[1].normal );
+	VectorMA( cg_cullView.frustum[1].normal, -xc, cg.refdef.viewaxis[1], cg_cullView.frustum[1].normal );
+
+	ang = DEG2RAD( cg.refdef.fov_y * 0.5f );
+	xs = sin( ang );
+	xc = cos( ang );
+
+	VectorScale( cg.refdef.viewaxis[0], xs, cg_cullView.frustum[2].normal );
+	VectorMA( cg_cullView.frustum[2].normal, xc, cg.refdef.viewaxis[2], cg_cullView.frustum[2].normal );
+
+	VectorScale( cg.refdef.viewaxis[0], xs, cg_cullView.frustum[3].normal );
+	VectorMA( cg_cullView.frustum[3].normal, -xc, cg.refdef.viewaxis[2], cg_cullView.frustum[3].normal );
+
+	for ( i = 0; i < 4; i++ ) {
+		cg_cullView.frustum[i].dist = DotProduct( cg_cullView.origin, cg_cullView.frustum[i].normal );
+	}
+
+	cg_cullView.projScale = cg.refdef.height * 0.5f / ( xs / xc );
+	cg_cullView.valid = qtrue;
+}
+
+
+/*
+===============
+CG_CullEffect
+===============
+Returns qtrue if an effect of the given type with the given bounding sphere
+can't be seen, or would be too small on screen to be worth generating.
+*/
+qboolean CG_CullEffect( cullEffect_t type, const vec3_t origin, float radius ) {
+	const cullPolicy_t	*policy;
+	float				dist;
+	int					i;
+
+	if ( !cg_effectCulling.integer || !cg_cullView.valid ) {
+		return qfalse;
+	}
+
+	policy = &cg_cullPolicies[type];
+	dist = Distance( origin, cg_cullView.origin );
+
+	// always keep what the view is inside of
+	if ( dist <= radius ) {
+		return qfalse;
+	}
+
+	if ( policy->maxDistance && dist - radius > policy->maxDistance ) {
+		return qtrue;
+	}
+
+	for ( i = 0; i < 4; i++ ) {
+		if ( DotProduct( origin, cg_cullView.frustum[i].normal ) - cg_cullView.frustum[i].dist < -( radius + policy->margin ) ) {
+			return qtrue;
+		}
+	}
+
+	if ( policy->minPixels && radius * cg_cullView.projScale / dist < policy->minPixels ) {
+		return qtrue;
+	}
+
+	return qfalse;
+}
@@ -800,6 +800,21 @@ static float CG_DrawSnapshot( float y ) {
 	return y + BIGCHAR_HEIGHT + 4;
 }
 
+/*==================
+CG_DrawTraces
+==================*/
+static float CG_DrawTraces( float y ) {
+	char		*s;
+	int			w;
+
+	s = va( "traces:%i clips:%i", cg.frameTraces, cg.frameTraceClips );
+	w = CG_DrawStrlen( s ) * BIGCHAR_WIDTH;
+
+	CG_DrawBigString( 635 - w, y + 2, s, 1.0F);
+
+	return y + BIGCHAR_HEIGHT + 4;
+}
+
 /*
 ==================
 CG_DrawFPS
@@ -876,6 +891,9 @@ static void CG_DrawUpperRight( void ) {
 	if ( cg_drawFPS.integer ) {
 		y = CG_DrawFPS( y );
 	}
+	if ( cg_drawTraces.integer ) {
+		y = CG_DrawTraces( y );
+	}
 	if ( cg_drawTimer.integer ) {
 		y = CG_DrawTimer( y );
 	}
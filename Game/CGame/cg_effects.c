@@ -274,6 +274,20 @@ void CG_SpawnEffect( vec3_t org ) {
 	re->origin[2] += 16;
 }
 
+/*
+==================
+CG_EffectModelRadius
+
+Radius of a model effect scaled by size, for CG_CullEffect
+==================
+*/
+static float CG_EffectModelRadius( qhandle_t model, int size ) {
+	vec3_t	mins, maxs;
+
+	trap_R_ModelBounds( model, mins, maxs, 0 );
+	return RadiusFromBounds( mins, maxs ) * size;
+}
+
 /*
 ==================
 CG_DirtPush
@@ -290,6 +304,10 @@ void CG_DirtPush( vec3_t org, vec3_t dir, int size ) {
 		return;
 	}
 
+	if (CG_CullEffect(CULL_DIRT, org, CG_EffectModelRadius(cgs.media.dirtPushModel, size))){
+		return;
+	}
+
 	le = CG_AllocLocalEntity();
 	le->leFlags = 0;
 	le->leType = LE_ZEQSPLASH;
@@ -344,6 +362,10 @@ void CG_WaterRipple( vec3_t org, int size, qboolean single ) {
 		return;
 	}
 
+	if (CG_CullEffect(CULL_SPLASH, org, CG_EffectModelRadius(single ? cgs.media.waterRippleSingleModel : cgs.media.waterRippleModel, size))){
+		return;
+	}
+
 	le = CG_AllocLocalEntity();
 	le->leFlags = 0;
 	le->leType = LE_ZEQSPLASH;
@@ -436,6 +458,10 @@ void CG_WaterSplash( vec3_t org, int size ) {
 		return;
 	}
 
+	if (CG_CullEffect(CULL_SPLASH, org, CG_EffectModelRadius(cgs.media.waterSplashModel, size))){
+		return;
+	}
+
 	le = CG_AllocLocalEntity();
 	le->leFlags = 0;
 	le->leType = LE_ZEQSPLASH;
@@ -515,40 +541,43 @@ void CG_LightningEffect( vec3_t org, clientInfo_t *ci, int tier ) {
 	r5 = random() * 24 + 8;
 	r6 = random() * 40;
 	if (r > 58) {
-		localEntity_t	*le;
-		refEntity_t		*re;
-
-		le = CG_AllocLocalEntity();
-
-		le->leFlags = 0;
-		le->leType = LE_FADE_ALPHA;
-		le->startTime = cg.time;
-		le->endTime = cg.time + 250;
-		le->lifeRate = 1.0 / ( le->endTime - le->startTime );
-		le->radius = 16;
-		le->color[0] = le->color[1] = le->color[2] = le->color[3] = 1.0;
-
-		re = &le->refEntity;
-
-		re->reType = RT_SPRITE;
-		re->radius = le->radius;
-		re->shaderRGBA[0] = 0xff;
-		re->shaderRGBA[1] = 0xff;
-		re->shaderRGBA[2] = 0xff;
-		re->shaderRGBA[3] = 0xff;
-
-		re->customShader = ci->auraConfig[tier]->lightningShader;
-
-		AxisClear( re->axis );
-
-		VectorCopy( org, re->origin );
-
-		re->origin[0] += r1;
-		re->origin[1] += r2;
-		re->origin[2] += r3;
-		re->origin[0] -= r4;
-		re->origin[1] -= r5;
-		re->origin[2] -= r6;
+		// The crackle is heard whether or not the spark is in view
+		if (!CG_CullEffect(CULL_LIGHTNING, org, 64)) {
+			localEntity_t	*le;
+			refEntity_t		*re;
+
+			le = CG_AllocLocalEntity();
+
+			le->leFlags = 0;
+			le->leType = LE_FADE_ALPHA;
+			le->startTime = cg.time;
+			le->endTime = cg.time + 250;
+			le->lifeRate = 1.0 / ( le->endTime - le->startTime );
+			le->radius = 16;
+			le->color[0] = le->color[1] = le->color[2] = le->color[3] = 1.0;
+
+			re = &le->refEntity;
+
+			re->reType = RT_SPRITE;
+			re->radius = le->radius;
+			re->shaderRGBA[0] = 0xff;
+			re->shaderRGBA[1] = 0xff;
+			re->shaderRGBA[2] = 0xff;
+			re->shaderRGBA[3] = 0xff;
+
+			re->customShader = ci->auraConfig[tier]->lightningShader;
+
+			AxisClear( re->axis );
+
+			VectorCopy( org, re->origin );
+
+			re->origin[0] += r1;
+			re->origin[1] += r2;
+			re->origin[2] += r3;
+			re->origin[0] -= r4;
+			re->origin[1] -= r5;
+			re->origin[2] -= r6;
+		}
 
 		if ((random() * 7)< 1){
 			trap_S_StartSound( org, ENTITYNUM_NONE, CHAN_AUTO, cgs.media.bigLightningSound1 );
@@ -590,6 +619,10 @@ void CG_BigLightningEffect( vec3_t org ) {
 		return;
 	}
 
+	if (CG_CullEffect(CULL_LIGHTNING, org, 128)){
+		return;
+	}
+
 	le = CG_AllocLocalEntity();
 	le->leFlags = 0;
 	le->startTime = cg.time;
@@ -680,7 +713,7 @@ void CG_SpeedMeleeEffect( vec3_t org, int tier ) {
 	r5 = random() * 24 + 8;
 	r6 = random() * 40;
 
-	if (r > 50) {
+	if (r > 50 && !CG_CullEffect(CULL_MELEE, org, 32 << (tier < 1 ? 0 : tier > 6 ? 6 : tier - 1))) {
 		le = CG_AllocLocalEntity();
 		le->leFlags = 0;
 		le->startTime = cg.time;
@@ -752,6 +785,10 @@ void CG_PowerMeleeEffect( vec3_t org, int tier ) {
 	r5 = random() * 24 + 8;
 	r6 = random() * 40;
 
+	if (CG_CullEffect(CULL_MELEE, org, 32 << (tier < 1 ? 0 : tier > 6 ? 6 : tier - 1))){
+		return;
+	}
+
 	le = CG_AllocLocalEntity();
 	le->leFlags = 0;
 	le->startTime = cg.time;
@@ -1328,20 +1365,20 @@ void CG_MakeUserExplosion( vec3_t origin, vec3_t dir, cg_userWeapon_t *weaponGra
 		expShock->light = 0;
 	}
 
-	if ( weaponGraphics->explosionParticleSystem[0] ) {
+	if ( weaponGraphics->explosionParticleSystem ) {
 		vec3_t tempAxis[3];
 
 		VectorCopy( dir, tempAxis[0] );
 		MakeNormalVectors( tempAxis[0], tempAxis[1], tempAxis[2] );
-		PSys_SpawnCachedSystem( weaponGraphics->explosionParticleSystem, origin, tempAxis, NULL, NULL, qfalse, qfalse );
+		PSys_SpawnSystemByID( weaponGraphics->explosionParticleSystem, origin, tempAxis, NULL, NULL, qfalse, qfalse );
 	}
 
-	if ( weaponGraphics->smokeParticleSystem[0] ) {
+	if ( weaponGraphics->smokeParticleSystem ) {
 		vec3_t tempAxis[3];
 
 		VectorCopy( dir, tempAxis[0] );
 		MakeNormalVectors( tempAxis[0], tempAxis[1], tempAxis[2] );
-		PSys_SpawnCachedSystem( weaponGraphics->smokeParticleSystem, origin, tempAxis, NULL, NULL, qfalse, qfalse );
+		PSys_SpawnSystemByID( weaponGraphics->smokeParticleSystem, origin, tempAxis, NULL, NULL, qfalse, qfalse );
 	}
 }
 
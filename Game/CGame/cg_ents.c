@@ -921,11 +921,11 @@ static void CG_Missile( centity_t *cent ) {
 	// Check if we should activate a missile specific particle system
 	//if ( cent->lastPVSTime < ( cg.time - cg.frametime - 100) ) {
 	if ( !CG_FrameHist_WasInPVS( s1->number )) {
-		if ( weaponGraphics->missileParticleSystem[0] ) {
+		if ( weaponGraphics->missileParticleSystem ) {
 			vec3_t tempAxis[3];
 
 			AnglesToAxis( cent->lerpAngles, tempAxis );
-			PSys_SpawnCachedSystem( weaponGraphics->missileParticleSystem, cent->lerpOrigin, tempAxis, cent, NULL, qfalse, qfalse );
+			PSys_SpawnSystemByID( weaponGraphics->missileParticleSystem, cent->lerpOrigin, tempAxis, cent, NULL, qfalse, qfalse );
 		}
 	}
 }
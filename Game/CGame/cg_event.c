@@ -208,7 +208,7 @@ void CG_EntityEvent( centity_t *cent, vec3_t position ) {
 		break;
 	case EV_CRASH:
 		trap_S_StartSound (NULL, es->number, CHAN_AUTO, CG_CustomSound( es->number, "fall" ) );
-		PSys_SpawnCachedSystem("AuraDebris",cent->lerpOrigin,NULL,cent,NULL,qtrue,qfalse);
+		PSys_SpawnSystemByID(cgs.media.auraDebrisSystem,cent->lerpOrigin,NULL,cent,NULL,qtrue,qfalse);
 		break;
 	case EV_FOOTSTEP:
 		DEBUGNAME("EV_FOOTSTEP");
@@ -1,93 +1,134 @@
 #include "cg_local.h"
 
+// PVS and aura flags are kept as bitsets, one pair for this frame and one for
+// the last. Swapping frames flips an index instead of copying every entity.
+#define FRHIST_WORDS	( MAX_GENTITIES / 32 )
+
 typedef struct {
-	qboolean	inPVS;
-	qboolean	hasAura;
 	int			weaponState;
 	int			weapNr;
-} cg_frameHist_t;
+	int			lastWeaponState;
+	int			lastWeapNr;
+	int			generation;		// frame the current values were recorded in
+} cg_frameHistWeap_t;
+
+static unsigned int			frHist_pvs[2][FRHIST_WORDS];
+static unsigned int			frHist_aura[2][FRHIST_WORDS];
+static int					frHist_cur;
+static int					frHist_generation;
+static cg_frameHistWeap_t	frHist_weap[MAX_GENTITIES];
 
-static cg_frameHist_t	frHist_thisFrame[MAX_GENTITIES];
-static cg_frameHist_t	frHist_lastFrame[MAX_GENTITIES];
 
 
+static int CG_FrameHist_WeaponStateOf( int num ) {
+	if ( num < MAX_CLIENTS ) {
+		return cg_entities[num].currentState.weaponstate;
+	}
+	return WEAPON_READY;
+}
+
+/*
+===============
+CG_FrameHist_Record
+===============
+Entities only change their state when they are part of a snapshot, so the values
+recorded the last time an entity was seen are still valid for any frame it wasn't.
+*/
+static void CG_FrameHist_Record( int num ) {
+	cg_frameHistWeap_t *weap;
+
+	weap = &frHist_weap[num];
+	if ( weap->generation == frHist_generation ) {
+		return;
+	}
+
+	weap->lastWeaponState = weap->weaponState;
+	weap->lastWeapNr = weap->weapNr;
+	weap->weaponState = CG_FrameHist_WeaponStateOf( num );
+	weap->weapNr = cg_entities[num].currentState.weapon;
+	weap->generation = frHist_generation;
+}
 
 void CG_FrameHist_Init( void ) {
-	memset( frHist_thisFrame, 0, sizeof(frHist_thisFrame));
-	memset( frHist_lastFrame, 0, sizeof(frHist_lastFrame));
+	memset( frHist_pvs, 0, sizeof(frHist_pvs));
+	memset( frHist_aura, 0, sizeof(frHist_aura));
+	memset( frHist_weap, 0, sizeof(frHist_weap));
+	frHist_cur = 0;
+	frHist_generation = 0;
 }
 
 void CG_FrameHist_NextFrame( void ) {
 	int i;
 
-	for( i = 0 ; i < MAX_GENTITIES ; i++) {
-		frHist_lastFrame[i].inPVS = frHist_thisFrame[i].inPVS;
-		frHist_thisFrame[i].inPVS = qfalse;
-
-		frHist_lastFrame[i].hasAura = frHist_thisFrame[i].hasAura;
-		frHist_thisFrame[i].hasAura = qfalse;
-
-		
-		// NOTE: Thes last ones update automatically, so there is no 'Set' function
-		//       associated with them.
+	frHist_cur ^= 1;
+	memset( frHist_pvs[frHist_cur], 0, sizeof(frHist_pvs[0]));
+	memset( frHist_aura[frHist_cur], 0, sizeof(frHist_aura[0]));
 
-		frHist_lastFrame[i].weaponState = frHist_thisFrame[i].weaponState;
-		if ( i < MAX_CLIENTS ) {
-			frHist_thisFrame[i].weaponState = cg_entities[i].currentState.weaponstate;
-		} else {
-			frHist_thisFrame[i].weaponState = WEAPON_READY;
-		}
+	// NOTE: The weapon values update automatically, so there is no 'Set' function
+	//       associated with them. Only the entities present in the snapshot can
+	//       have changed.
+	frHist_generation++;
 
+	if ( !cg.snap ) {
+		return;
+	}
 
-		frHist_lastFrame[i].weapNr = frHist_thisFrame[i].weapNr;
-		frHist_thisFrame[i].weapNr = cg_entities[i].currentState.weapon;
+	CG_FrameHist_Record( cg.snap->ps.clientNum );
+	for ( i = 0; i < cg.snap->numEntities; i++ ) {
+		CG_FrameHist_Record( cg.snap->entities[i].number );
 	}
 }
 
 
 
 void CG_FrameHist_SetPVS( int num ) {
-	frHist_thisFrame[num].inPVS = qtrue;
+	frHist_pvs[frHist_cur][num >> 5] |= 1u << ( num & 31 );
 }
 
 qboolean CG_FrameHist_IsInPVS( int num ) {
-	return frHist_thisFrame[num].inPVS;
+	return ( frHist_pvs[frHist_cur][num >> 5] >> ( num & 31 ) ) & 1;
 }
 
 qboolean CG_FrameHist_WasInPVS( int num ) {
-	return frHist_lastFrame[num].inPVS;
+	return ( frHist_pvs[frHist_cur ^ 1][num >> 5] >> ( num & 31 ) ) & 1;
 }
 
 
 
 void CG_FrameHist_SetAura( int num ) {
-	frHist_thisFrame[num].hasAura = qtrue;
+	frHist_aura[frHist_cur][num >> 5] |= 1u << ( num & 31 );
 }
 
 qboolean CG_FrameHist_HasAura( int num ) {
-	return frHist_thisFrame[num].hasAura;
+	return ( frHist_aura[frHist_cur][num >> 5] >> ( num & 31 ) ) & 1;
 }
 
 qboolean CG_FrameHist_HadAura( int num ) {
-	return frHist_lastFrame[num].hasAura;
+	return ( frHist_aura[frHist_cur ^ 1][num >> 5] >> ( num & 31 ) ) & 1;
 }
 
 
 
 int CG_FrameHist_IsWeaponState( int num ) {
-	return frHist_thisFrame[num].weaponState;
+	return frHist_weap[num].weaponState;
 }
 
 int CG_FrameHist_WasWeaponState( int num ) {
-	return frHist_lastFrame[num].weaponState;
+	if ( frHist_weap[num].generation == frHist_generation ) {
+		return frHist_weap[num].lastWeaponState;
+	}
+	return frHist_weap[num].weaponState;
 }
 
 
 
 int CG_FrameHist_IsWeaponNr( int num ) {
-	return frHist_thisFrame[num].weapNr;
+	return frHist_weap[num].weapNr;
 }
 
 int CG_FrameHist_WasWeaponNr( int num ) {
-	return frHist_lastFrame[num].weapNr;
+	if ( frHist_weap[num].generation == frHist_generation ) {
+		return frHist_weap[num].lastWeapNr;
+	}
+	return frHist_weap[num].weapNr;
 }
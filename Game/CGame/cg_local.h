@@ -161,6 +161,15 @@ typedef struct {
 	refEntity_t		legsRef, torsoRef, headRef, cameraRef;
 } playerEntity_t;
 
+typedef enum {
+	PLAYERPART_HEAD,
+	PLAYERPART_TORSO,
+	PLAYERPART_LEGS,
+	PLAYERPART_CAMERA
+} playerPart_t;
+
+#define	MAX_PLAYER_TAGS		32	// tags fetched per part with one CG_GetTagOrientationsFromPlayerEntity call
+
 //=================================================
 
 
@@ -243,7 +252,9 @@ typedef enum {
 	LE_ZEQEXPLOSION,
 	LE_ZEQSMOKE,
 	LE_ZEQSPLASH,
-	LE_STRAIGHTBEAM_FADE
+	LE_STRAIGHTBEAM_FADE,
+
+	LE_NUM_TYPES
 } leType_t;
 
 typedef enum {
@@ -267,6 +278,7 @@ typedef enum {
 
 typedef struct localEntity_s {
 	struct localEntity_s	*prev, *next;
+	struct localEntity_s	*typePrev, *typeNext;	// list of local entities of the same leType
 	leType_t		leType;
 	int				leFlags;
 
@@ -483,6 +495,8 @@ typedef struct {
 
 #define MAX_LIGHTS_PER_MAP 1024
 #define LIGHT_INTEGRATION_BUFFER_SIZE 8	// must be a power of 2
+#define NUMVISSAMPLES 50
+#define NUMVISSLOTS (8 + NUMVISSAMPLES)	// bounding cube corners + disc samples
 typedef struct {
 	float light;
 	vec3_t origin;
@@ -499,6 +513,11 @@ typedef struct {
 	int libPos;
 	int libNumEntries;
 	lightSample_t lib[LIGHT_INTEGRATION_BUFFER_SIZE];	// lib = light integration buffer
+	// occlusion cache, see CG_ComputeVisibleLightSample
+	int visNumSlots;	// 0 = cache invalid
+	int visCursor;
+	int visPending;		// slots not re-traced since the view last moved
+	byte visSamples[NUMVISSLOTS];
 } lensFlareEntity_t;
 
 typedef enum {
@@ -562,6 +581,7 @@ typedef struct {
 // occurs, and they will have visible effects for #define STEP_TIME or whatever msec after
 
 #define MAX_PREDICTED_EVENTS	16
+#define NUM_SAVED_STATES		(CMD_BACKUP + 2)
  
 #if EARTHQUAKE_SYSTEM	// JUHOX: definitions
 typedef struct {
@@ -622,6 +642,17 @@ typedef struct {
 	qboolean	validPPS;				// clear until the first call to CG_PredictPlayerState
 	int			predictedErrorTime;
 	vec3_t		predictedError;
+	playerState_t	savedPmoveStates[NUM_SAVED_STATES];	// predicted states kept for reuse
+	int			stateHead, stateTail;
+	int			lastPredictedCommand;
+	int			lastServerTime;
+	int			predictErrors;			// number of full re-predicts, shown by cg_showmiss
+
+	// trace counters, shown by cg_drawTraces
+	int			traces;					// CG_Trace calls this frame
+	int			traceClips;				// entities clipped against this frame
+	int			frameTraces;			// totals from the last full frame
+	int			frameTraceClips;
 	int			eventSequence;
 	int			predictableEvents[MAX_PREDICTED_EVENTS];
 	float		stepChange;				// for stair up smoothing
@@ -918,6 +949,12 @@ typedef struct {
 	sfxHandle_t waterSplashLarge1;
 	sfxHandle_t waterSplashExtraLarge1;
 	sfxHandle_t waterSplashExtraLarge2;
+
+	// particle system IDs
+	int			auraDebrisSystem;
+	int			auraSmokeBurstSystem;
+	int			explosionDebrisSystems[4];		// small, normal, large, extra large
+	int			explosionDebrisLowSystems[4];
 	// END ADDING
 } cgMedia_t;
 
@@ -1065,6 +1102,7 @@ extern	vmCvar_t		cg_gibs;
 extern	vmCvar_t		cg_drawTimer;
 extern	vmCvar_t		cg_drawFPS;
 extern	vmCvar_t		cg_drawSnapshot;
+extern	vmCvar_t		cg_drawTraces;
 extern	vmCvar_t		cg_draw3dIcons;
 extern	vmCvar_t		cg_drawIcons;
 extern	vmCvar_t		cg_drawCrosshair;
@@ -1090,6 +1128,7 @@ extern	vmCvar_t		cg_errorDecay;
 extern	vmCvar_t		cg_nopredict;
 extern	vmCvar_t		cg_noPlayerAnims;
 extern	vmCvar_t		cg_showmiss;
+extern	vmCvar_t		cg_optimizePrediction;
 extern	vmCvar_t		cg_footsteps;
 extern	vmCvar_t		cg_addMarks;
 extern	vmCvar_t		cg_brassTime;
@@ -1161,6 +1200,11 @@ extern	vmCvar_t		cg_playTransformTrackToEnd;
 extern	vmCvar_t		cg_particlesQuality;
 extern	vmCvar_t		cg_particlesStop;
 extern  vmCvar_t		cg_particlesMaximum;
+extern	vmCvar_t		cg_particlesLod;
+extern	vmCvar_t		cg_particlesFrameTime;
+extern	vmCvar_t		cg_particlesCache;
+extern	vmCvar_t		cg_maxLocalEntities;
+extern	vmCvar_t		cg_effectCulling;
 extern	vmCvar_t		cg_drawBBox;
 // END ADDING
 #if MAPLENSFLARES
@@ -1168,6 +1212,8 @@ extern	vmCvar_t		cg_lensFlare;		// JUHOX
 extern	vmCvar_t		cg_mapFlare;		// JUHOX
 extern	vmCvar_t		cg_sunFlare;		// JUHOX
 extern	vmCvar_t		cg_missileFlare;	// JUHOX
+extern	vmCvar_t		cg_lensFlareRays;
+extern	vmCvar_t		cg_lensFlareTraceBudget;
 #endif
 
 extern	radar_t			cg_playerOrigins[MAX_CLIENTS];
@@ -1319,6 +1365,8 @@ qboolean CG_GetTagOrientationFromPlayerEntityCameraModel( centity_t *cent, char
 qboolean CG_GetTagOrientationFromPlayerEntityHeadModel( centity_t *cent, char *tagName, orientation_t *tagOrient );
 qboolean CG_GetTagOrientationFromPlayerEntityTorsoModel( centity_t *cent, char *tagName, orientation_t *tagOrient );
 qboolean CG_GetTagOrientationFromPlayerEntityLegsModel( centity_t *cent, char *tagName, orientation_t *tagOrient );
+qhandle_t CG_GetPlayerEntityPartModel( centity_t *cent, playerPart_t part );
+int CG_GetTagOrientationsFromPlayerEntity( centity_t *cent, playerPart_t part, const int *tagHandles, int numTags, orientation_t *tagOrients );
 void CG_SpawnLightSpeedGhost( centity_t *cent );
 
 //
@@ -1328,6 +1376,9 @@ void CG_BuildSolidList( void );
 int	CG_PointContents( const vec3_t point, int passEntityNum );
 void CG_Trace( trace_t *result, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, 
 					 int skipNumber, int mask );
+int CG_SolidEntitiesInBounds( const vec3_t mins, const vec3_t maxs, centity_t **list, int maxList );
+void CG_TraceEntityList( trace_t *result, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, 
+					 int skipNumber, int mask, centity_t **list, int numList );
 #if 1	// JUHOX: prototype for CG_SmoothTrace()
 void CG_SmoothTrace(
 	trace_t *result,
@@ -1653,6 +1704,12 @@ void		trap_R_DrawStretchPic( float x, float y, float w, float h,
 void		trap_R_ModelBounds( clipHandle_t model, vec3_t mins, vec3_t maxs, int frame );
 int			trap_R_LerpTag( orientation_t *tag, clipHandle_t mod, int startFrame, int endFrame, 
 					   float frac, const char *tagName );
+// resolve a tag name once, then lerp any number of tags of a model with one call
+// returns -1 if the model has no such tag
+int			trap_R_RegisterTag( qhandle_t mod, const char *tagName );
+// returns the number of valid tag handles, missing tags come back as identity
+int			trap_R_LerpTags( orientation_t *tags, qhandle_t mod, int startFrame, int endFrame,
+					   float frac, const int *tagHandles, int numTags );
 void		trap_R_RemapShader( const char *oldShader, const char *newShader, const char *timeOffset );
 
 // The glconfig_t will not change during the life of a cgame.
@@ -1746,6 +1803,7 @@ void CG_AuraStart( centity_t *player );
 void CG_AuraEnd( centity_t *player );
 void CG_RegisterClientAura(int clientNum,clientInfo_t *ci);
 void CG_AddAuraToScene( centity_t *player );
+void CG_FlushAuraPolys( void );
 void CG_CopyClientAura( int from, int to );
 
 //
@@ -1788,9 +1846,31 @@ qboolean CG_RegisterClientModelnameWithTiers( clientInfo_t *ci, const char *mode
 //
 void CG_InitParticleSystems( void );
 void CG_AddParticleSystems( void );
-void PSys_SpawnCachedSystem( char* systemName, vec3_t origin, vec3_t *axis,
-							 centity_t *cent, char* tagName,
-							 qboolean auraLink, qboolean weaponLink );
+void PSys_SpawnSystemByID( int systemID, vec3_t origin, vec3_t *axis,
+						   centity_t *cent, char* tagName,
+						   qboolean auraLink, qboolean weaponLink );
+
+//
+// cg_particlesystem_cache.c
+//
+int PSys_FindSystem( const char *systemName );
+int PSys_RegisterSystem( const char *systemName );
+
+//
+// cg_cull.c
+//
+typedef enum {
+	CULL_AURA_DEBRIS,
+	CULL_DIRT,
+	CULL_SPLASH,
+	CULL_LIGHTNING,
+	CULL_MELEE,
+
+	CULL_NUM_EFFECTS
+} cullEffect_t;
+
+void CG_Cull_SetupView( void );
+qboolean CG_CullEffect( cullEffect_t type, const vec3_t origin, float radius );
 
 //
 // cg_frameHist.c
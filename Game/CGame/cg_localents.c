@@ -26,10 +26,22 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "cg_local.h"
 
-#define	MAX_LOCAL_ENTITIES	8192
+#define	MAX_LOCAL_ENTITIES	16384		// cg_maxLocalEntities limits how many of these are used
+#define	MIN_LOCAL_ENTITIES	256
+#define	FRAGMENT_BATCH		256			// fragments traced against one filtered list of solid entities
+
 localEntity_t	cg_localEntities[MAX_LOCAL_ENTITIES];
-localEntity_t	cg_activeLocalEntities;		// double linked list
+localEntity_t	cg_activeLocalEntities;		// double linked list, newest first
 localEntity_t	*cg_freeLocalEntities;		// single linked list
+int				cg_numLocalEntities;
+
+// Every active local entity is also on exactly one of these lists, linked through
+// typePrev / typeNext and kept oldest first. New entities don't have their leType
+// filled in yet when they are allocated, so they wait on cg_newLocalEntities until
+// CG_AddLocalEntities sorts them onto the list of their type. The ones allocated
+// while CG_AddLocalEntities runs are sorted and run once the other lists are done.
+static localEntity_t	cg_localEntityTypes[LE_NUM_TYPES];
+static localEntity_t	cg_newLocalEntities;
 
 /*
 ===================
@@ -48,6 +60,14 @@ void	CG_InitLocalEntities( void ) {
 	for ( i = 0 ; i < MAX_LOCAL_ENTITIES - 1 ; i++ ) {
 		cg_localEntities[i].next = &cg_localEntities[i+1];
 	}
+	cg_numLocalEntities = 0;
+
+	for ( i = 0 ; i < LE_NUM_TYPES ; i++ ) {
+		cg_localEntityTypes[i].typeNext = &cg_localEntityTypes[i];
+		cg_localEntityTypes[i].typePrev = &cg_localEntityTypes[i];
+	}
+	cg_newLocalEntities.typeNext = &cg_newLocalEntities;
+	cg_newLocalEntities.typePrev = &cg_newLocalEntities;
 }
 
 
@@ -65,9 +85,15 @@ void CG_FreeLocalEntity( localEntity_t *le ) {
 	le->prev->next = le->next;
 	le->next->prev = le->prev;
 
+	// remove from the list of its type
+	le->typePrev->typeNext = le->typeNext;
+	le->typeNext->typePrev = le->typePrev;
+
 	// the free list is only singly linked
 	le->next = cg_freeLocalEntities;
 	cg_freeLocalEntities = le;
+
+	cg_numLocalEntities--;
 }
 
 /*
@@ -79,8 +105,17 @@ Will allways succeed, even if it requires freeing an old active entity
 */
 localEntity_t	*CG_AllocLocalEntity( void ) {
 	localEntity_t	*le;
+	int				limit;
 
-	if ( !cg_freeLocalEntities ) {
+	limit = cg_maxLocalEntities.integer;
+	if ( limit < MIN_LOCAL_ENTITIES ) {
+		limit = MIN_LOCAL_ENTITIES;
+	} else if ( limit > MAX_LOCAL_ENTITIES ) {
+		limit = MAX_LOCAL_ENTITIES;
+	}
+
+	// the limit may have been lowered, so free as many as needed
+	while ( !cg_freeLocalEntities || cg_numLocalEntities >= limit ) {
 		// no free entities, so free the one at the end of the chain
 		// remove the oldest active entity
 		CG_FreeLocalEntity( cg_activeLocalEntities.prev );
@@ -96,6 +131,14 @@ localEntity_t	*CG_AllocLocalEntity( void ) {
 	le->prev = &cg_activeLocalEntities;
 	cg_activeLocalEntities.next->prev = le;
 	cg_activeLocalEntities.next = le;
+
+	// wait for the leType to be filled in
+	le->typeNext = &cg_newLocalEntities;
+	le->typePrev = cg_newLocalEntities.typePrev;
+	cg_newLocalEntities.typePrev->typeNext = le;
+	cg_newLocalEntities.typePrev = le;
+
+	cg_numLocalEntities++;
 	return le;
 }
 
@@ -170,42 +213,37 @@ void CG_ReflectVelocity( localEntity_t *le, trace_t *trace ) {
 
 /*
 ================
-CG_AddFragment
+CG_AddStationaryFragment
 ================
 */
-void CG_AddFragment( localEntity_t *le ) {
-	vec3_t	newOrigin;
-	trace_t	trace;
-
-	if ( le->pos.trType == TR_STATIONARY ) {
-		// sink into the ground if near the removal time
-		int		t;
-		float	oldZ;
-		
-		t = le->endTime - cg.time;
-		if ( t < SINK_TIME ) {
-			// we must use an explicit lighting origin, otherwise the
-			// lighting would be lost as soon as the origin went
-			// into the ground
-			VectorCopy( le->refEntity.origin, le->refEntity.lightingOrigin );
-			le->refEntity.renderfx |= RF_LIGHTING_ORIGIN;
-			oldZ = le->refEntity.origin[2];
-			le->refEntity.origin[2] -= 16 * ( 1.0 - (float)t / SINK_TIME );
-			trap_R_AddRefEntityToScene( &le->refEntity );
-			le->refEntity.origin[2] = oldZ;
-		} else {
-			trap_R_AddRefEntityToScene( &le->refEntity );
-		}
-
-		return;
+static void CG_AddStationaryFragment( localEntity_t *le ) {
+	int		t;
+	float	oldZ;
+
+	// sink into the ground if near the removal time
+	t = le->endTime - cg.time;
+	if ( t < SINK_TIME ) {
+		// we must use an explicit lighting origin, otherwise the
+		// lighting would be lost as soon as the origin went
+		// into the ground
+		VectorCopy( le->refEntity.origin, le->refEntity.lightingOrigin );
+		le->refEntity.renderfx |= RF_LIGHTING_ORIGIN;
+		oldZ = le->refEntity.origin[2];
+		le->refEntity.origin[2] -= 16 * ( 1.0 - (float)t / SINK_TIME );
+		trap_R_AddRefEntityToScene( &le->refEntity );
+		le->refEntity.origin[2] = oldZ;
+	} else {
+		trap_R_AddRefEntityToScene( &le->refEntity );
 	}
+}
 
-	// calculate new position
-	BG_EvaluateTrajectory( NULL, &le->pos, cg.time, newOrigin );
-
-	// trace a line from previous position to new position
-	CG_Trace( &trace, le->refEntity.origin, NULL, NULL, newOrigin, -1, CONTENTS_SOLID );
-	if ( trace.fraction == 1.0 ) {
+/*
+================
+CG_MoveFragment
+================
+*/
+static void CG_MoveFragment( localEntity_t *le, vec3_t newOrigin, trace_t *trace ) {
+	if ( trace->fraction == 1.0 ) {
 		// still in free fall
 		VectorCopy( newOrigin, le->refEntity.origin );
 
@@ -229,23 +267,92 @@ void CG_AddFragment( localEntity_t *le ) {
 	// if it is in a nodrop zone, remove it
 	// this keeps gibs from waiting at the bottom of pits of death
 	// and floating levels
-	if ( CG_PointContents( trace.endpos, 0 ) & CONTENTS_NODROP ) {
+	if ( CG_PointContents( trace->endpos, 0 ) & CONTENTS_NODROP ) {
 		CG_FreeLocalEntity( le );
 		return;
 	}
 
 	// leave a mark
-	CG_FragmentBounceMark( le, &trace );
+	CG_FragmentBounceMark( le, trace );
 
 	// do a bouncy sound
-	CG_FragmentBounceSound( le, &trace );
+	CG_FragmentBounceSound( le, trace );
 
 	// reflect the velocity on the trace plane
-	CG_ReflectVelocity( le, &trace );
+	CG_ReflectVelocity( le, trace );
 
 	trap_R_AddRefEntityToScene( &le->refEntity );
 }
 
+/*
+================
+CG_TraceFragments
+
+All fragments of a batch are traced against the world and only
+the solid entities that touch the bounds of the whole batch.
+================
+*/
+static void CG_TraceFragments( localEntity_t **batch, vec3_t *newOrigins, int numBatch, vec3_t mins, vec3_t maxs ) {
+	static centity_t	*solids[MAX_ENTITIES_IN_SNAPSHOT];
+	int					numSolids;
+	int					i;
+	trace_t				trace;
+
+	numSolids = CG_SolidEntitiesInBounds( mins, maxs, solids, MAX_ENTITIES_IN_SNAPSHOT );
+
+	for ( i = 0 ; i < numBatch ; i++ ) {
+		// trace a line from previous position to new position
+		CG_TraceEntityList( &trace, batch[i]->refEntity.origin, NULL, NULL, newOrigins[i], -1, CONTENTS_SOLID, solids, numSolids );
+		CG_MoveFragment( batch[i], newOrigins[i], &trace );
+	}
+}
+
+/*
+================
+CG_AddFragments
+================
+*/
+static void CG_AddFragments( localEntity_t *head ) {
+	static localEntity_t	*batch[FRAGMENT_BATCH];
+	static vec3_t			newOrigins[FRAGMENT_BATCH];
+	localEntity_t			*le, *next;
+	vec3_t					mins, maxs;
+	int						numBatch;
+
+	numBatch = 0;
+	ClearBounds( mins, maxs );
+
+	for ( le = head->typeNext ; le != head ; le = next ) {
+		next = le->typeNext;
+
+		if ( cg.time >= le->endTime ) {
+			CG_FreeLocalEntity( le );
+			continue;
+		}
+
+		if ( le->pos.trType == TR_STATIONARY ) {
+			CG_AddStationaryFragment( le );
+			continue;
+		}
+
+		// calculate new position
+		BG_EvaluateTrajectory( NULL, &le->pos, cg.time, newOrigins[numBatch] );
+		AddPointToBounds( le->refEntity.origin, mins, maxs );
+		AddPointToBounds( newOrigins[numBatch], mins, maxs );
+		batch[numBatch++] = le;
+
+		if ( numBatch == FRAGMENT_BATCH ) {
+			CG_TraceFragments( batch, newOrigins, numBatch, mins, maxs );
+			numBatch = 0;
+			ClearBounds( mins, maxs );
+		}
+	}
+
+	if ( numBatch ) {
+		CG_TraceFragments( batch, newOrigins, numBatch, mins, maxs );
+	}
+}
+
 /*
 =====================================================================
 
@@ -954,82 +1061,134 @@ void CG_AddScorePlum( localEntity_t *le ) {
 
 /*
 ===================
-CG_AddLocalEntities
+CG_SortNewLocalEntities
 
+Moves the local entities allocated since the last sort
+onto the list of their type in types.
 ===================
 */
-void CG_AddLocalEntities( void ) {
+static void CG_SortNewLocalEntities( localEntity_t *types ) {
+	localEntity_t	*le, *next;
+	localEntity_t	*head;
+
+	for ( le = cg_newLocalEntities.typeNext ; le != &cg_newLocalEntities ; le = next ) {
+		next = le->typeNext;
+
+		if ( le->leType < 0 || le->leType >= LE_NUM_TYPES ) {
+			CG_Error( "Bad leType: %i", le->leType );
+		}
+
+		// append, keeping the list oldest first
+		head = &types[le->leType];
+		le->typeNext = head;
+		le->typePrev = head->typePrev;
+		head->typePrev->typeNext = le;
+		head->typePrev = le;
+	}
+
+	cg_newLocalEntities.typeNext = &cg_newLocalEntities;
+	cg_newLocalEntities.typePrev = &cg_newLocalEntities;
+}
+
+/*
+===================
+CG_AddMarkEntity
+
+Mark local entities only wait for their endTime
+===================
+*/
+static void CG_AddMarkEntity( localEntity_t *le ) {}
+
+/*
+===================
+CG_AddLocalEntityList
+
+Runs one type of local entity. Delayed types don't show
+before their startTime.
+===================
+*/
+static void CG_AddLocalEntityList( localEntity_t *head, void (*addFunc)( localEntity_t *le ), qboolean delayed ) {
 	localEntity_t	*le, *next;
 
-	// walk the list backwards, so any new local entities generated
-	// (trails, marks, etc) will be present this frame
-	le = cg_activeLocalEntities.prev;
-	for ( ; le != &cg_activeLocalEntities ; le = next ) {
+	for ( le = head->typeNext ; le != head ; le = next ) {
 		// grab next now, so if the local entity is freed we
 		// still have it
-		next = le->prev;
+		next = le->typeNext;
 
 		if ( cg.time >= le->endTime ) {
 			CG_FreeLocalEntity( le );
 			continue;
 		}
-		switch ( le->leType ) {
-		default:
-			CG_Error( "Bad leType: %i", le->leType );
-			break;
-		case LE_MARK:
-			break;
-		case LE_SPRITE_EXPLOSION:
-			CG_AddSpriteExplosion( le );
-			break;
-		case LE_EXPLOSION:
-			CG_AddExplosion( le );
-			break;
-		case LE_ZEQEXPLOSION:
-			if (cg.time >= le->startTime) {
-				CG_AddZEQExplosion( le );
-			}
-			break;
-		case LE_ZEQSMOKE:
-			if (cg.time >= le->startTime) {
-				CG_AddMoveScaleFade( le );
-			}
-			break;
-		case LE_ZEQSPLASH:
-			if (cg.time >= le->startTime) {
-				CG_AddZEQSplash( le );
+
+		if ( delayed && cg.time < le->startTime ) {
+			continue;
+		}
+
+		addFunc( le );
+	}
+}
+
+/*
+===================
+CG_AddLocalEntityTypes
+
+Runs the lists of all types, in the order they are drawn.
+===================
+*/
+static void CG_AddLocalEntityTypes( localEntity_t *types ) {
+	CG_AddLocalEntityList( &types[LE_MARK], CG_AddMarkEntity, qfalse );
+	CG_AddLocalEntityList( &types[LE_SPRITE_EXPLOSION], CG_AddSpriteExplosion, qfalse );
+	CG_AddLocalEntityList( &types[LE_EXPLOSION], CG_AddExplosion, qfalse );
+	CG_AddLocalEntityList( &types[LE_ZEQEXPLOSION], CG_AddZEQExplosion, qtrue );
+	CG_AddLocalEntityList( &types[LE_ZEQSMOKE], CG_AddMoveScaleFade, qtrue );
+	CG_AddLocalEntityList( &types[LE_ZEQSPLASH], CG_AddZEQSplash, qtrue );
+	CG_AddLocalEntityList( &types[LE_STRAIGHTBEAM_FADE], CG_AddStraightBeamFade, qfalse );
+	CG_AddFragments( &types[LE_FRAGMENT] );	// gibs and brass
+	CG_AddLocalEntityList( &types[LE_MOVE_SCALE_FADE], CG_AddMoveScaleFade, qfalse );	// water bubbles
+	CG_AddLocalEntityList( &types[LE_FADE_RGB], CG_AddFadeRGB, qfalse );				// teleporters, railtrails
+	CG_AddLocalEntityList( &types[LE_FADE_ALPHA], CG_AddFadeAlpha, qfalse );			// teleporters, railtrails
+	CG_AddLocalEntityList( &types[LE_FALL_SCALE_FADE], CG_AddFallScaleFade, qfalse );	// gib blood trails
+	CG_AddLocalEntityList( &types[LE_SCALE_FADE], CG_AddScaleFade, qfalse );			// rocket trails
+	CG_AddLocalEntityList( &types[LE_SCALE_FADE_RGB], CG_AddScaleFadeRGB, qfalse );		// rocket trails
+	CG_AddLocalEntityList( &types[LE_SCOREPLUM], CG_AddScorePlum, qfalse );
+	CG_AddLocalEntityList( &types[LE_FADE_NO], CG_AddFadeNo, qfalse );				// teleporters, railtrails
+}
+
+/*
+===================
+CG_AddLocalEntities
+
+Any new local entities generated while the lists are run (trails,
+marks, etc) are run in a batch of their own afterwards, so they are
+present this frame.
+===================
+*/
+void CG_AddLocalEntities( void ) {
+	static localEntity_t	batch[LE_NUM_TYPES];
+	localEntity_t			*head;
+	int						i;
+
+	CG_SortNewLocalEntities( cg_localEntityTypes );
+	CG_AddLocalEntityTypes( cg_localEntityTypes );
+
+	while ( cg_newLocalEntities.typeNext != &cg_newLocalEntities ) {
+		for ( i = 0 ; i < LE_NUM_TYPES ; i++ ) {
+			batch[i].typeNext = &batch[i];
+			batch[i].typePrev = &batch[i];
+		}
+		CG_SortNewLocalEntities( batch );
+		CG_AddLocalEntityTypes( batch );
+
+		// append what is left of the batch to the lists of its types
+		for ( i = 0 ; i < LE_NUM_TYPES ; i++ ) {
+			if ( batch[i].typeNext == &batch[i] ) {
+				continue;
 			}
-			break;
-		case LE_STRAIGHTBEAM_FADE:
-			CG_AddStraightBeamFade( le );
-			break;
-		case LE_FRAGMENT:			// gibs and brass
-			CG_AddFragment( le );
-			break;
-		case LE_MOVE_SCALE_FADE:		// water bubbles
-			CG_AddMoveScaleFade( le );
-			break;
-		case LE_FADE_RGB:				// teleporters, railtrails
-			CG_AddFadeRGB( le );
-			break;
-		case LE_FADE_ALPHA:				// teleporters, railtrails
-			CG_AddFadeAlpha( le );
-			break;
-		case LE_FALL_SCALE_FADE: // gib blood trails
-			CG_AddFallScaleFade( le );
-			break;
-		case LE_SCALE_FADE:		// rocket trails
-			CG_AddScaleFade( le );
-			break;
-		case LE_SCALE_FADE_RGB:		// rocket trails
-			CG_AddScaleFadeRGB( le );
-			break;
-		case LE_SCOREPLUM:
-			CG_AddScorePlum( le );
-			break;
-		case LE_FADE_NO:				// teleporters, railtrails
-			CG_AddFadeNo( le );
-			break;
+			head = &cg_localEntityTypes[i];
+			batch[i].typeNext->typePrev = head->typePrev;
+			head->typePrev->typeNext = batch[i].typeNext;
+			batch[i].typePrev->typeNext = head;
+			head->typePrev = batch[i].typePrev;
 		}
 	}
 }
@@ -89,6 +89,7 @@ vmCvar_t	cg_gibs;
 vmCvar_t	cg_drawTimer;
 vmCvar_t	cg_drawFPS;
 vmCvar_t	cg_drawSnapshot;
+vmCvar_t	cg_drawTraces;
 vmCvar_t	cg_draw3dIcons;
 vmCvar_t	cg_drawIcons;
 vmCvar_t	cg_drawCrosshair;
@@ -111,6 +112,7 @@ vmCvar_t	cg_errorDecay;
 vmCvar_t	cg_nopredict;
 vmCvar_t	cg_noPlayerAnims;
 vmCvar_t	cg_showmiss;
+vmCvar_t	cg_optimizePrediction;
 vmCvar_t	cg_footsteps;
 vmCvar_t	cg_addMarks;
 vmCvar_t	cg_brassTime;
@@ -184,6 +186,11 @@ vmCvar_t	cg_particlesQuality;
 vmCvar_t	cg_particlesType;
 vmCvar_t	cg_particlesStop;
 vmCvar_t	cg_particlesMaximum;
+vmCvar_t	cg_particlesLod;
+vmCvar_t	cg_particlesFrameTime;
+vmCvar_t	cg_particlesCache;
+vmCvar_t	cg_maxLocalEntities;
+vmCvar_t	cg_effectCulling;
 vmCvar_t	cg_drawBBox;
 //END ADDING
 #if MAPLENSFLARES
@@ -191,6 +198,8 @@ vmCvar_t	cg_lensFlare;		// JUHOX
 vmCvar_t	cg_mapFlare;		// JUHOX
 vmCvar_t	cg_sunFlare;		// JUHOX
 vmCvar_t	cg_missileFlare;	// JUHOX
+vmCvar_t	cg_lensFlareRays;
+vmCvar_t	cg_lensFlareTraceBudget;
 #endif
 
 typedef struct {
@@ -215,6 +224,7 @@ static cvarTable_t cvarTable[] = {
 	{ &cg_drawTimer, "cg_drawTimer", "0", CVAR_ARCHIVE  },
 	{ &cg_drawFPS, "cg_drawFPS", "0", CVAR_ARCHIVE  },
 	{ &cg_drawSnapshot, "cg_drawSnapshot", "0", CVAR_ARCHIVE  },
+	{ &cg_drawTraces, "cg_drawTraces", "0", CVAR_ARCHIVE  },
 	{ &cg_draw3dIcons, "cg_draw3dIcons", "1", CVAR_ARCHIVE  },
 	{ &cg_advancedFlight, "cg_advancedFlight", "0", CVAR_USERINFO |CVAR_ARCHIVE  },
 	{ &cg_drawIcons, "cg_drawIcons", "1", CVAR_ARCHIVE  },
@@ -245,6 +255,7 @@ static cvarTable_t cvarTable[] = {
 	{ &cg_nopredict, "cg_nopredict", "0", 0 },
 	{ &cg_noPlayerAnims, "cg_noplayeranims", "0", CVAR_CHEAT },
 	{ &cg_showmiss, "cg_showmiss", "0", 0 },
+	{ &cg_optimizePrediction, "cg_optimizePrediction", "1", 0 },
 	{ &cg_footsteps, "cg_footsteps", "1", CVAR_CHEAT },
 	{ &cg_tracerChance, "cg_tracerchance", "0.4", CVAR_CHEAT },
 	{ &cg_tracerWidth, "cg_tracerwidth", "1", CVAR_CHEAT },
@@ -274,6 +285,8 @@ static cvarTable_t cvarTable[] = {
 	{ &cg_mapFlare, "cg_mapFlare", "2", CVAR_ARCHIVE},		// JUHOX
 	{ &cg_sunFlare, "cg_sunFlare", "2", CVAR_ARCHIVE},		// JUHOX
 	{ &cg_missileFlare, "cg_missileFlare", "1", CVAR_ARCHIVE},	// JUHOX
+	{ &cg_lensFlareRays, "cg_lensFlareRays", "16", CVAR_ARCHIVE},
+	{ &cg_lensFlareTraceBudget, "cg_lensFlareTraceBudget", "256", CVAR_ARCHIVE},
 #endif
 	{ &cg_drawFriend, "cg_drawFriend", "1", CVAR_ARCHIVE },
 	{ &cg_teamChatsOnly, "cg_teamChatsOnly", "0", CVAR_ARCHIVE },
@@ -313,6 +326,11 @@ static cvarTable_t cvarTable[] = {
 	{ &cg_particlesQuality, "cg_particlesQuality", "1", CVAR_ARCHIVE},
 	{ &cg_particlesStop, "cg_particlesStop", "0", CVAR_ARCHIVE},
 	{ &cg_particlesMaximum, "cg_particlesMaximum", "1024", CVAR_ARCHIVE},
+	{ &cg_particlesLod, "cg_particlesLod", "1", CVAR_ARCHIVE},
+	{ &cg_particlesFrameTime, "cg_particlesFrameTime", "25", CVAR_ARCHIVE},
+	{ &cg_particlesCache, "cg_particlesCache", "1", CVAR_ARCHIVE},
+	{ &cg_maxLocalEntities, "cg_maxLocalEntities", "8192", CVAR_ARCHIVE},
+	{ &cg_effectCulling, "cg_effectCulling", "1", CVAR_ARCHIVE},
 	{ &cg_drawBBox, "cg_drawBBox", "0", CVAR_CHEAT }
 	// END ADDING
 //	{ &cg_pmove_fixed, "cg_pmove_fixed", "0", CVAR_USERINFO | CVAR_ARCHIVE }
@@ -1307,6 +1325,9 @@ static void CG_RegisterGraphics( void ) {
 		"interface/fonts/numbers/9",
 		"interface/fonts/numbers/-",
 	};
+	static char		*debrisSizes[4] = {
+		"Small", "Normal", "Large", "ExtraLarge"
+	};
 
 	// clear any references to old media
 	memset( &cg.refdef, 0, sizeof( cg.refdef ) );
@@ -1398,6 +1419,15 @@ static void CG_RegisterGraphics( void ) {
 		}
 		cgs.gameModels[i] = trap_R_RegisterModel( modelName );
 	}
+
+	// particle systems spawned by name from code
+	cgs.media.auraDebrisSystem = PSys_RegisterSystem( "AuraDebris" );
+	cgs.media.auraSmokeBurstSystem = PSys_RegisterSystem( "AuraSmokeBurst" );
+	for ( i = 0 ; i < 4 ; i++ ) {
+		cgs.media.explosionDebrisSystems[i] = PSys_RegisterSystem( va( "%sExplosionDebris", debrisSizes[i] ) );
+		cgs.media.explosionDebrisLowSystems[i] = PSys_RegisterSystem( va( "%sExplosionDebrisLow", debrisSizes[i] ) );
+	}
+
 	CG_ClearParticles ();
 }
 
@@ -1542,6 +1572,9 @@ void CG_Init( int serverMessageNum, int serverCommandSequence, int clientNum ) {
 
 	CG_RegisterSounds();
 
+	// particle systems are interned while registering graphics and clients
+	CG_InitParticleSystems();
+
 	CG_LoadingString( "graphics" );
 
 	CG_RegisterGraphics();
@@ -1557,7 +1590,6 @@ void CG_Init( int serverMessageNum, int serverCommandSequence, int clientNum ) {
 	// ADDING FOR ZEQ2
 	CG_FrameHist_Init();
 	CG_InitTrails();
-	CG_InitParticleSystems();
 	CG_InitBeamTables();
 	CG_InitRadarBlips();
 	// END ADDING
@@ -8,6 +8,10 @@
 #define MAX_ITERATIONS		10 // NOTE -RiO; Will this be enough?
 #define MIN_BOUNCE_DELTA	 8
 
+#define PSYS_PRIORITY_DIST	 384	// Emitters closer to the view than this are never scaled down by the budget
+#define PSYS_BUDGET_MIN		0.1f	// Lowest emission scale the frame time budget can drop to
+#define PSYS_BUDGET_FILL	0.75f	// Fraction of the particle pool after which emission starts to taper off
+
 // Linked list storage for the systems, particles, forces and constraints.
 static PSys_System_t			PSys_Systems[MAX_PARTICLESYSTEMS];
 static PSys_System_t			PSys_Systems_inuse;
@@ -31,6 +35,10 @@ static PSys_Constraint_t		*PSys_Constraints_free;
 
 static float					PSys_LastTimeStep;
 
+static int						PSys_NumParticles;	// Particles currently in use
+static float					PSys_FrameScale;	// Emission scale driven by frame time, smoothed over frames
+static float					PSys_BudgetScale;	// Emission scale applied to low priority emitters this frame
+
 /*
 -------------------------------
 
@@ -118,6 +126,9 @@ void CG_InitParticleSystems( void ) {
 	PSys_InitCache();
 
 	PSys_LastTimeStep = 1;
+	PSys_NumParticles = 0;
+	PSys_FrameScale = 1;
+	PSys_BudgetScale = 1;
 }
 
 
@@ -146,13 +157,27 @@ static void PSys_FreeParticle( PSys_Particle_t *particle ) {
 	// the free list is only singly linked
 	particle->next = PSys_Particles_free;
 	PSys_Particles_free = particle;
+
+	PSys_NumParticles--;
 }
 
 
-static PSys_Particle_t *PSys_SpawnParticle( PSys_System_t *system ) {
+/*
+========================
+PSys_SpawnParticle
+========================
+  Returns NULL when the pool is exhausted and evict is not set,
+  so low priority effects can't push out particles that are
+  already on screen.
+*/
+static PSys_Particle_t *PSys_SpawnParticle( PSys_System_t *system, qboolean evict ) {
 	PSys_Particle_t	*particle;
 
 	if ( !PSys_Particles_free ) {
+		if ( !evict ) {
+			return NULL;
+		}
+
 		// No free entities, so free the one at the end of the chain,
 		// removing the oldest active entity.
 		PSys_FreeParticle( PSys_Particles_inuse.prev );
@@ -175,6 +200,8 @@ static PSys_Particle_t *PSys_SpawnParticle( PSys_System_t *system ) {
 	system->particles.next_local->prev_local = particle;
 	system->particles.next_local = particle;
 
+	PSys_NumParticles++;
+
 	return particle;
 }
 
@@ -508,6 +535,64 @@ static void PSys_UpdateForces( PSys_System_t *system ) {
 	}
 }
 
+/*
+========================
+PSys_EmitterAmount
+========================
+  Returns the number of particles an emitter should spawn this
+  session. The system's lod levels are picked by its projected
+  size on screen, and emitters that don't belong to the local
+  player and aren't close to the view are further scaled by the
+  global budget. Fractions carry over to the next session so
+  the scaled rate stays smooth.
+*/
+static int PSys_EmitterAmount( PSys_System_t *system, PSys_Emitter_t *emitter, vec3_t origin, qboolean *priority ) {
+	PSys_SystemTemplate_t	*cache;
+	float					dist, projected, bestSize;
+	float					scale, amount;
+	int						i, count;
+
+	dist = Distance( origin, cg.refdef.vieworg );
+	scale = 1.0f;
+
+	cache = system->cache;
+	if ( cg_particlesLod.integer && cache && cache->numLods && cache->lodRadius > 0 ) {
+		if ( dist < 1.0f ) {
+			dist = 1.0f;
+		}
+		projected = cache->lodRadius * cg.refdef.height * 0.5f / ( dist * tan( DEG2RAD( cg.refdef.fov_y * 0.5f )));
+
+		// Use the smallest level the projected size still falls under
+		bestSize = -1;
+		for ( i = 0; i < cache->numLods; i++ ) {
+			if ( projected < cache->lodSize[i] && ( bestSize < 0 || cache->lodSize[i] < bestSize )) {
+				bestSize = cache->lodSize[i];
+				scale = cache->lodScale[i];
+			}
+		}
+	}
+
+	*priority = ( dist < PSYS_PRIORITY_DIST );
+	if ( emitter->orientation.entity && cg.snap &&
+		 emitter->orientation.entity->currentState.number == cg.snap->ps.clientNum ) {
+		*priority = qtrue;
+	}
+
+	if ( !*priority ) {
+		scale *= PSys_BudgetScale;
+	}
+
+	if ( scale >= 1.0f ) {
+		return emitter->amount;
+	}
+
+	amount = emitter->amount * scale + emitter->amountFrac;
+	count = (int)amount;
+	emitter->amountFrac = amount - count;
+
+	return count;
+}
+
 static void PSys_UpdateEmitters( PSys_System_t *system ) {
 	PSys_Emitter_t	*emitter, *next;
 
@@ -589,10 +674,16 @@ static void PSys_UpdateEmitters( PSys_System_t *system ) {
 			PSys_Particle_t *particle;
 			vec3_t	jitVec, sphereVec;
 			vec3_t	tempAxis[3];
-			int		i, templateIndex;
+			int		i, templateIndex, amount;
+			qboolean	priority;
+
+			amount = PSys_EmitterAmount( system, emitter, root.origin, &priority );
 
-			for ( i = 0; i < emitter->amount; i++ ) {
-				particle = PSys_SpawnParticle( system );
+			for ( i = 0; i < amount; i++ ) {
+				particle = PSys_SpawnParticle( system, priority );
+				if ( !particle ) {
+					break;
+				}
 
 				// Set starting point based on emitter type
 				VectorSet( jitVec,
@@ -1361,7 +1452,46 @@ static void PSys_RenderSystems( void ) {
 	}
 }
 
+/*
+========================
+PSys_UpdateBudget
+========================
+  Derives this frame's emission scale for low priority emitters.
+  The frame time part backs off in proportion to how far the frame
+  went over cg_particlesFrameTime and recovers slowly, and the pool
+  part tapers emission off as the particle count nears
+  cg_particlesMaximum.
+*/
+static void PSys_UpdateBudget( void ) {
+	float	target, fill, poolScale;
+	int		maximum;
+
+	target = cg_particlesFrameTime.value;
+	if ( target > 0 && cg.frametime > target ) {
+		PSys_FrameScale -= 0.1f * ( cg.frametime - target ) / target;
+	} else {
+		PSys_FrameScale += 0.02f;
+	}
+	if ( PSys_FrameScale < PSYS_BUDGET_MIN ) PSys_FrameScale = PSYS_BUDGET_MIN;
+	if ( PSys_FrameScale > 1 ) PSys_FrameScale = 1;
+
+	maximum = cg_particlesMaximum.integer;
+	if ( maximum < 1 || maximum > MAX_PARTICLES ) {
+		maximum = MAX_PARTICLES;
+	}
+
+	fill = (float)PSys_NumParticles / maximum;
+	poolScale = 1;
+	if ( fill > PSYS_BUDGET_FILL ) {
+		poolScale = ( 1 - fill ) / ( 1 - PSYS_BUDGET_FILL );
+		if ( poolScale < 0 ) poolScale = 0;
+	}
+
+	PSys_BudgetScale = PSys_FrameScale < poolScale ? PSys_FrameScale : poolScale;
+}
+
 void CG_AddParticleSystems( void ) {
+	PSys_UpdateBudget();
 	PSys_UpdateSystems();
 	PSys_RenderSystems();
 }
@@ -1369,7 +1499,7 @@ void CG_AddParticleSystems( void ) {
 
 /*
 ========================
-PSys_SpawnCachedSystem
+PSys_SpawnSystemByID
 ========================
   Spawns a particle system from a cached script.
   if link auto is specified, then link state is determined by
@@ -1381,9 +1511,9 @@ PSys_SpawnCachedSystem
   It dictates whether or not the life of emitters and forces
   should be bound to the state of the entity's aura.
 */
-void PSys_SpawnCachedSystem( char* systemName, vec3_t origin, vec3_t *axis,
-							 centity_t *cent, char* tagName,
-							 qboolean auraLink, qboolean weaponLink ) {
+void PSys_SpawnSystemByID( int systemID, vec3_t origin, vec3_t *axis,
+						   centity_t *cent, char* tagName,
+						   qboolean auraLink, qboolean weaponLink ) {
 	PSys_SystemTemplate_t*	cache;
 	PSys_System_t			*system;
 	PSys_Force_t			*force;
@@ -1391,15 +1521,14 @@ void PSys_SpawnCachedSystem( char* systemName, vec3_t origin, vec3_t *axis,
 	PSys_Emitter_t			*emitter;
 	int						i;
 
-	// Load from cache. Abort system's spawn if element not in cache
-	cache = PSys_LoadSystemFromCache( systemName );
+	cache = PSys_GetSystemTemplate( systemID );
 	if ( !cache ) {
-		CG_Printf( S_COLOR_YELLOW "WARNING: '%s': can not find particle system\n", systemName );
 		return;
 	}
 
 	// Spawn the system and set its parameters
 	system = PSys_SpawnSystem();
+		system->cache = cache;
 		VectorCopy( origin, system->rootPos );
 		if ( axis ) {
 			AxisCopy( axis, system->rootAxis );
@@ -1419,12 +1548,8 @@ void PSys_SpawnCachedSystem( char* systemName, vec3_t origin, vec3_t *axis,
 		case MEM_EMITTER:
 			emitter = PSys_SpawnEmitter( system );
 
-			// IMPORTANT: This will copy all data on the emitter from the cache memory,
-			//            excluding the linked list connections. Those must NEVER be included!!
-			//
-			//            This is provided the rules in cg_particlesystem.h regarding the
-			//            PSys_Emitter_t structure have not been broken!
-			memcpy( &(emitter->type), &(cache->members[i].data.emitter.type), sizeof(PSys_Emitter_t) - 4 * sizeof(PSys_Emitter_t*) - sizeof(PSys_System_t*));
+			// Copy all template data on the emitter, leaving the linked list connections intact.
+			memcpy( &(emitter->type), &(cache->members[i].data.emitter.type), sizeof(PSys_Emitter_t) - PSYS_OFS( PSys_Emitter_t, type ));
 			
 			// Set spawn-time properties
 			emitter->startTime = cg.time;
@@ -1458,12 +1583,8 @@ void PSys_SpawnCachedSystem( char* systemName, vec3_t origin, vec3_t *axis,
 		case MEM_FORCE:
 			force = PSys_SpawnForce( system );
 
-			// IMPORTANT: This will copy all data on the force from the cache memory,
-			//            excluding the linked list connections. Those must NEVER be included!!
-			//
-			//            This is provided the rules in cg_particlesystem.h regarding the
-			//            PSys_Force_t structure have not been broken!
-			memcpy( &(force->type), &(cache->members[i].data.force.type), sizeof(PSys_Force_t) - 4 * sizeof(PSys_Force_t*));
+			// Copy all template data on the force, leaving the linked list connections intact.
+			memcpy( &(force->type), &(cache->members[i].data.force.type), sizeof(PSys_Force_t) - PSYS_OFS( PSys_Force_t, type ));
 			
 			// Handle the various link states accordingly
 			if ( force->orientation.autoLink ) {
@@ -1483,14 +1604,10 @@ void PSys_SpawnCachedSystem( char* systemName, vec3_t origin, vec3_t *axis,
 			break;
 		
 		case MEM_CONSTRAINT:
-
-			// IMPORTANT: This will copy all data on the constraint from the cache memory,
-			//            excluding the linked list connections. Those must NEVER be included!!
-			//
-			//            This is provided the rules in cg_particlesystem.h regarding the
-			//            PSys_Constraint_t structure have not been broken!
 			constraint = PSys_SpawnConstraint( system );
-			memcpy( &(constraint->type), &(cache->members[i].data.constraint.type), sizeof(PSys_Constraint_t) - 4 * sizeof(PSys_Constraint_t*));
+
+			// Copy all template data on the constraint, leaving the linked list connections intact.
+			memcpy( &(constraint->type), &(cache->members[i].data.constraint.type), sizeof(PSys_Constraint_t) - PSYS_OFS( PSys_Constraint_t, type ));
 			break;
 		
 		default:
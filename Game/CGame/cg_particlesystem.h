@@ -10,6 +10,11 @@
 #define MAX_CONSTRAINTS			   256
 #define MAX_PARTICLE_TEMPLATES	     3
 #define MAX_PARTICLESYSTEM_MEMBERS   8
+#define MAX_PARTICLESYSTEM_LODS		 4
+
+// Byte offset of a field, used to copy everything from a member's type field
+// onwards out of the cache in one block.
+#define PSYS_OFS( type, field )		((size_t)&(((type *)0)->field))
 
 typedef enum {
 	CTYPE_DISTANCE_MAX,
@@ -120,15 +125,14 @@ typedef struct PSys_Orientation_s {
 } PSys_Orientation_t;
 
 typedef struct PSys_Emitter_s {
-	// IMPORTANT: Nothing else should go between these five pointers and the type field,
-	//            or a memory error will occur within the loading from cache code.
+	// IMPORTANT: Runtime links only. These must all come before the type field,
+	//            as they are never copied from the cache.
 	struct PSys_System_s	*parent;	// Emitters need to know their parent so they can kill any
 										// particles that are rayOrigin-ed to them!
 	struct PSys_Emitter_s	*prev, *next;
 	struct PSys_Emitter_s	*prev_local, *next_local;
 	
-	// IMPORTANT: type -MUST- be the next field, or a memory copy error
-	//            will occur within the loading from cache code
+	// Template data, from type up to the end of the structure
 	PSys_EmitterType_t		type;
 	PSys_Orientation_t		orientation;
 
@@ -149,16 +153,17 @@ typedef struct PSys_Emitter_s {
 	PSys_ParticleTemplate_t	particleTemplates[MAX_PARTICLE_TEMPLATES];
 	int						nrTemplates;
 
+	float					amountFrac;	// Fraction of a particle carried over from scaled down spawn sessions
+
 } PSys_Emitter_t;
 
 typedef struct PSys_Force_s {
-	// IMPORTANT: Nothing else should go between these four pointers and the type field,
-	//            or a memory error will occur within the loading from cache code.
+	// IMPORTANT: Runtime links only. These must all come before the type field,
+	//            as they are never copied from the cache.
 	struct PSys_Force_s		*prev, *next;
 	struct PSys_Force_s		*prev_local, *next_local; // Same, but local within the system
 
-	// IMPORTANT: type -MUST- be the next field, or a memory copy error
-	//            will occur within the loading from cache code
+	// Template data, from type up to the end of the structure
 	PSys_ForceType_t		type;
 	PSys_Orientation_t		orientation;
 	
@@ -172,13 +177,12 @@ typedef struct PSys_Force_s {
 } PSys_Force_t;
 
 typedef struct PSys_Constraint_s {
-	// IMPORTANT: Nothing else should go between these four pointers and the type field,
-	//            or a memory error will occur within the loading from cache code.
+	// IMPORTANT: Runtime links only. These must all come before the type field,
+	//            as they are never copied from the cache.
 	struct PSys_Constraint_s	*prev, *next;
 	struct PSys_Constraint_s	*prev_local, *next_local; // Same, but local within the system
 
-	// IMPORTANT: type -MUST- be the next field, or a memory copy error
-	//            will occur within the loading from cache code	
+	// Template data, from type up to the end of the structure
 	PSys_ConstraintType_t	type;
 	float					value;	
 } PSys_Constraint_t;
@@ -232,6 +236,8 @@ typedef struct PSys_System_s {
 	vec3_t		gravity;
 	vec3_t		rootPos;
 	vec3_t		rootAxis[3];
+
+	struct PSys_SystemTemplate_s	*cache;			// Template the system was spawned from
 } PSys_System_t;
 
 typedef enum {
@@ -255,6 +261,13 @@ typedef struct PSys_SystemTemplate_s {
 	char					name[MAX_QPATH];
 	float					gravity;
 	PSys_MemberTemplate_t	members[MAX_PARTICLESYSTEM_MEMBERS];
+
+	// Level of detail. Each level scales the emitted amounts once the system,
+	// lodRadius units in size, projects smaller than lodSize pixels on screen.
+	float					lodRadius;
+	int						numLods;
+	float					lodSize[MAX_PARTICLESYSTEM_LODS];
+	float					lodScale[MAX_PARTICLESYSTEM_LODS];
 } PSys_SystemTemplate_t;
 
 static void PSys_AccumulateSystem( PSys_System_t *system );
@@ -271,4 +284,4 @@ static qboolean PSys_ApplyConstraint( PSys_System_t *system, PSys_Constraint_t *
 	static qboolean PSys_ApplyPlaneConstraint( PSys_System_t *system, float value );
 
 void PSys_InitCache( void );
-PSys_SystemTemplate_t* PSys_LoadSystemFromCache( char *systemName );
+PSys_SystemTemplate_t* PSys_GetSystemTemplate( int systemID );
@@ -7,9 +7,146 @@
 
 #define MAX_CACHED_SYSTEMS	1024	// A maximum of 1024 different particle systems can be kept in cache.
 #define MAX_PSYS_FILELEN	32000	// slightly below 32k, which is the maximum size of a local variable in VMs
+#define PSYS_HASH_SIZE		2048	// Must be a power of two, and comfortably larger than MAX_CACHED_SYSTEMS
+#define MAX_PSYS_MEDIA		512		// Distinct shaders and models referenced by particle templates
+
+#define PSYS_CACHE_FILE		"effects/psys.cache"
+#define PSYS_CACHE_IDENT	(('C'<<24)+('S'<<16)+('Y'<<8)+'P')
+#define PSYS_CACHE_VERSION	2
 
 static PSys_SystemTemplate_t	PSys_Cache[MAX_CACHED_SYSTEMS];
 static int						PSys_CurCacheSize;
+static int						PSys_CacheHash[PSYS_HASH_SIZE];	// system ID ( cache index + 1 ), 0 = empty
+
+// Handles are only valid for the session that registered them, so the cache
+// file keeps the names of all media next to the handles used in its templates.
+typedef struct {
+	char		name[MAX_QPATH];
+	qboolean	isModel;
+	qhandle_t	handle;
+} PSys_Media_t;
+
+static PSys_Media_t				PSys_Media[MAX_PSYS_MEDIA];
+static int						PSys_NumMedia;
+static qboolean					PSys_MediaOverflow;	// Some handles couldn't be recorded, so don't write a cache file
+
+typedef struct {
+	int			ident;
+	int			version;
+	int			templateSize;	// Catches layout changes, and VM / native builds sharing one file
+	int			checksum;		// Of the script file names and contents the cache was built from
+	int			numSystems;
+	int			numMedia;
+} PSys_CacheHeader_t;
+
+
+/*
+========================
+PSys_HashName
+========================
+  Case insensitive, as system names are compared with Q_stricmp.
+*/
+static int PSys_HashName( const char *name ) {
+	int hash;
+
+	hash = 0;
+	while ( *name ) {
+		hash = hash * 31 + tolower( *name );
+		name++;
+	}
+
+	return hash & ( PSYS_HASH_SIZE - 1 );
+}
+
+
+/*
+========================
+PSys_FindSystem
+========================
+  Interns a particle system name. Returns the ID to spawn the system
+  by, or 0 if no such system is cached.
+*/
+int PSys_FindSystem( const char *systemName ) {
+	int hash;
+
+	if ( !systemName || !*systemName ) {
+		return 0;
+	}
+
+	hash = PSys_HashName( systemName );
+	while ( PSys_CacheHash[hash] ) {
+		if ( !Q_stricmp( PSys_Cache[PSys_CacheHash[hash] - 1].name, systemName )) {
+			return PSys_CacheHash[hash];
+		}
+		hash = ( hash + 1 ) & ( PSYS_HASH_SIZE - 1 );
+	}
+
+	return 0;
+}
+
+
+/*
+========================
+PSys_RegisterSystem
+========================
+  Interns a particle system name when the media that uses it is
+  registered, so a missing system is reported once instead of on
+  every spawn.
+*/
+int PSys_RegisterSystem( const char *systemName ) {
+	int systemID;
+
+	if ( !systemName || !*systemName ) {
+		return 0;
+	}
+
+	systemID = PSys_FindSystem( systemName );
+	if ( !systemID ) {
+		CG_Printf( S_COLOR_YELLOW "WARNING: '%s': can not find particle system\n", systemName );
+	}
+
+	return systemID;
+}
+
+
+static void PSys_HashSystem( int index ) {
+	int hash;
+
+	hash = PSys_HashName( PSys_Cache[index].name );
+	while ( PSys_CacheHash[hash] ) {
+		hash = ( hash + 1 ) & ( PSYS_HASH_SIZE - 1 );
+	}
+	PSys_CacheHash[hash] = index + 1;
+}
+
+
+static qhandle_t PSys_RegisterMedia( const char *name, qboolean isModel ) {
+	qhandle_t	handle;
+	int			i;
+
+	for ( i = 0; i < PSys_NumMedia; i++ ) {
+		if ( PSys_Media[i].isModel == isModel && !Q_stricmp( PSys_Media[i].name, name )) {
+			return PSys_Media[i].handle;
+		}
+	}
+
+	if ( isModel ) {
+		handle = trap_R_RegisterModel( name );
+	} else {
+		handle = trap_R_RegisterShader( name );
+	}
+
+	if ( handle && PSys_NumMedia == MAX_PSYS_MEDIA ) {
+		PSys_MediaOverflow = qtrue;
+	} else if ( handle ) {
+		Q_strncpyz( PSys_Media[PSys_NumMedia].name, name, MAX_QPATH );
+		PSys_Media[PSys_NumMedia].isModel = isModel;
+		PSys_Media[PSys_NumMedia].handle = handle;
+		PSys_NumMedia++;
+	}
+
+	return handle;
+}
 
 
 static qboolean PSys_ParseVector( char **text_pp, int x, float *m, qboolean normalized ) {
@@ -90,7 +227,7 @@ static qboolean PSys_ParseParticleTemplate( char **text_pp, PSys_ParticleTemplat
 				return qfalse;
 			}
 
-			if ( !(cachePtcl->shader = trap_R_RegisterShader( token ))) {
+			if ( !(cachePtcl->shader = PSys_RegisterMedia( token, qfalse ))) {
 				CG_Printf( S_COLOR_YELLOW "WARNING: '%s': could not register\n", token );
 			}
 			
@@ -102,7 +239,7 @@ static qboolean PSys_ParseParticleTemplate( char **text_pp, PSys_ParticleTemplat
 				return qfalse;
 			}
 
-			if ( !(cachePtcl->model = trap_R_RegisterModel( token ))) {
+			if ( !(cachePtcl->model = PSys_RegisterMedia( token, qtrue ))) {
 				CG_Printf( S_COLOR_YELLOW "WARNING:'%s': could not register\n", token );
 			}
 
@@ -887,6 +1024,67 @@ static qboolean PSys_ParseSystem( char **text_pp, PSys_SystemTemplate_t *cacheSy
 				CG_Printf( S_COLOR_YELLOW "WARNING: negative float not allowed, clamped to 0\n" );
 				cacheSys->gravity = 0;
 			}
+
+		} else if ( !Q_stricmp( token, "lodRadius" )) {
+			if ( memberType != MEM_NONE ) {
+				CG_Printf( S_COLOR_YELLOW "WARNING: empty member declaration\n" );
+				memberType = MEM_NONE;
+			}
+
+			token = COM_Parse( text_pp );
+
+			if ( !token[0] ) {
+				CG_Printf( S_COLOR_RED "ERROR: unexpected end of file\n" );
+				break;
+			}
+
+			if ( (cacheSys->lodRadius = atof(token)) < 0 ) {
+				CG_Printf( S_COLOR_YELLOW "WARNING: negative float not allowed, clamped to 0\n" );
+				cacheSys->lodRadius = 0;
+			}
+
+		} else if ( !Q_stricmp( token, "lod" )) {
+			if ( memberType != MEM_NONE ) {
+				CG_Printf( S_COLOR_YELLOW "WARNING: empty member declaration\n" );
+				memberType = MEM_NONE;
+			}
+
+			if ( cacheSys->numLods == MAX_PARTICLESYSTEM_LODS ) {
+				CG_Printf( S_COLOR_RED "ERROR: maximum number of lod levels (%i) reached\n", MAX_PARTICLESYSTEM_LODS );
+				return qfalse;
+			}
+
+			// lod <projected size in pixels> <emission scale>
+			token = COM_Parse( text_pp );
+
+			if ( !token[0] ) {
+				CG_Printf( S_COLOR_RED "ERROR: unexpected end of file\n" );
+				break;
+			}
+
+			if ( (cacheSys->lodSize[cacheSys->numLods] = atof(token)) < 0 ) {
+				CG_Printf( S_COLOR_YELLOW "WARNING: negative float not allowed, clamped to 0\n" );
+				cacheSys->lodSize[cacheSys->numLods] = 0;
+			}
+
+			token = COM_Parse( text_pp );
+
+			if ( !token[0] ) {
+				CG_Printf( S_COLOR_RED "ERROR: unexpected end of file\n" );
+				break;
+			}
+
+			cacheSys->lodScale[cacheSys->numLods] = atof(token);
+			if ( cacheSys->lodScale[cacheSys->numLods] < 0 || cacheSys->lodScale[cacheSys->numLods] > 1 ) {
+				CG_Printf( S_COLOR_YELLOW "WARNING: float between 0 and 1 required, clamped\n" );
+				if ( cacheSys->lodScale[cacheSys->numLods] < 0 ) {
+					cacheSys->lodScale[cacheSys->numLods] = 0;
+				} else {
+					cacheSys->lodScale[cacheSys->numLods] = 1;
+				}
+			}
+
+			cacheSys->numLods++;
 			
 		} else if ( !Q_stricmp( token, "{" )) {
 
@@ -1023,7 +1221,6 @@ static void PSys_ParseFile( char *filename, int *num ) {
 			break;
 
 		} else if (!Q_stricmp( token, "{" )) {
-			int i;
 
 			// Check if system is named
 			if ( !isNamed ) {
@@ -1032,11 +1229,9 @@ static void PSys_ParseFile( char *filename, int *num ) {
 			}
 
 			// Check for a name clash
-			for ( i = 0; i < *num; i++ ) {
-				if ( !Q_stricmp( sysName, PSys_Cache[i].name )) {
-					CG_Printf( S_COLOR_RED "ERROR: previous particle system named '%s' exists\n", sysName );
-					return;
-				}
+			if ( PSys_FindSystem( sysName )) {
+				CG_Printf( S_COLOR_RED "ERROR: previous particle system named '%s' exists\n", sysName );
+				return;
 			}
 
 			Q_strncpyz( PSys_Cache[*num].name, sysName, MAX_QPATH );
@@ -1052,6 +1247,8 @@ static void PSys_ParseFile( char *filename, int *num ) {
 				return;
 			}
 
+			PSys_HashSystem( *num );
+
 			// Prepare for a new system name
 			isNamed = qfalse;
 			(*num)++;
@@ -1091,86 +1288,215 @@ static void PSys_ParseFile( char *filename, int *num ) {
 }
 
 
-PSys_SystemTemplate_t* PSys_LoadSystemFromCache( char *systemName ) {
-	int low, high, mid;
+PSys_SystemTemplate_t* PSys_GetSystemTemplate( int systemID ) {
+	if ( systemID < 1 || systemID > PSys_CurCacheSize ) {
+		return NULL;
+	}
 
-	// No string
-	if ( !systemName ) return NULL;
+	return &PSys_Cache[systemID - 1];
+}
 
-	// Empty string
-	if ( !*systemName ) return NULL;
 
-	// Zero systems cached
-	if ( !PSys_CurCacheSize ) {
-		return NULL;
+/*
+========================
+PSys_RemapMedia
+========================
+  Swaps a handle from the session the cache file was built in for
+  the handle of the same media in this session.
+*/
+static qhandle_t PSys_RemapMedia( qhandle_t oldHandle, qboolean isModel, qhandle_t *newHandles ) {
+	int i;
+
+	if ( !oldHandle ) {
+		return 0;
 	}
 
-	// Binary search the cache
-	low = 0;
-	high = PSys_CurCacheSize;
-	while ( low + 1 != high ) {
-		mid = ( low + high ) / 2;
-		if ( Q_stricmp( PSys_Cache[mid].name, systemName ) < 1  ) low  = mid;
-		if ( Q_stricmp( PSys_Cache[mid].name, systemName ) == 1 ) high = mid;
-		// if ( PSys_Cache[mid].name <= systemName ) low  = mid;
-		// if ( PSys_Cache[mid].name >  systemName ) high = mid;
+	for ( i = 0; i < PSys_NumMedia; i++ ) {
+		if ( PSys_Media[i].isModel == isModel && PSys_Media[i].handle == oldHandle ) {
+			return newHandles[i];
+		}
 	}
-	if ( Q_stricmp( PSys_Cache[low].name, systemName )) return NULL;
-	// if ( PSys_Cache[low].name != systemName ) return NULL;
 
-	// Found the system we were looking for
-	return &PSys_Cache[low];
+	return 0;
 }
 
 
-void PSys_QSortCache( int lowbound, int highbound ) {
-	int						low, high;
-	PSys_SystemTemplate_t	mid, tempElem;
+/*
+========================
+PSys_ReadCacheFile
+========================
+  Loads the precompiled templates, provided the file was written by this
+  version of the code from the same set of scripts.
+*/
+static qboolean PSys_ReadCacheFile( int checksum ) {
+	fileHandle_t			file;
+	int						len;
+	PSys_CacheHeader_t		header;
+	qhandle_t				newHandles[MAX_PSYS_MEDIA];
+	PSys_ParticleTemplate_t	*ptcl;
+	int						i, j, k;
+
+	len = trap_FS_FOpenFile( PSYS_CACHE_FILE, &file, FS_READ );
+	if ( !file ) {
+		return qfalse;
+	}
+
+	if ( len < sizeof( header )) {
+		trap_FS_FCloseFile( file );
+		return qfalse;
+	}
+
+	trap_FS_Read( &header, sizeof( header ), file );
+	if ( header.ident != PSYS_CACHE_IDENT || header.version != PSYS_CACHE_VERSION ||
+		 header.templateSize != sizeof( PSys_SystemTemplate_t ) || header.checksum != checksum ||
+		 header.numSystems < 0 || header.numSystems > MAX_CACHED_SYSTEMS ||
+		 header.numMedia < 0 || header.numMedia > MAX_PSYS_MEDIA ||
+		 len != sizeof( header ) + header.numSystems * sizeof( PSys_SystemTemplate_t ) + header.numMedia * sizeof( PSys_Media_t )) {
+		trap_FS_FCloseFile( file );
+		return qfalse;
+	}
 
-	low = lowbound;
-	high = highbound;
-	mid = PSys_Cache[(low + high) / 2];
+	trap_FS_Read( PSys_Cache, header.numSystems * sizeof( PSys_SystemTemplate_t ), file );
+	trap_FS_Read( PSys_Media, header.numMedia * sizeof( PSys_Media_t ), file );
+	trap_FS_FCloseFile( file );
 
-	do {
-		while ( Q_stricmp( PSys_Cache[low].name, mid.name ) == -1 ) low++;
-		while ( Q_stricmp( PSys_Cache[high].name, mid.name ) == 1 ) high--;
-		//while ( PSys_Cache[low].name  < mid.name ) low++;
-		//while ( PSys_Cache[high].name > mid.name ) high--;
+	PSys_CurCacheSize = header.numSystems;
+	PSys_NumMedia = header.numMedia;
 
-		if ( low <= high ) {
-			// swap elements
-			tempElem = PSys_Cache[low];
-			PSys_Cache[low] = PSys_Cache[high];
-			PSys_Cache[high] = tempElem;
+	// Register the media again and patch the templates with the new handles
+	for ( i = 0; i < PSys_NumMedia; i++ ) {
+		PSys_Media[i].name[MAX_QPATH - 1] = 0;
+		if ( PSys_Media[i].isModel ) {
+			newHandles[i] = trap_R_RegisterModel( PSys_Media[i].name );
+		} else {
+			newHandles[i] = trap_R_RegisterShader( PSys_Media[i].name );
+		}
+	}
+
+	for ( i = 0; i < PSys_CurCacheSize; i++ ) {
+		PSys_Cache[i].name[MAX_QPATH - 1] = 0;
+
+		for ( j = 0; j < MAX_PARTICLESYSTEM_MEMBERS; j++ ) {
+			if ( PSys_Cache[i].members[j].type != MEM_EMITTER ) {
+				continue;
+			}
 
-			low++;
-			high--;
+			for ( k = 0; k < PSys_Cache[i].members[j].data.emitter.nrTemplates; k++ ) {
+				ptcl = &PSys_Cache[i].members[j].data.emitter.particleTemplates[k];
+				ptcl->shader = PSys_RemapMedia( ptcl->shader, qfalse, newHandles );
+				ptcl->model = PSys_RemapMedia( ptcl->model, qtrue, newHandles );
+			}
 		}
 
-	} while ( !(low > high));
+		PSys_HashSystem( i );
+	}
+
+	for ( i = 0; i < PSys_NumMedia; i++ ) {
+		PSys_Media[i].handle = newHandles[i];
+	}
+
+	return qtrue;
+}
+
+
+static void PSys_WriteCacheFile( int checksum ) {
+	fileHandle_t		file;
+	PSys_CacheHeader_t	header;
+
+	trap_FS_FOpenFile( PSYS_CACHE_FILE, &file, FS_WRITE );
+	if ( !file ) {
+		return;
+	}
+
+	header.ident = PSYS_CACHE_IDENT;
+	header.version = PSYS_CACHE_VERSION;
+	header.templateSize = sizeof( PSys_SystemTemplate_t );
+	header.checksum = checksum;
+	header.numSystems = PSys_CurCacheSize;
+	header.numMedia = PSys_NumMedia;
+
+	trap_FS_Write( &header, sizeof( header ), file );
+	trap_FS_Write( PSys_Cache, PSys_CurCacheSize * sizeof( PSys_SystemTemplate_t ), file );
+	trap_FS_Write( PSys_Media, PSys_NumMedia * sizeof( PSys_Media_t ), file );
+	trap_FS_FCloseFile( file );
+}
+
+
+/*
+=============
+PSys_ChecksumFile
+
+Adds the contents of a script file to the checksum, so an edit
+that keeps the file length still invalidates the cache.
+=============
+*/
+static int PSys_ChecksumFile( const char *filename, int checksum ) {
+	fileHandle_t	file;
+	int				len, chunk;
+	int				i;
+	byte			buf[1024];
+
+	len = trap_FS_FOpenFile( filename, &file, FS_READ );
+	checksum = checksum * 31 + len;
+	if ( !file ) {
+		return checksum;
+	}
+
+	while ( len > 0 ) {
+		chunk = len > sizeof( buf ) ? sizeof( buf ) : len;
+		trap_FS_Read( buf, chunk, file );
+		for ( i = 0; i < chunk; i++ ) {
+			checksum = checksum * 31 + buf[i];
+		}
+		len -= chunk;
+	}
+	trap_FS_FCloseFile( file );
 
-	if ( high > lowbound ) PSys_QSortCache( lowbound, high );
-	if ( low < highbound ) PSys_QSortCache( low, highbound );	
+	return checksum;
 }
 
 
 void PSys_InitCache( void ) {
-	int			numdirs;
-	char		filename[128];
-	char		dirlist[1024];
-	char*		dirptr;
-	int			i;
-	int			dirlen;
+	int				numdirs;
+	char			filename[128];
+	char			dirlist[1024];
+	char*			dirptr;
+	int				i, j;
+	int				dirlen;
+	int				checksum;
 
 	// Feedback start of loading particle systems
 	CG_Printf( "\nInitializing Particle Systems\n" );
 
 	// Clear the cache
 	memset(PSys_Cache, 0, sizeof(PSys_Cache));
+	memset(PSys_CacheHash, 0, sizeof(PSys_CacheHash));
 	PSys_CurCacheSize = 0;
+	PSys_NumMedia = 0;
+	PSys_MediaOverflow = qfalse;
 	
-	// Parse all files fitting the /effects/*.psys pattern
+	// Checksum the names and contents of all files fitting the /effects/*.psys pattern,
+	// to tell whether the precompiled cache is still up to date.
 	numdirs = trap_FS_GetFileList("effects", ".psys", dirlist, 1024 );
+	checksum = numdirs;
+	dirptr  = dirlist;
+	for ( i = 0; i < numdirs; i++, dirptr += dirlen+1 ) {
+		dirlen = strlen(dirptr);
+		for ( j = 0; j < dirlen; j++ ) {
+			checksum = checksum * 31 + tolower( dirptr[j] );
+		}
+
+		strcpy(filename, "effects/");
+		strcat(filename, dirptr);
+		checksum = PSys_ChecksumFile( filename, checksum );
+	}
+
+	if ( cg_particlesCache.integer && PSys_ReadCacheFile( checksum )) {
+		CG_Printf( "%i Particle Systems loaded from %s\n\n", PSys_CurCacheSize, PSYS_CACHE_FILE );
+		return;
+	}
+
+	// Parse all the script files
 	dirptr  = dirlist;
 	for ( i = 0; i < numdirs; i++, dirptr += dirlen+1 ) {
 		dirlen = strlen(dirptr);
@@ -1180,10 +1506,8 @@ void PSys_InitCache( void ) {
 		PSys_ParseFile(filename, &PSys_CurCacheSize );
 	}
 
-	// Quicksort loaded systems to retrieve them more efficiently with a binary search
-	// NOTE: Must not give a negative 2nd parameter, or will read out of bounds!
-	if ( PSys_CurCacheSize > 1 ) {
-		PSys_QSortCache( 0, PSys_CurCacheSize - 1 );
+	if ( cg_particlesCache.integer && !PSys_MediaOverflow ) {
+		PSys_WriteCacheFile( checksum );
 	}
 
 	CG_Printf( "%i Particle Systems Initialized\n\n", PSys_CurCacheSize );
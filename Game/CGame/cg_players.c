@@ -1685,7 +1685,7 @@ Draw a mark at the water surface
 */
 void CG_PlayerSplash( centity_t *cent, int scale ) {
 	vec3_t			start, end;
-	vec3_t			origin;
+	vec3_t			origin, center;
 	trace_t			trace;
 	polyVert_t		verts[4];
 	entityState_t	*s1;
@@ -1725,6 +1725,13 @@ void CG_PlayerSplash( centity_t *cent, int scale ) {
 		end[2] -= 24;
 	}
 
+	// Test the whole stretch the splash can appear on before tracing it
+	VectorAdd( start, end, center );
+	VectorScale( center, 0.5f, center );
+	if(CG_CullEffect(CULL_SPLASH, center, (start[2] - end[2]) * 0.5f + 64)){
+		return;
+	}
+
 	// trace down to find the surface
 	trap_CM_BoxTrace( &trace, start, end, NULL, NULL, 0, ( CONTENTS_WATER | CONTENTS_SLIME | CONTENTS_LAVA ) );
 
@@ -1818,7 +1825,7 @@ CG_PlayerDirtPush
 ===============
 */
 void CG_PlayerDirtPush( centity_t *cent, int scale, qboolean once ) {
-	vec3_t			start, end;
+	vec3_t			start, end, center;
 	trace_t			trace;
 	playerState_t	*ps;
 	ps = &cg.snap->ps;
@@ -1844,6 +1851,13 @@ void CG_PlayerDirtPush( centity_t *cent, int scale, qboolean once ) {
 		end[2] -= 512;
 	}
 
+	// Test the whole stretch the dust can land on before tracing it
+	VectorAdd( start, end, center );
+	VectorScale( center, 0.5f, center );
+	if(CG_CullEffect(CULL_DIRT, center, (start[2] - end[2]) * 0.5f + scale * 8)){
+		return;
+	}
+
 	CG_Trace( &trace, cent->currentState.pos.trBase, NULL, NULL, end, cent->currentState.number, MASK_PLAYERSOLID );
 
 	if (trace.fraction == 1.0f){
@@ -2479,6 +2493,113 @@ qboolean CG_GetTagOrientationFromPlayerEntity( centity_t *cent, char *tagName, o
 
 }
 
+/*
+===============
+CG_GetPlayerEntityPart
+
+Finds the refEntity and lerpFrame of one part of a player's model, using the same
+checks as the CG_GetTagOrientationFromPlayerEntity*Model functions.
+===============
+*/
+static qboolean CG_GetPlayerEntityPart( centity_t *cent, playerPart_t part, refEntity_t **ref, lerpFrame_t **lf ) {
+	int				clientNum;
+	playerEntity_t	*pe;
+
+	if ( cent->currentState.eType != ET_PLAYER ) {
+		return qfalse;
+	}
+
+	clientNum = cent->currentState.clientNum;
+	if ( clientNum < 0 || clientNum >= MAX_CLIENTS ) {
+		CG_Error( "Bad clientNum on player entity" );
+	}
+
+	if ( !cgs.clientinfo[clientNum].infoValid ) {
+		return qfalse;
+	}
+
+	pe = &playerInfoDuplicate[clientNum];
+
+	switch ( part ) {
+	case PLAYERPART_HEAD:
+		*ref = &pe->headRef;
+		*lf = &pe->head;
+		break;
+	case PLAYERPART_TORSO:
+		*ref = &pe->torsoRef;
+		*lf = &pe->torso;
+		break;
+	case PLAYERPART_LEGS:
+		*ref = &pe->legsRef;
+		*lf = &pe->legs;
+		break;
+	case PLAYERPART_CAMERA:
+		*ref = &pe->cameraRef;
+		*lf = &pe->camera;
+		break;
+	default:
+		return qfalse;
+	}
+
+	return qtrue;
+}
+
+/*
+===============
+CG_GetPlayerEntityPartModel
+
+Returns the model currently used for a part of the player, so tag names can be
+resolved with trap_R_RegisterTag whenever it changes. Returns 0 if there is none.
+===============
+*/
+qhandle_t CG_GetPlayerEntityPartModel( centity_t *cent, playerPart_t part ) {
+	refEntity_t		*ref;
+	lerpFrame_t		*lf;
+
+	if ( !CG_GetPlayerEntityPart( cent, part, &ref, &lf ) ) {
+		return 0;
+	}
+
+	return ref->hModel;
+}
+
+/*
+===============
+CG_GetTagOrientationsFromPlayerEntity
+
+Batched version of the CG_GetTagOrientationFromPlayerEntity*Model functions. Takes
+tag handles from trap_R_RegisterTag for the part's current model and fetches all of
+them with one trap call. Returns the number of tags that were found.
+===============
+*/
+int CG_GetTagOrientationsFromPlayerEntity( centity_t *cent, playerPart_t part, const int *tagHandles, int numTags, orientation_t *tagOrients ) {
+	int				i, j, found;
+	orientation_t	lerped[MAX_PLAYER_TAGS];
+	refEntity_t		*ref;
+	lerpFrame_t		*lf;
+
+	if ( numTags <= 0 || !CG_GetPlayerEntityPart( cent, part, &ref, &lf ) ) {
+		return 0;
+	}
+
+	if ( numTags > MAX_PLAYER_TAGS ) {
+		numTags = MAX_PLAYER_TAGS;
+	}
+
+	found = trap_R_LerpTags( lerped, ref->hModel, lf->oldFrame, lf->frame, 1.0 - lf->backlerp, tagHandles, numTags );
+
+	for ( i = 0 ; i < numTags ; i++ ) {
+		VectorCopy( ref->origin, tagOrients[i].origin );
+		for ( j = 0 ; j < 3 ; j++ ) {
+			VectorMA( tagOrients[i].origin, lerped[i].origin[j], ref->axis[j], tagOrients[i].origin );
+		}
+
+		MatrixMultiply( lerped[i].axis, ref->axis, tagOrients[i].axis );
+	}
+
+	return found;
+}
+
 
 //=====================================================================
 
@@ -34,6 +34,163 @@ static	centity_t	*cg_solidEntities[MAX_ENTITIES_IN_SNAPSHOT];
 static	int			cg_numTriggerEntities;
 static	centity_t	*cg_triggerEntities[MAX_ENTITIES_IN_SNAPSHOT];
 
+// broadphase over cg_solidEntities, rebuilt with it.  Box entities that stay
+// within known bounds for the whole snapshot are sorted along x, everything
+// else (brush models, extrapolated entities) is always clipped against.
+typedef struct {
+	vec3_t		mins, maxs;
+	int			index;			// into cg_solidEntities
+} solidBounds_t;
+
+static	int			cg_numSolidSorted;
+static	solidBounds_t	cg_solidSorted[MAX_ENTITIES_IN_SNAPSHOT];
+static	float		cg_solidSortedWidth;	// largest maxs[0] - mins[0]
+static	int			cg_numSolidAlways;
+static	int			cg_solidAlways[MAX_ENTITIES_IN_SNAPSHOT];
+
+/*
+====================
+CG_SolidEntityBounds
+
+Finds bounds that hold the entity's lerpOrigin until the next snapshot
+transition.  Returns qfalse if the entity can move anywhere before then.
+====================
+*/
+static qboolean CG_SolidEntityBounds( centity_t *cent, vec3_t mins, vec3_t maxs ) {
+	entityState_t	*ent;
+	int				trType;
+	int				x, zd, zu;
+	vec3_t			origin;
+
+	ent = &cent->currentState;
+	if ( ent->solid == SOLID_BMODEL ) {
+		return qfalse;
+	}
+
+	trType = ent->pos.trType;
+	if ( !cg_smoothClients.integer && ent->number < MAX_CLIENTS ) {
+		trType = TR_INTERPOLATE;
+	}
+
+	VectorCopy( cent->lerpOrigin, mins );
+	VectorCopy( cent->lerpOrigin, maxs );
+	if ( cent->interpolate && cg.nextSnap &&
+		( trType == TR_INTERPOLATE || ( trType == TR_LINEAR_STOP && ent->number < MAX_CLIENTS ) ) ) {
+		// lerped between the two snapshot positions
+		BG_EvaluateTrajectory( ent, &ent->pos, cg.snap->serverTime, origin );
+		AddPointToBounds( origin, mins, maxs );
+		BG_EvaluateTrajectory( &cent->nextState, &cent->nextState.pos, cg.nextSnap->serverTime, origin );
+		AddPointToBounds( origin, mins, maxs );
+	} else if ( trType == TR_STATIONARY || trType == TR_INTERPOLATE ) {
+		// only a mover underneath can carry it
+		if ( ent->groundEntityNum > 0 && ent->groundEntityNum < ENTITYNUM_MAX_NORMAL &&
+			cg_entities[ ent->groundEntityNum ].currentState.eType == ET_MOVER ) {
+			return qfalse;
+		}
+		AddPointToBounds( ent->pos.trBase, mins, maxs );
+	} else {
+		return qfalse;
+	}
+
+	x = (ent->solid & 255);
+	zd = ((ent->solid>>8) & 255);
+	zu = ((ent->solid>>16) & 255) - 32;
+	mins[0] -= x;
+	mins[1] -= x;
+	mins[2] -= zd;
+	maxs[0] += x;
+	maxs[1] += x;
+	maxs[2] += zu;
+	return qtrue;
+}
+
+/*
+====================
+CG_BuildSolidBroadphase
+====================
+*/
+static void CG_BuildSolidBroadphase( void ) {
+	int				i, j;
+	solidBounds_t	b;
+
+	cg_numSolidSorted = 0;
+	cg_numSolidAlways = 0;
+	cg_solidSortedWidth = 0;
+
+	for ( i = 0 ; i < cg_numSolidEntities ; i++ ) {
+		if ( !CG_SolidEntityBounds( cg_solidEntities[ i ], b.mins, b.maxs ) ) {
+			cg_solidAlways[cg_numSolidAlways++] = i;
+			continue;
+		}
+		b.index = i;
+		if ( b.maxs[0] - b.mins[0] > cg_solidSortedWidth ) {
+			cg_solidSortedWidth = b.maxs[0] - b.mins[0];
+		}
+
+		// insertion sort on mins[0]
+		for ( j = cg_numSolidSorted ; j > 0 && cg_solidSorted[j-1].mins[0] > b.mins[0] ; j-- ) {
+			cg_solidSorted[j] = cg_solidSorted[j-1];
+		}
+		cg_solidSorted[j] = b;
+		cg_numSolidSorted++;
+	}
+}
+
+/*
+====================
+CG_SolidEntitiesForMove
+
+Fills list with the solid entities that a move through the given
+swept bounds may touch, in cg_solidEntities order so ties between
+equal fractions resolve the same way as a full scan.
+====================
+*/
+static int CG_SolidEntitiesForMove( const vec3_t mins, const vec3_t maxs, centity_t **list ) {
+	int				indexes[MAX_ENTITIES_IN_SNAPSHOT];
+	int				num, lo, hi, mid, i, j, index;
+	float			first;
+	solidBounds_t	*b;
+
+	memcpy( indexes, cg_solidAlways, cg_numSolidAlways * sizeof( int ) );
+	num = cg_numSolidAlways;
+
+	// first entry whose mins[0] can still reach the move
+	first = mins[0] - cg_solidSortedWidth - 1;
+	lo = 0;
+	hi = cg_numSolidSorted;
+	while ( lo < hi ) {
+		mid = ( lo + hi ) / 2;
+		if ( cg_solidSorted[mid].mins[0] < first ) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	for ( i = lo ; i < cg_numSolidSorted ; i++ ) {
+		b = &cg_solidSorted[i];
+		if ( b->mins[0] > maxs[0] + 1 ) {
+			break;
+		}
+		if ( b->maxs[0] < mins[0] - 1 ||
+			 b->mins[1] > maxs[1] + 1 || b->maxs[1] < mins[1] - 1 ||
+			 b->mins[2] > maxs[2] + 1 || b->maxs[2] < mins[2] - 1 ) {
+			continue;
+		}
+		index = b->index;
+		for ( j = num ; j > 0 && indexes[j-1] > index ; j-- ) {
+			indexes[j] = indexes[j-1];
+		}
+		indexes[j] = index;
+		num++;
+	}
+
+	for ( i = 0 ; i < num ; i++ ) {
+		list[i] = cg_solidEntities[ indexes[i] ];
+	}
+	return num;
+}
+
 /*
 ====================
 CG_BuildSolidList
@@ -74,15 +231,56 @@ void CG_BuildSolidList( void ) {
 			continue;
 		}
 	}
+
+	CG_BuildSolidBroadphase();
 }
 
 /*
 ====================
-CG_ClipMoveToEntities
+CG_SolidEntitiesInBounds
 
+Collects the solid entities that can touch the given bounds, so a batch
+of traces that all stay within them can skip every other entity.
+Brush models are always included.
 ====================
 */
-static void CG_ClipMoveToEntities ( const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end,
+int CG_SolidEntitiesInBounds( const vec3_t mins, const vec3_t maxs, centity_t **list, int maxList ) {
+	int			i, x, zd, zu;
+	int			num;
+	entityState_t	*ent;
+	centity_t	*cent;
+
+	num = 0;
+	for ( i = 0 ; i < cg_numSolidEntities && num < maxList ; i++ ) {
+		cent = cg_solidEntities[ i ];
+		ent = &cent->currentState;
+
+		if ( ent->solid != SOLID_BMODEL ) {
+			x = (ent->solid & 255);
+			zd = ((ent->solid>>8) & 255);
+			zu = ((ent->solid>>16) & 255) - 32;
+
+			if ( cent->lerpOrigin[0] - x > maxs[0] || cent->lerpOrigin[0] + x < mins[0] ||
+				 cent->lerpOrigin[1] - x > maxs[1] || cent->lerpOrigin[1] + x < mins[1] ||
+				 cent->lerpOrigin[2] - zd > maxs[2] || cent->lerpOrigin[2] + zu < mins[2] ) {
+				continue;
+			}
+		}
+
+		list[num++] = cent;
+	}
+
+	return num;
+}
+
+/*
+====================
+CG_ClipMoveToEntityList
+
+====================
+*/
+static void CG_ClipMoveToEntityList ( centity_t **list, int numList,
+							const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end,
 							int skipNumber, int mask, trace_t *tr ) {
 	int			i, x, zd, zu;
 	trace_t		trace;
@@ -92,8 +290,8 @@ static void CG_ClipMoveToEntities ( const vec3_t start, const vec3_t mins, const
 	vec3_t		origin, angles;
 	centity_t	*cent;
 
-	for ( i = 0 ; i < cg_numSolidEntities ; i++ ) {
-		cent = cg_solidEntities[ i ];
+	for ( i = 0 ; i < numList ; i++ ) {
+		cent = list[ i ];
 		ent = &cent->currentState;
 
 		if ( ent->number == skipNumber ) {
@@ -137,6 +335,39 @@ static void CG_ClipMoveToEntities ( const vec3_t start, const vec3_t mins, const
 	}
 }
 
+/*
+====================
+CG_ClipMoveToEntities
+
+====================
+*/
+static void CG_ClipMoveToEntities ( const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end,
+							int skipNumber, int mask, trace_t *tr ) {
+	centity_t	*list[MAX_ENTITIES_IN_SNAPSHOT];
+	int			numList, i;
+	vec3_t		moveMins, moveMaxs;
+
+	for ( i = 0 ; i < 3 ; i++ ) {
+		if ( end[i] > start[i] ) {
+			moveMins[i] = start[i];
+			moveMaxs[i] = end[i];
+		} else {
+			moveMins[i] = end[i];
+			moveMaxs[i] = start[i];
+		}
+		if ( mins ) {
+			moveMins[i] += mins[i];
+		}
+		if ( maxs ) {
+			moveMaxs[i] += maxs[i];
+		}
+	}
+
+	numList = CG_SolidEntitiesForMove( moveMins, moveMaxs, list );
+	cg.traceClips += numList;
+	CG_ClipMoveToEntityList( list, numList, start, mins, maxs, end, skipNumber, mask, tr );
+}
+
 /*
 ================
 CG_Trace
@@ -146,6 +377,7 @@ void	CG_Trace( trace_t *result, const vec3_t start, const vec3_t mins, const vec
 					 int skipNumber, int mask ) {
 	trace_t	t;
 
+	cg.traces++;
 	trap_CM_BoxTrace ( &t, start, end, mins, maxs, 0, mask);
 	t.entityNum = t.fraction != 1.0 ? ENTITYNUM_WORLD : ENTITYNUM_NONE;
 	// check all other solid models
@@ -154,6 +386,28 @@ void	CG_Trace( trace_t *result, const vec3_t start, const vec3_t mins, const vec
 	*result = t;
 }
 
+/*
+================
+CG_TraceEntityList
+
+Same as CG_Trace, but only clips against the given entities,
+as collected by CG_SolidEntitiesInBounds.
+================
+*/
+void	CG_TraceEntityList( trace_t *result, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, 
+					 int skipNumber, int mask, centity_t **list, int numList ) {
+	trace_t	t;
+
+	cg.traces++;
+	cg.traceClips += numList;
+	trap_CM_BoxTrace ( &t, start, end, mins, maxs, 0, mask);
+	t.entityNum = t.fraction != 1.0 ? ENTITYNUM_WORLD : ENTITYNUM_NONE;
+	// check the listed solid models
+	CG_ClipMoveToEntityList (list, numList, start, mins, maxs, end, skipNumber, mask, &t);
+
+	*result = t;
+}
+
 /*
 ================
 JUHOX: CG_SmoothTrace
@@ -333,6 +587,52 @@ static void CG_TouchTriggerPrediction( void ) {
 
 
 
+/*
+=================
+CG_PredictionError
+
+Compares a saved prediction against the playerState_t the server sent for the
+same command time.  Fields that are never transmitted are taken from the
+snapshot before comparing.  Returns 0 when the saved prediction can be reused.
+=================
+*/
+static int CG_PredictionError( playerState_t *snapState, playerState_t *savedState ) {
+	playerState_t	ps;
+	vec3_t			delta;
+
+	memcpy( &ps, savedState, sizeof( playerState_t ) );
+	ps.lockTimer = snapState->lockTimer;
+	ps.externalEventTime = snapState->externalEventTime;
+	ps.lockedPlayer = snapState->lockedPlayer;
+	ps.lockedPosition = snapState->lockedPosition;
+	ps.attackPowerTotal = snapState->attackPowerTotal;
+	ps.attackPowerCurrent = snapState->attackPowerCurrent;
+	ps.ping = snapState->ping;
+	ps.pmove_framecount = snapState->pmove_framecount;
+	ps.jumppad_frame = snapState->jumppad_frame;
+	ps.entityEventSequence = snapState->entityEventSequence;
+	VectorSubtract( snapState->origin, ps.origin, delta );
+	if ( VectorLength( delta ) > 0.1f ) {
+		return 1;
+	}
+	VectorSubtract( snapState->velocity, ps.velocity, delta );
+	if ( VectorLength( delta ) > 0.1f ) {
+		return 2;
+	}
+	VectorSubtract( snapState->viewangles, ps.viewangles, delta );
+	if ( VectorLength( delta ) > 1.0f ) {
+		return 3;
+	}
+	// everything else has to match exactly
+	VectorCopy( snapState->origin, ps.origin );
+	VectorCopy( snapState->velocity, ps.velocity );
+	VectorCopy( snapState->viewangles, ps.viewangles );
+	if ( memcmp( &ps, snapState, sizeof( playerState_t ) ) ) {
+		return 4;
+	}
+	return 0;
+}
+
 /*
 =================
 CG_PredictPlayerState
@@ -351,9 +651,10 @@ but we simulate all unacknowledged commands each time, not just the new ones.
 This means that on an internet connection, quite a few pmoves may be issued
 each frame.
 
-OPTIMIZE: don't re-simulate unless the newly arrived snapshot playerState_t
-differs from the predicted one.  Would require saving all intermediate
-playerState_t during prediction.
+With cg_optimizePrediction, every intermediate playerState_t is saved by
+command.  When a new snapshot agrees with the state saved for its command
+time, the saved states after it are played back and only the new commands
+are simulated; otherwise everything is predicted again.
 
 We detect prediction errors and allow them to be decayed off over several frames
 to ease the jerk.
@@ -361,6 +662,7 @@ to ease the jerk.
 */
 void CG_PredictPlayerState( void ) {
 	int			cmdNum, current;
+	int			predictCmd, stateIndex, error, i;
 	playerState_t	oldPlayerState;
 	qboolean	moved;
 	usercmd_t	oldestCmd;
@@ -420,6 +722,40 @@ void CG_PredictPlayerState( void ) {
 	cg_pmove.pmove_fixed = pmove_fixed.integer;// | cg_pmove_fixed.integer;
 	cg_pmove.pmove_msec = pmove_msec.integer;
 
+	// find out which commands still need to be simulated
+	predictCmd = current - CMD_BACKUP + 1;
+	stateIndex = 0;
+	if ( cg_optimizePrediction.integer && !cg.nextFrameTeleport && !cg.thisFrameTeleport ) {
+		if ( cg.physicsTime == cg.lastServerTime ) {
+			// same baseline as last frame, only the new commands are unknown
+			predictCmd = cg.lastPredictedCommand + 1;
+		} else {
+			error = -1;
+			for ( i = cg.stateHead ; i != cg.stateTail ; i = ( i + 1 ) % NUM_SAVED_STATES ) {
+				if ( cg.savedPmoveStates[i].commandTime != cg.predictedPlayerState.commandTime ) {
+					continue;
+				}
+				error = CG_PredictionError( &cg.predictedPlayerState, &cg.savedPmoveStates[i] );
+				if ( !error ) {
+					*cg_pmove.ps = cg.savedPmoveStates[i];
+					cg.stateHead = ( i + 1 ) % NUM_SAVED_STATES;
+					predictCmd = cg.lastPredictedCommand + 1;
+				}
+				break;
+			}
+			if ( error ) {
+				cg.predictErrors++;
+				if ( cg_showmiss.integer ) {
+					CG_Printf( "full re-predict: error %i (%i so far)\n", error, cg.predictErrors );
+				}
+				cg.lastPredictedCommand = 0;
+				cg.stateTail = cg.stateHead;
+			}
+		}
+		cg.lastServerTime = cg.physicsTime;
+		stateIndex = cg.stateHead;
+	}
+
 	// run cmds
 	moved = qfalse;
 	for ( cmdNum = current - CMD_BACKUP + 1 ; cmdNum <= current ; cmdNum++ ) {
@@ -499,7 +835,24 @@ void CG_PredictPlayerState( void ) {
 		if ( cg_pmove.pmove_fixed ) {
 			cg_pmove.cmd.serverTime = ((cg_pmove.cmd.serverTime + pmove_msec.integer-1) / pmove_msec.integer) * pmove_msec.integer;
 		}
-		Pmove (&cg_pmove);
+		if ( !cg_optimizePrediction.integer ) {
+			Pmove (&cg_pmove);
+		} else if ( cmdNum >= predictCmd || ( stateIndex + 1 ) % NUM_SAVED_STATES == cg.stateHead ) {
+			// a new command, or no room left to keep it
+			Pmove (&cg_pmove);
+			cg.lastPredictedCommand = cmdNum;
+			if ( ( stateIndex + 1 ) % NUM_SAVED_STATES != cg.stateHead ) {
+				cg.savedPmoveStates[stateIndex] = *cg_pmove.ps;
+				stateIndex = ( stateIndex + 1 ) % NUM_SAVED_STATES;
+				cg.stateTail = stateIndex;
+			}
+		} else {
+			if ( cg_showmiss.integer && cg.savedPmoveStates[stateIndex].commandTime != cg_pmove.cmd.serverTime ) {
+				CG_Printf( "saved state miss\n" );
+			}
+			*cg_pmove.ps = cg.savedPmoveStates[stateIndex];
+			stateIndex = ( stateIndex + 1 ) % NUM_SAVED_STATES;
+		}
 		moved = qtrue;
 
 		// add push trigger movement effects
@@ -162,6 +162,8 @@ typedef enum {
 	CG_GET_ENTITY_TOKEN,
 	CG_R_ADDPOLYSTOSCENE,
 	CG_R_INPVS,
+	CG_R_REGISTERTAG,
+	CG_R_LERPTAGS,
 
 /*
 	CG_LOADCAMERA,
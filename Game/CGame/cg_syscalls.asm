@@ -89,6 +89,8 @@ equ trap_R_AddAdditiveLightToScene		-86
 equ trap_GetEntityToken					-87
 equ	trap_R_AddPolysToScene				-88
 equ trap_R_inPVS						-89
+equ trap_R_RegisterTag					-90
+equ trap_R_LerpTags						-91
 
 
 equ	memset						-101
@@ -304,6 +304,15 @@ int		trap_R_LerpTag( orientation_t *tag, clipHandle_t mod, int startFrame, int e
 	return syscall( CG_R_LERPTAG, tag, mod, startFrame, endFrame, PASSFLOAT(frac), tagName );
 }
 
+int		trap_R_RegisterTag( qhandle_t mod, const char *tagName ) {
+	return syscall( CG_R_REGISTERTAG, mod, tagName );
+}
+
+int		trap_R_LerpTags( orientation_t *tags, qhandle_t mod, int startFrame, int endFrame,
+					   float frac, const int *tagHandles, int numTags ) {
+	return syscall( CG_R_LERPTAGS, tags, mod, startFrame, endFrame, PASSFLOAT(frac), tagHandles, numTags );
+}
+
 void	trap_R_RemapShader( const char *oldShader, const char *newShader, const char *timeOffset ) {
 	syscall( CG_R_REMAP_SHADER, oldShader, newShader, timeOffset );
 }
@@ -3,6 +3,10 @@
 #define TRAIL_SEGMENTS		20
 #define TRAIL_MIN_SPEED		300
 #define TRAIL_MAX_LENGTH	( 2000 / TRAIL_SEGMENTS )
+#define MAX_TRAILS			256		// Trails alive at the same time
+#define TRAIL_EXPIRE_TIME	2000	// A collapsed trail without head updates for this long is released.
+									// Must exceed the leeway the callers give before resetting a trail.
+#define MAX_TRAIL_QUADS		1024	// Size of the merged vertex stream
 
 typedef struct {
 	vec3_t		pos[TRAIL_SEGMENTS];
@@ -11,20 +15,88 @@ typedef struct {
 	qhandle_t	shader;
 	float		width;
 	float		baseSpeed;
+	int			entityNum;
+	int			updateTime;		// last time the head was updated
 } trail_t;
 
-static trail_t cg_trails[MAX_GENTITIES];
+// Only entities that actually have a trail occupy a slot in the pool. The active
+// slots are kept densely packed in cg_activeTrails, so per frame work only scales
+// with the number of live trails.
+static trail_t		cg_trailPool[MAX_TRAILS];
+static int			cg_activeTrails[MAX_TRAILS];
+static int			cg_numActiveTrails;
+static short		cg_entityTrail[MAX_GENTITIES];	// slot + 1 in cg_trailPool, 0 = no trail
+
+static polyVert_t	cg_trailVerts[MAX_TRAIL_QUADS * 4];
 
 
 /*
 ===============
 CG_InitTrails
 ===============
-Initializes the array of trails for all centities.
+Initializes the trail pool.
 Should be called from CG_Init in cg_main.c
 */
 void CG_InitTrails( void ) {
-	memset( cg_trails, 0, sizeof(cg_trails) );
+	memset( cg_trailPool, 0, sizeof(cg_trailPool) );
+	memset( cg_entityTrail, 0, sizeof(cg_entityTrail) );
+	cg_numActiveTrails = 0;
+}
+
+
+/*
+===============
+CG_FreeTrail
+===============
+Releases the trail at the given position in the active list.
+*/
+static void CG_FreeTrail( int activeIndex ) {
+	trail_t *trail;
+
+	trail = &cg_trailPool[cg_activeTrails[activeIndex]];
+	cg_entityTrail[trail->entityNum] = 0;
+	trail->shader = 0;
+
+	cg_activeTrails[activeIndex] = cg_activeTrails[--cg_numActiveTrails];
+}
+
+
+/*
+===============
+CG_AllocTrail
+===============
+Returns the trail of an entity, taking a free slot from the pool if it has none.
+When the pool is exhausted the trail that went longest without an update is taken over.
+*/
+static trail_t *CG_AllocTrail( int entityNum ) {
+	int		i, slot, oldest;
+
+	if ( cg_entityTrail[entityNum] ) {
+		return &cg_trailPool[cg_entityTrail[entityNum] - 1];
+	}
+
+	if ( cg_numActiveTrails == MAX_TRAILS ) {
+		oldest = 0;
+		for ( i = 1; i < cg_numActiveTrails; i++ ) {
+			if ( cg_trailPool[cg_activeTrails[i]].updateTime < cg_trailPool[cg_activeTrails[oldest]].updateTime ) {
+				oldest = i;
+			}
+		}
+		CG_FreeTrail( oldest );
+	}
+
+	// any slot without a shader is free
+	for ( slot = 0; slot < MAX_TRAILS; slot++ ) {
+		if ( !cg_trailPool[slot].shader ) {
+			break;
+		}
+	}
+
+	cg_activeTrails[cg_numActiveTrails++] = slot;
+	cg_entityTrail[entityNum] = slot + 1;
+	cg_trailPool[slot].entityNum = entityNum;
+
+	return &cg_trailPool[slot];
 }
 
 
@@ -45,25 +117,34 @@ color:     A RGB triplet. If the passed shader has 'rgbGen vertex' set, color wi
 */
 void CG_ResetTrail( int entityNum, vec3_t origin, float baseSpeed, float width, qhandle_t shader, vec3_t color ) {
 	int i;
+	trail_t *trail;
+
+	if ( !shader ) {
+		return;
+	}
+
+	trail = CG_AllocTrail( entityNum );
 	
 	for ( i = 0; i < TRAIL_SEGMENTS; i++ ) {
-		VectorCopy( origin, cg_trails[entityNum].pos[i] );
+		VectorCopy( origin, trail->pos[i] );
+		VectorClear( trail->tangent[i] );
 	}
 	
-	cg_trails[entityNum].shader = shader;
+	trail->shader = shader;
+	trail->updateTime = cg.time;
 	
 	if ( baseSpeed > TRAIL_MIN_SPEED ) {
-		cg_trails[entityNum].baseSpeed = baseSpeed;
+		trail->baseSpeed = baseSpeed;
 	} else {
-		cg_trails[entityNum].baseSpeed = TRAIL_MIN_SPEED;
+		trail->baseSpeed = TRAIL_MIN_SPEED;
 	}
 
-	cg_trails[entityNum].width = width;
+	trail->width = width;
 
 	if ( color ) {
-		VectorCopy( color, cg_trails[entityNum].color );
+		VectorCopy( color, trail->color );
 	} else {
-		VectorSet( cg_trails[entityNum].color, 1.0f, 1.0f, 1.0f );
+		VectorSet( trail->color, 1.0f, 1.0f, 1.0f );
 	}
 }
 
@@ -79,8 +160,17 @@ origin:    Point where the trail's head should go to.
            (This should be equal to the entity's current position.)
 */
 void CG_UpdateTrailHead( int entityNum, vec3_t origin ) {
-	VectorCopy( origin, cg_trails[entityNum].pos[0] );
-	VectorSet( cg_trails[entityNum].tangent[0], 0, 0, 0 );
+	trail_t *trail;
+
+	// The trail may have been released or taken over; it will come back with the next reset.
+	if ( !cg_entityTrail[entityNum] ) {
+		return;
+	}
+
+	trail = &cg_trailPool[cg_entityTrail[entityNum] - 1];
+	VectorCopy( origin, trail->pos[0] );
+	VectorSet( trail->tangent[0], 0, 0, 0 );
+	trail->updateTime = cg.time;
 }
 
 
@@ -88,7 +178,8 @@ void CG_UpdateTrailHead( int entityNum, vec3_t origin ) {
 ===============
 CG_LerpTrails
 ===============
-Calculates the new positions for the nodes of all the trails.
+Calculates the new positions for the nodes of all the trails,
+and releases the trails that have collapsed and are no longer updated.
 */
 static void CG_LerpTrails( void ) {
 	float	dist, distDelta;
@@ -96,9 +187,9 @@ static void CG_LerpTrails( void ) {
 	int		i, j;
 	trail_t	*trail;
 
-	for ( j = 0; j < MAX_GENTITIES; j++ ) {
+	for ( j = cg_numActiveTrails - 1; j >= 0; j-- ) {
 
-		trail = &cg_trails[j];
+		trail = &cg_trailPool[cg_activeTrails[j]];
 		// Don't bother updating if the very end and very start are already
 		// the same. We'd either be on the start frame or the last frame of
 		// the trails existence. It's not going to be drawn either way.
@@ -106,7 +197,10 @@ static void CG_LerpTrails( void ) {
 		// FIXED: Just incase we'd be able to get a full loop back of the first
 		//        to the last point in with guided missiles, ALWAYS check those.
 		if ( !Distance(trail->pos[0], trail->pos[TRAIL_SEGMENTS - 1] ) &&
-			 !( cg_entities[j].currentState.eFlags & EF_GUIDED ) ) {
+			 !( cg_entities[trail->entityNum].currentState.eFlags & EF_GUIDED ) ) {
+			if ( cg.time - trail->updateTime > TRAIL_EXPIRE_TIME ) {
+				CG_FreeTrail( j );
+			}
 			continue;
 		}
 
@@ -141,25 +235,6 @@ static void CG_LerpTrails( void ) {
 }
 
 
-/*
-====================
-CG_ShiftTrailVerts
-====================
-Pushes the settings from the 0th and 1st polygon vertex to the 2nd and 3rd one.
-Is a utility function used by CG_AddTrailsToScene.
-verts: An array of 4 polyVert_t structures to operate on.
-*/
-static void CG_ShiftTrailVerts( polyVert_t *verts ) {
-
-	VectorCopy( verts[0].xyz, verts[3].xyz );
-	VectorCopy( verts[1].xyz, verts[2].xyz );
-	verts[3].st[0] = verts[0].st[0];
-	verts[3].st[1] = verts[0].st[1];
-	verts[2].st[0] = verts[1].st[0];
-	verts[2].st[1] = verts[1].st[1];
-}
-
-
 /*
 ====================
 CG_GetTrailVerts
@@ -169,8 +244,7 @@ Is a utility function used by CG_AddTrailsToScene.
 point:   The position of the node
 tangent: The direction from the current node to the next node
 width:   The width of the trail
-verts:   An array of 4 polyVert_t structures to operate on,
-         though only the 0th and 1st element are of importance.
+verts:   An array of 2 polyVert_t structures to operate on.
 */
 static void CG_GetTrailVerts( vec3_t point, vec3_t tangent, float width, polyVert_t *verts ) {
 	vec3_t offset, viewLine, dummyPoint;
@@ -195,40 +269,104 @@ static void CG_GetTrailVerts( vec3_t point, vec3_t tangent, float width, polyVer
 }
 
 
+/*
+=====================
+CG_AddTrailToStream
+=====================
+Appends the quads of one trail to the vertex stream, flushing it when it's full.
+Is a utility function used by CG_AddTrailsToScene.
+*/
+static int CG_AddTrailToStream( trail_t *trail, int numQuads ) {
+	int			i, k;
+	polyVert_t	node[2], prev[2];
+	polyVert_t	*quad;
+	vec3_t		blendTangent;
+	byte		modulate[4];
+
+	// color the vertices correctly
+	for ( k = 0; k < 3; k++ ) {
+		modulate[k] = trail->color[k] * 255;
+	}
+	modulate[3] = 255;
+
+	memset( node, 0, sizeof(node) );
+	node[0].st[1] = 1.0f;
+	node[1].st[1] = 0.0f;
+
+	i = TRAIL_SEGMENTS - 1;
+	VectorCopy( trail->tangent[i], blendTangent );
+	VectorNormalize( blendTangent );
+	CG_GetTrailVerts( trail->pos[i], blendTangent, trail->width, node );
+	node[0].st[0] = node[1].st[0] = 0.0f;
+	prev[0] = node[0];
+	prev[1] = node[1];
+
+	for ( i = TRAIL_SEGMENTS - 2; i >= 0; i-- ) {
+
+		// Don't draw this trail node if it overlaps with the previous one.
+		if (! Distance( trail->pos[i+1], trail->pos[i] ) ) {
+			continue;
+		}
+
+		// Properly blend the tangents for a smoother match
+		if ( i == 0 || !VectorLength( trail->tangent[i] ) ) {
+			VectorCopy( trail->tangent[i + 1], blendTangent );
+		} else {
+			VectorAdd( trail->tangent[i], trail->tangent[i+1], blendTangent );				
+		}
+		VectorNormalize( blendTangent );
+
+		CG_GetTrailVerts( trail->pos[i], blendTangent, trail->width, node );
+		node[0].st[0] = node[1].st[0] = 1.0f - (float)i / (TRAIL_SEGMENTS - 1);
+
+		if ( numQuads == MAX_TRAIL_QUADS ) {
+			trap_R_AddPolysToScene( trail->shader, 4, cg_trailVerts, numQuads );
+			numQuads = 0;
+		}
+
+		quad = &cg_trailVerts[numQuads * 4];
+		quad[0] = node[0];
+		quad[1] = node[1];
+		quad[2] = prev[1];
+		quad[3] = prev[0];
+		for ( k = 0; k < 4; k++ ) {
+			quad[k].modulate[0] = modulate[0];
+			quad[k].modulate[1] = modulate[1];
+			quad[k].modulate[2] = modulate[2];
+			quad[k].modulate[3] = modulate[3];
+		}
+		numQuads++;
+
+		prev[0] = node[0];
+		prev[1] = node[1];
+	}
+
+	return numQuads;
+}
+
+
 /*
 =====================
 CG_AddTrailsToScene
 =====================
 Updates (using CG_LerpTrails) the entity trails and renders any active ones to the scene.
+All trails sharing a shader go out as one vertex stream.
 Should be called by CG_DrawActiveFrame in cg_view.c
 */
 void CG_AddTrailsToScene( void ) {
-	int			i, j, k;
+	int			i, j, numQuads;
+	int			numDrawn;
 	trail_t		*trail;
-	polyVert_t	verts[4];
-	vec3_t		blendTangent;
+	qhandle_t	shader;
+	int			drawList[MAX_TRAILS];
 
 	CG_LerpTrails();
 
-	// Initialize the polyVerts.
-	memset( verts, 0, sizeof(verts) );
-
-	verts[0].st[1] = 1.0f;
-	verts[1].st[1] = 0.0f;
-	verts[2].st[1] = 0.0f;
-	verts[3].st[1] = 1.0f;
-
-	for ( i = 0; i < 4; i++ ) {
-		verts[i].modulate[3] = 255;
-	}
-
-	for ( j = 0; j < MAX_GENTITIES; j++ ) {
+	// Collect the visible trails.
+	numDrawn = 0;
+	for ( j = 0; j < cg_numActiveTrails; j++ ) {
 		
-		trail = &cg_trails[j];
-
-		if ( !trail->shader ) {
-			continue;
-		}
+		trail = &cg_trailPool[cg_activeTrails[j]];
 
 		// Don't bother drawing if the very end and very start are already
 		// the same. We'd have an invisible trail anyway
@@ -236,45 +374,33 @@ void CG_AddTrailsToScene( void ) {
 		// FIXED: Just incase we'd be able to get a full loop back of the first
 		//        to the last point in with guided missiles, ALWAYS check those.
 		if ( !Distance(trail->pos[0], trail->pos[TRAIL_SEGMENTS - 1] ) &&
-			 !( cg_entities[j].currentState.eFlags & EF_GUIDED ) ) {
+			 !( cg_entities[trail->entityNum].currentState.eFlags & EF_GUIDED ) ) {
 			continue;
 		}
 
-		// color the vertices correctly
-		for ( i = 0; i < 4; i++ ) {
-			for ( k = 0; k < 3; k++ ) {
-				verts[i].modulate[k] = trail->color[k] * 255;
-			}
-		}
+		drawList[numDrawn++] = cg_activeTrails[j];
+	}
 
-		i = TRAIL_SEGMENTS - 1;
-		VectorCopy( trail->tangent[i], blendTangent );
-		VectorNormalize( blendTangent );
-		CG_GetTrailVerts( trail->pos[i], blendTangent, trail->width, verts );
-		verts[0].st[0] = verts[1].st[0] = 0.0f;
-		CG_ShiftTrailVerts( verts );
+	// Emit them one shader at a time.
+	while ( numDrawn ) {
+		shader = cg_trailPool[drawList[0]].shader;
+		numQuads = 0;
 
-		for ( i = TRAIL_SEGMENTS - 2; i >= 0; i-- ) {
+		for ( i = 0, j = 0; i < numDrawn; i++ ) {
+			trail = &cg_trailPool[drawList[i]];
 
-			// Don't draw this trail node if it overlaps with the previous one.
-			if (! Distance( trail->pos[i+1], trail->pos[i] ) ) {
+			if ( trail->shader != shader ) {
+				drawList[j++] = drawList[i];
 				continue;
 			}
 
-			// Properly blend the tangents for a smoother match
-			if ( i == 0 || !VectorLength( trail->tangent[i] ) ) {
-				VectorCopy( trail->tangent[i + 1], blendTangent );
-			} else {
-				VectorAdd( trail->tangent[i], trail->tangent[i+1], blendTangent );				
-			}
-			VectorNormalize( blendTangent );
-
-			CG_GetTrailVerts( trail->pos[i], blendTangent, trail->width, verts );
-			verts[0].st[0] = verts[1].st[0] = 1.0f - (float)i / (TRAIL_SEGMENTS - 1);
+			numQuads = CG_AddTrailToStream( trail, numQuads );
+		}
 
-			trap_R_AddPolyToScene( trail->shader, 4, verts );
-			CG_ShiftTrailVerts( verts );
+		if ( numQuads ) {
+			trap_R_AddPolysToScene( shader, 4, cg_trailVerts, numQuads );
 		}
+
+		numDrawn = j;
 	}
 }
-
@@ -35,7 +35,7 @@ typedef struct {
 	chargeVoice_t	chargeVoice[MAX_CHARGE_VOICES];
 											// voice samples played back when charging
 	sfxHandle_t		chargeLoopSound;		// sound played while charging
-	char			chargeParticleSystem[MAX_QPATH];
+	int				chargeParticleSystem;	// particle system IDs, 0 for none
 	// FLASH
 	qhandle_t		flashModel;				// flash model's .md3 file
 	qhandle_t		flashSkin;				// flash model's .skin file
@@ -50,8 +50,8 @@ typedef struct {
 	sfxHandle_t		flashOnceSound;			// Played only at the start of a firing session, instead
 											// of with each projectile. Resets when attack button comes up.
 	sfxHandle_t		firingSound;			// When doing a sustained blast
-	char			flashParticleSystem[MAX_QPATH];
-	char			firingParticleSystem[MAX_QPATH];
+	int				flashParticleSystem;
+	int				firingParticleSystem;
 	// MISSILE
 	qhandle_t		missileModel;
 	qhandle_t		missileSkin;
@@ -69,7 +69,7 @@ typedef struct {
 	qhandle_t		missileTrailSpiralShader;
 	float			missileTrailSpiralRadius;
 	float			missileTrailSpiralOffset;
-	char			missileParticleSystem[MAX_QPATH];
+	int				missileParticleSystem;
 	sfxHandle_t		missileSound;
 	// EXPLOSION / SHIELD
 	qhandle_t		explosionModel;
@@ -81,8 +81,8 @@ typedef struct {
 	vec3_t			explosionDlightColor;
 	qhandle_t		shockwaveModel;
 	qhandle_t		shockwaveSkin;
-	char			explosionParticleSystem[MAX_QPATH];
-	char			smokeParticleSystem[MAX_QPATH];
+	int				explosionParticleSystem;
+	int				smokeParticleSystem;
 	qhandle_t		markShader;
 	qhandle_t		markSize;
 	qboolean		noRockDebris;
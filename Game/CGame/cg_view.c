@@ -876,13 +876,59 @@ static qboolean CG_IsLFVisible(const vec3_t origin, const vec3_t pos, float lfra
 }
 #endif
 
+/*
+=====================
+CG_LFSamplePoint
+
+Slots 0-7 of the occlusion cache are the corners of the light's bounding cube,
+the others lie on a disc facing the viewer. The disc samples use a fixed spiral
+instead of random radii, so cached results stay meaningful from frame to frame.
+=====================
+*/
+#if MAPLENSFLARES
+static void CG_LFSamplePoint(
+	const lensFlareEntity_t* lfent, const vec3_t origin,
+	const vec3_t vx, const vec3_t vy, int slot, vec3_t end
+){
+	float angle;
+	float radius;
+
+	VectorCopy(origin, end);
+
+	if(slot < 8){
+		end[0] += slot&1? lfent->lightRadius : -lfent->lightRadius;
+		end[1] += slot&2? lfent->lightRadius : -lfent->lightRadius;
+		end[2] += slot&4? lfent->lightRadius : -lfent->lightRadius;
+		return;
+	}
+
+	slot -= 8;
+	angle = 2.39996323 * slot;	// golden angle
+	radius = 0.95 * lfent->lightRadius * sqrt((slot + 0.5) / (float)NUMVISSAMPLES);
+
+	VectorMA(end, radius * cos(angle), vx, end);
+	VectorMA(end, radius * sin(angle), vy, end);
+}
+#endif
+
 /*
 =====================
 JUHOX: CG_ComputeVisibleLightSample
+
+Every flare keeps the results of its occlusion rays and only re-traces
+cg_lensFlareRays of them per frame, cycling through all of them. All flares
+together stop tracing once cg_lensFlareTraceBudget rays were spent in a frame,
+apart from one ray per flare so none of them starves. Once every ray has been
+re-traced from a resting view the result equals the full computation.
 =====================
 */
 #if MAPLENSFLARES
-#define NUMVISSAMPLES 50
+#define LFVIS_UNKNOWN	0
+#define LFVIS_OCCLUDED	1
+#define LFVIS_VISIBLE	2
+static int lfTraceFrame = -1;
+static int lfTracesLeft;
+
 static float CG_ComputeVisibleLightSample(
 	lensFlareEntity_t* lfent,
 	const vec3_t origin,		// redundant, but we have this already
@@ -890,43 +936,41 @@ static float CG_ComputeVisibleLightSample(
 	vec3_t visOrigin,
 	int quality
 ){
-	/*
-	static const float angleTab[48] ={
-		0, 45, 90, 135, 180, 225, 270, 315,
-		7.5, 15, 22.5, 30, 37.5, 52.5, 60, 67.5,
-		75, 82.5, 97.5, 105, 112.5, 120, 127.5, 142.5,
-		150, 157.5, 165, 172.5, 187.5, 195, 202.5, 210,
-		217.5, 232.5, 240, 247.5, 255, 262.5, 277.5, 285,
-		292.5, 300, 307.5, 322.5, 330, 337.5, 345, 352.5
-	};
-	*/
 	vec3_t vx, vy;
+	vec3_t end;
+	int numSlots;
+	int rays;
+	int slot;
 	int visCount;
+	int known;
+	int cornersVisible;
+	int cornersKnown;
 	int i;
 
-	if(lfent->lightRadius <= 1 || quality < 2){
-		VectorCopy(origin, visOrigin);
-		return CG_IsLFVisible(origin, origin, lfent->radius);
+	if(lfTraceFrame != cg.clientFrame){
+		lfTraceFrame = cg.clientFrame;
+		lfTracesLeft = cg_lensFlareTraceBudget.integer;
 	}
 
-	visCount = 0;
-	for (i = 0; i < 8; i++){
-		vec3_t corner;
-
-		VectorCopy(origin, corner);
-		corner[0] += i&1? lfent->lightRadius : -lfent->lightRadius;
-		corner[1] += i&2? lfent->lightRadius : -lfent->lightRadius;
-		corner[2] += i&4? lfent->lightRadius : -lfent->lightRadius;
-		if(!CG_IsLFVisible(origin, corner, 1.8 * lfent->radius)) continue;	// 1.8 = rough approx. of sqrt(3)
-		visCount++;
+	numSlots = (lfent->lightRadius <= 1 || quality < 2)? 1 : NUMVISSLOTS;
+	if(lfent->visNumSlots != numSlots){
+		memset(lfent->visSamples, LFVIS_UNKNOWN, sizeof(lfent->visSamples));
+		lfent->visNumSlots = numSlots;
+		lfent->visCursor = 0;
+		lfent->visPending = numSlots;
 	}
-	if(visCount == 0){
-		VectorClear(visOrigin);
-		return 0;
+	if(cg.numFramesWithoutViewMovement <= 0){
+		lfent->visPending = numSlots;
 	}
-	else if(visCount == 8){
+
+	if(numSlots == 1){
+		if(lfTracesLeft > 0 || lfent->visSamples[0] == LFVIS_UNKNOWN){
+			lfent->visSamples[0] = CG_IsLFVisible(origin, origin, lfent->radius)? LFVIS_VISIBLE : LFVIS_OCCLUDED;
+			lfent->visPending = 0;
+			lfTracesLeft--;
+		}
 		VectorCopy(origin, visOrigin);
-		return 1;
+		return lfent->visSamples[0] == LFVIS_VISIBLE;
 	}
 
 	{
@@ -939,54 +983,75 @@ static float CG_ComputeVisibleLightSample(
 		CrossProduct(vz, vx, vy);
 		// NOTE: the handedness of (vx, vy, vz) is not important
 	}
-	
-	visCount = 0;
-	VectorClear(visOrigin);
-	//offset = 45 * random();
-	for (i = 0; i < NUMVISSAMPLES; i++){
-		vec3_t end;
 
-		VectorCopy(origin, end);
-		{
-			float angle;
-			float radius;
-			float x, y;
+	// re-trace the next few slots
+	rays = cg_lensFlareRays.integer;
+	if(rays > lfTracesLeft) rays = lfTracesLeft;
+	if(rays > numSlots) rays = numSlots;
+	if(rays < 1) rays = 1;
+	lfTracesLeft -= rays;
 
-			/*
-			if(i == 8){
-				if(visCount <= 0) return 0;
-				if(visCount >= 8){
-					VectorCopy(origin, visOrigin);
-					return 1;
-				}
-			}
-			*/
-			/*
-			angle = (M_PI/180) * (angleTab[i] + offset);
-			x = 0.95 * lfent->lightRadius * cos(angle);
-			y = 0.95 * lfent->lightRadius * sin(angle);
-			*/
-			angle = (2*M_PI) * /*random()*/i / (float)NUMVISSAMPLES;
-			radius = 0.95 * lfent->lightRadius * sqrt(random());
+	for (i = 0; i < rays; i++){
+		slot = lfent->visCursor;
+		lfent->visCursor = (slot + 1) % numSlots;
 
-			x = radius * cos(angle);
-			y = radius * sin(angle);
+		CG_LFSamplePoint(lfent, origin, vx, vy, slot, end);
+		lfent->visSamples[slot] = CG_IsLFVisible(
+			origin, end, slot < 8? 1.8 * lfent->radius : lfent->radius	// 1.8 = rough approx. of sqrt(3)
+		)? LFVIS_VISIBLE : LFVIS_OCCLUDED;
+	}
 
-			VectorMA(end, x, vx, end);
-			VectorMA(end, y, vy, end);
+	if(lfent->visPending > 0){
+		lfent->visPending -= rays;
+		if(lfent->visPending <= 0 && cg.numFramesWithoutViewMovement > 0){
+			// the cache is exact now, don't blend it with older estimates
+			lfent->libNumEntries = 0;
+		}
+	}
+
+	// the corners decide whether the disc needs to be looked at
+	cornersVisible = 0;
+	cornersKnown = 0;
+	for (i = 0; i < 8; i++){
+		if(lfent->visSamples[i] == LFVIS_UNKNOWN) continue;
+		cornersKnown++;
+		if(lfent->visSamples[i] == LFVIS_VISIBLE) cornersVisible++;
+	}
+	if(cornersKnown == 8){
+		if(cornersVisible == 0){
+			VectorClear(visOrigin);
+			return 0;
+		}
+		else if(cornersVisible == 8){
+			VectorCopy(origin, visOrigin);
+			return 1;
 		}
+	}
 
-		if(!CG_IsLFVisible(origin, end, lfent->radius)) continue;
+	visCount = 0;
+	known = 0;
+	VectorClear(visOrigin);
+	for (slot = 8; slot < numSlots; slot++){
+		if(lfent->visSamples[slot] == LFVIS_UNKNOWN) continue;
+		known++;
+		if(lfent->visSamples[slot] != LFVIS_VISIBLE) continue;
 
+		CG_LFSamplePoint(lfent, origin, vx, vy, slot, end);
 		VectorAdd(visOrigin, end, visOrigin);
 		visCount++;
 	}
 
+	if(known <= 0){
+		// nothing traced on the disc yet, go by the corners
+		VectorCopy(origin, visOrigin);
+		return cornersKnown > 0? (float)cornersVisible / (float)cornersKnown : 0;
+	}
+
 	if(visCount > 0){
 		_VectorScale(visOrigin, 1.0 / visCount, visOrigin);
 	}
 
-	return (float)visCount / (float)NUMVISSAMPLES;
+	return (float)visCount / (float)known;
 }
 #endif
 
@@ -1111,6 +1176,7 @@ void CG_AddLensFlare(lensFlareEntity_t* lfent, int quality){
 	if(lfeff->range > 0 && distanceSqr >= lfeff->rangeSqr){
 		SkipLF:
 		lfent->libNumEntries = 0;
+		lfent->visNumSlots = 0;
 		return;
 	}
 	if(distanceSqr < Square(16)) goto SkipLF;
@@ -1129,7 +1195,8 @@ void CG_AddLensFlare(lensFlareEntity_t* lfent, int quality){
 	if(
 		cg.numFramesWithoutViewMovement <= LIGHT_INTEGRATION_BUFFER_SIZE ||
 		lfent->lock ||
-		lfent->libNumEntries <= 0
+		lfent->libNumEntries <= 0 ||
+		lfent->visPending > 0
 	){
 		float vls;
 
@@ -1309,6 +1376,7 @@ static void CG_AddMapLensFlares(void){
 		if(lfeff->range > 0 && distanceSqr >= lfeff->rangeSqr){
 			SkipLF:
 			lfent->libNumEntries = 0;
+			lfent->visNumSlots = 0;
 			continue;
 		}
 		if(distanceSqr < Square(16)) goto SkipLF;
@@ -1327,7 +1395,8 @@ static void CG_AddMapLensFlares(void){
 		if(
 			cg.numFramesWithoutViewMovement <= LIGHT_INTEGRATION_BUFFER_SIZE ||
 			lfent->lock ||
-			lfent->libNumEntries <= 0
+			lfent->libNumEntries <= 0 ||
+			lfent->visPending > 0
 		){
 			float vls;
 
@@ -1538,6 +1607,10 @@ void CG_DrawActiveFrame(int serverTime, stereoFrame_t stereoView, qboolean demoP
 
 	cg.time = serverTime;
 	cg.demoPlayback = demoPlayback;
+	cg.frameTraces = cg.traces;
+	cg.frameTraceClips = cg.traceClips;
+	cg.traces = 0;
+	cg.traceClips = 0;
 
 	// update cvars
 	CG_UpdateCvars();
@@ -1593,6 +1666,7 @@ void CG_DrawActiveFrame(int serverTime, stereoFrame_t stereoView, qboolean demoP
 
 	// build cg.refdef
 	inwater = CG_CalcViewValues();
+	CG_Cull_SetupView();
 
 #if EARTHQUAKE_SYSTEM
 	cg.additionalTremble = 0;	// JUHOX
@@ -1607,6 +1681,7 @@ void CG_DrawActiveFrame(int serverTime, stereoFrame_t stereoView, qboolean demoP
 	if(!cg.hyperspace ){
 		CG_FrameHist_NextFrame();
 		CG_AddPacketEntities();			// adter calcViewValues, so predicted player state is correct
+		CG_FlushAuraPolys();
 		CG_AddBeamTables();
 		CG_AddTrailsToScene();
 		CG_AddMarks();
@@ -53,7 +53,7 @@ void CG_weapGfx_StoreBuffer(int clientNum, int weaponNum) {
 	dest->chargeDlightStartRadius = src->chargeDlightStartRadius;
 	dest->chargeDlightEndRadius = src->chargeDlightEndRadius;
 
-	Q_strncpyz( dest->chargeParticleSystem, src->chargeParticleSystem, sizeof( dest->chargeParticleSystem ));
+	dest->chargeParticleSystem = PSys_RegisterSystem( src->chargeParticleSystem );
 
 	
 	// --< Flash >--
@@ -80,8 +80,8 @@ void CG_weapGfx_StoreBuffer(int clientNum, int weaponNum) {
 	dest->flashDlightRadius = src->flashDlightRadius;
 	dest->flashSize = src->flashSize;
 
-	Q_strncpyz( dest->flashParticleSystem, src->flashParticleSystem, sizeof( dest->flashParticleSystem ));
-	Q_strncpyz( dest->firingParticleSystem, src->firingParticleSystem, sizeof( dest->firingParticleSystem ));
+	dest->flashParticleSystem = PSys_RegisterSystem( src->flashParticleSystem );
+	dest->firingParticleSystem = PSys_RegisterSystem( src->firingParticleSystem );
 	
 
 	// --< Explosion >--
@@ -105,8 +105,8 @@ void CG_weapGfx_StoreBuffer(int clientNum, int weaponNum) {
 	dest->explosionTime = src->explosionTime;
 	dest->markSize = src->markSize;
 	dest->noRockDebris = src->noRockDebris;
-	Q_strncpyz( dest->smokeParticleSystem, src->smokeParticleSystem, sizeof( dest->smokeParticleSystem ));
-	Q_strncpyz( dest->explosionParticleSystem, src->explosionParticleSystem, sizeof( dest->explosionParticleSystem ));
+	dest->smokeParticleSystem = PSys_RegisterSystem( src->smokeParticleSystem );
+	dest->explosionParticleSystem = PSys_RegisterSystem( src->explosionParticleSystem );
 	
 	// --< Missile >--
 	if ( *src->missileModel ) dest->missileModel = trap_R_RegisterModel( src->missileModel );
@@ -125,7 +125,7 @@ void CG_weapGfx_StoreBuffer(int clientNum, int weaponNum) {
 
 	dest->missileDlightRadius = src->missileDlightRadius;
 	dest->missileSize = src->missileSize;
-	Q_strncpyz( dest->missileParticleSystem, src->missileParticleSystem, sizeof( dest->missileParticleSystem ));
+	dest->missileParticleSystem = PSys_RegisterSystem( src->missileParticleSystem );
 
 
 	// --< Trail >--
@@ -500,13 +500,13 @@ void CG_AddPlayerWeapon( refEntity_t *parent, playerState_t *ps, centity_t *cent
 		CG_AddPlayerWeaponChargeVoices( cent, weaponGraphics, lerp, backLerp );
 
 		// Set up any charging particle systems
-		if ( weaponGraphics->chargeParticleSystem[0] ) {
+		if ( weaponGraphics->chargeParticleSystem ) {
 			// If the entity wasn't previously in the PVS, if the weapon nr switched, or if the weaponstate switched
 			// we need to start a new system
 			if ( !CG_FrameHist_WasInPVS(ent->number) ||
 				 CG_FrameHist_IsWeaponNr(ent->number) != CG_FrameHist_WasWeaponNr(ent->number) ||
 				 CG_FrameHist_IsWeaponState(ent->number) != CG_FrameHist_WasWeaponState(ent->number) ) {
-				PSys_SpawnCachedSystem( weaponGraphics->chargeParticleSystem, cent->lerpOrigin, NULL, cent, weaponGraphics->chargeTag[0], qfalse, qtrue );
+				PSys_SpawnSystemByID( weaponGraphics->chargeParticleSystem, cent->lerpOrigin, NULL, cent, weaponGraphics->chargeTag[0], qfalse, qtrue );
 			}
 		}		
 
@@ -535,13 +535,13 @@ void CG_AddPlayerWeapon( refEntity_t *parent, playerState_t *ps, centity_t *cent
 		}
 
 		// Set up any firing particle systems
-		if ( weaponGraphics->firingParticleSystem[0] ) {
+		if ( weaponGraphics->firingParticleSystem ) {
 			// If the entity wasn't previously in the PVS, if the weapon nr switched, or if the weaponstate switched
 			// we need to start a new system
 			if ( !CG_FrameHist_WasInPVS(ent->number) ||
 				 CG_FrameHist_IsWeaponNr(ent->number) != CG_FrameHist_WasWeaponNr(ent->number) ||
 				 CG_FrameHist_IsWeaponState(ent->number) != CG_FrameHist_WasWeaponState(ent->number) ) {
-				PSys_SpawnCachedSystem( weaponGraphics->firingParticleSystem, cent->lerpOrigin, NULL, cent, weaponGraphics->chargeTag[0], qfalse, qtrue );
+				PSys_SpawnSystemByID( weaponGraphics->firingParticleSystem, cent->lerpOrigin, NULL, cent, weaponGraphics->chargeTag[0], qfalse, qtrue );
 			}
 		}
 	}
@@ -943,8 +943,8 @@ void CG_FireWeapon( centity_t *cent, qboolean altFire ) {
 	// append the flash to the weapon model.
 	cent->muzzleFlashTime = cg.time;
 
-	if ( weaponGraphics->flashParticleSystem[0] ) {
-		PSys_SpawnCachedSystem( weaponGraphics->flashParticleSystem, cent->lerpOrigin, NULL, cent, weaponGraphics->chargeTag[0], qfalse, qfalse );
+	if ( weaponGraphics->flashParticleSystem ) {
+		PSys_SpawnSystemByID( weaponGraphics->flashParticleSystem, cent->lerpOrigin, NULL, cent, weaponGraphics->chargeTag[0], qfalse, qfalse );
 	}
 
 	// play a sound
@@ -1080,85 +1080,85 @@ void CG_UserMissileHitWall( int weapon, int clientNum, int powerups, int number,
 			if (cg_particlesQuality.value == 2) {
 				if (tr.surfaceFlags & SURF_METALSTEPS){
 					if(weaponGraphics->explosionSize <= 10){
-						PSys_SpawnCachedSystem( "SmallExplosionDebris", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisSystems[0], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}else if(weaponGraphics->explosionSize <= 25){
-						PSys_SpawnCachedSystem( "NormalExplosionDebris", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisSystems[1], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}else if(weaponGraphics->explosionSize <= 50){
-						PSys_SpawnCachedSystem( "LargeExplosionDebris", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisSystems[2], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}else{
-						PSys_SpawnCachedSystem( "ExtraLargeExplosionDebris", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisSystems[3], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}
 				} else if (tr.surfaceFlags & SURF_FLESH){
 					if(weaponGraphics->explosionSize <= 10){
-						PSys_SpawnCachedSystem( "SmallExplosionDebris", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisSystems[0], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}else if(weaponGraphics->explosionSize <= 25){
-						PSys_SpawnCachedSystem( "NormalExplosionDebris", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisSystems[1], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}else if(weaponGraphics->explosionSize <= 50){
-						PSys_SpawnCachedSystem( "LargeExplosionDebris", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisSystems[2], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}else{
-						PSys_SpawnCachedSystem( "ExtraLargeExplosionDebris", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisSystems[3], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}
 				} else if (tr.surfaceFlags & SURF_DUST){
 					if(weaponGraphics->explosionSize <= 10){
-						PSys_SpawnCachedSystem( "SmallExplosionDebris", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisSystems[0], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}else if(weaponGraphics->explosionSize <= 25){
-						PSys_SpawnCachedSystem( "NormalExplosionDebris", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisSystems[1], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}else if(weaponGraphics->explosionSize <= 50){
-						PSys_SpawnCachedSystem( "LargeExplosionDebris", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisSystems[2], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}else{
-						PSys_SpawnCachedSystem( "ExtraLargeExplosionDebris", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisSystems[3], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}
 				} else {
 					if(weaponGraphics->explosionSize <= 10){
-						PSys_SpawnCachedSystem( "SmallExplosionDebris", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisSystems[0], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}else if(weaponGraphics->explosionSize <= 25){
-						PSys_SpawnCachedSystem( "NormalExplosionDebris", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisSystems[1], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}else if(weaponGraphics->explosionSize <= 50){
-						PSys_SpawnCachedSystem( "LargeExplosionDebris", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisSystems[2], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}else{
-						PSys_SpawnCachedSystem( "ExtraLargeExplosionDebris", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisSystems[3], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}
 				}
 			}else if (cg_particlesQuality.value == 1){
 				if (tr.surfaceFlags & SURF_METALSTEPS){
 					if(weaponGraphics->explosionSize <= 10){
-						PSys_SpawnCachedSystem( "SmallExplosionDebrisLow", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisLowSystems[0], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}else if(weaponGraphics->explosionSize <= 25){
-						PSys_SpawnCachedSystem( "NormalExplosionDebrisLow", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisLowSystems[1], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}else if(weaponGraphics->explosionSize <= 50){
-						PSys_SpawnCachedSystem( "LargeExplosionDebrisLow", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisLowSystems[2], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}else{
-						PSys_SpawnCachedSystem( "ExtraLargeExplosionDebrisLow", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisLowSystems[3], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}
 				} else if (tr.surfaceFlags & SURF_FLESH){
 					if(weaponGraphics->explosionSize <= 10){
-						PSys_SpawnCachedSystem( "SmallExplosionDebrisLow", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisLowSystems[0], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}else if(weaponGraphics->explosionSize <= 25){
-						PSys_SpawnCachedSystem( "NormalExplosionDebrisLow", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisLowSystems[1], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}else if(weaponGraphics->explosionSize <= 50){
-						PSys_SpawnCachedSystem( "LargeExplosionDebrisLow", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisLowSystems[2], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}else{
-						PSys_SpawnCachedSystem( "ExtraLargeExplosionDebrisLow", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisLowSystems[3], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}
 				} else if (tr.surfaceFlags & SURF_DUST){
 					if(weaponGraphics->explosionSize <= 10){
-						PSys_SpawnCachedSystem( "SmallExplosionDebrisLow", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisLowSystems[0], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}else if(weaponGraphics->explosionSize <= 25){
-						PSys_SpawnCachedSystem( "NormalExplosionDebrisLow", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisLowSystems[1], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}else if(weaponGraphics->explosionSize <= 50){
-						PSys_SpawnCachedSystem( "LargeExplosionDebrisLow", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisLowSystems[2], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}else{
-						PSys_SpawnCachedSystem( "ExtraLargeExplosionDebrisLow", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisLowSystems[3], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}
 				} else {
 					if(weaponGraphics->explosionSize <= 10){
-						PSys_SpawnCachedSystem( "SmallExplosionDebrisLow", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisLowSystems[0], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}else if(weaponGraphics->explosionSize <= 25){
-						PSys_SpawnCachedSystem( "NormalExplosionDebrisLow", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisLowSystems[1], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}else if(weaponGraphics->explosionSize <= 50){
-						PSys_SpawnCachedSystem( "LargeExplosionDebrisLow", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisLowSystems[2], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}else{
-						PSys_SpawnCachedSystem( "ExtraLargeExplosionDebrisLow", origin, tempAxis, NULL, NULL, qfalse, qfalse );
+						PSys_SpawnSystemByID( cgs.media.explosionDebrisLowSystems[3], origin, tempAxis, NULL, NULL, qfalse, qfalse );
 					}
 				}
 			}
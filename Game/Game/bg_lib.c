@@ -316,6 +316,21 @@ void *memmove(void *dest, const void *src, size_t count)
 	return dest;
 }
 
+int memcmp( const void *buf1, const void *buf2, size_t count ) {
+	const unsigned char	*p1, *p2;
+
+	p1 = buf1;
+	p2 = buf2;
+	while ( count-- ) {
+		if ( *p1 != *p2 ) {
+			return *p1 - *p2;
+		}
+		p1++;
+		p2++;
+	}
+	return 0;
+}
+
 
 #if 0
 
@@ -109,6 +109,7 @@ int sscanf( const char *buffer, const char *fmt, ... ) __attribute__ ((format (s
 void *memmove( void *dest, const void *src, size_t count );
 void *memset( void *dest, int c, size_t count );
 void *memcpy( void *dest, const void *src, size_t count );
+int memcmp( const void *buf1, const void *buf2, size_t count );
 
 // Math functions
 double ceil( double x );
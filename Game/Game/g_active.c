@@ -204,6 +204,26 @@ void	G_TouchTriggers( gentity_t *ent ) {
 	}
 }
 
+/*
+=================
+G_ProfilePmove
+
+Runs Pmove, timing it for the frame profile when g_profile is set
+=================
+*/
+static void G_ProfilePmove( pmove_t *pm ) {
+	int		startTime;
+
+	if ( !g_profile.integer ) {
+		Pmove( pm );
+		return;
+	}
+
+	startTime = trap_Milliseconds();
+	Pmove( pm );
+	level.profileMsec[PROFILE_PMOVE] += trap_Milliseconds() - startTime;
+}
+
 /*
 =================
 SpectatorThink
@@ -227,7 +247,7 @@ void SpectatorThink( gentity_t *ent, usercmd_t *ucmd ) {
 		pm.trace = trap_Trace;
 		pm.pointcontents = trap_PointContents;
 		// perform a pmove
-		Pmove (&pm);
+		G_ProfilePmove( &pm );
 		// save results of pmove
 		VectorCopy( client->ps.origin, ent->s.origin );
 		// END ADDING
@@ -442,6 +462,7 @@ void SendPendingPredictableEvents( playerState_t *ps ) {
 void LockonCheck(gclient_t *client){
 	int entityNum = -1;
 	playerState_t *ps;
+	vec3_t forward,end,lockMins,lockMaxs;
 	ps = &client->ps;
 	if(ps->lockedTarget>0){
 		if(!&g_entities[ps->lockedTarget-1].client || &g_entities[ps->lockedTarget-1].client->pers.connected == CON_DISCONNECTED){
@@ -460,7 +481,14 @@ void LockonCheck(gclient_t *client){
 				ps->lockedTarget = 0;
 				return;
 			}
+			// PM_VerifyTrace sweeps at most a 250 unit box along the view
+			AngleVectors(ps->viewangles,forward,NULL,NULL);
+			VectorMA(ps->origin,131072,forward,end);
+			VectorSet(lockMins,-250,-250,-250);
+			VectorSet(lockMaxs,250,250,250);
+			G_RewindClients(&g_entities[ps->clientNum],ps->origin,lockMins,lockMaxs,end);
 			entityNum = PM_VerifyTrace(250);
+			G_RestoreClients();
 			if(!(ps->bitFlags & usingZanzoken) && ps->lockedPlayer && ((entityNum == -1) || ps->lockedPlayer->bitFlags & usingZanzoken)){
 					ps->lockonData[lkLastLockedPlayer] = ps->lockedPlayer->clientNum;
 					ps->lockedPosition = 0;
@@ -539,7 +567,7 @@ void ClientThink_real( gentity_t *ent ) {
 	pm.pmove_fixed = pmove_fixed.integer | client->pers.pmoveFixed;
 	pm.pmove_msec = pmove_msec.integer;
 	VectorCopy(client->ps.origin,client->oldOrigin);
-	Pmove(&pm);
+	G_ProfilePmove(&pm);
 	checkTier(client);
 	if(pm.ps->powerLevel[plTierChanged] == 1)
 	{
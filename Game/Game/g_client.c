@@ -774,6 +774,9 @@ char *ClientConnect( int clientNum, qboolean firstTime ) {
 
 //	areabits = client->areabits;
 
+	// a slot whose last connection was refused never saw ClientDisconnect
+	G_FreeArena( ARENA_CLIENT( clientNum ) );
+
 	memset( client, 0, sizeof(*client) );
 
 	client->pers.connected = CON_CONNECTING;
@@ -1132,6 +1135,11 @@ void ClientDisconnect( int clientNum ) {
 
 	trap_SetConfigstring( CS_PLAYERS + clientNum, "");
 
+	// release anything allocated for this client
+	G_FreeArena( ARENA_CLIENT( clientNum ) );
+	ent->client->history = NULL;
+	ent->client->historyFrames = 0;
+
 	CalculateRanks();
 }
 
@@ -83,3 +83,45 @@ qboolean CanDamage (gentity_t *targ, vec3_t origin) {
 		return qtrue;
 	return qfalse;
 }
+
+// CanDamage results from this frame, one per target, so explosions that go
+// off close together don't trace to the same targets again
+#define DAMAGE_CACHE_DIST	8
+
+typedef struct {
+	int			time;			// level.time of the test, 0 = unused
+	vec3_t		origin;
+	vec3_t		absmin, absmax;	// where the target was
+	qboolean	visible;
+} damageCache_t;
+
+static damageCache_t	damageCache[MAX_GENTITIES];
+
+/*
+================
+G_CanDamageCached
+
+Same as CanDamage, but reuses the result of an explosion within
+DAMAGE_CACHE_DIST of origin this frame if the target hasn't moved.
+================
+*/
+qboolean G_CanDamageCached( gentity_t *targ, vec3_t origin ) {
+	damageCache_t	*c;
+	vec3_t			delta;
+
+	c = &damageCache[targ->s.number];
+	if ( c->time == level.time &&
+		VectorCompare( c->absmin, targ->r.absmin ) && VectorCompare( c->absmax, targ->r.absmax ) ) {
+		VectorSubtract( origin, c->origin, delta );
+		if ( VectorLengthSquared( delta ) <= DAMAGE_CACHE_DIST * DAMAGE_CACHE_DIST ) {
+			return c->visible;
+		}
+	}
+
+	c->time = level.time;
+	VectorCopy( origin, c->origin );
+	VectorCopy( targ->r.absmin, c->absmin );
+	VectorCopy( targ->r.absmax, c->absmax );
+	c->visible = CanDamage( targ, origin );
+	return c->visible;
+}
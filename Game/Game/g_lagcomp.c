@@ -0,0 +1,225 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Quake III Arena source code; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+//
+// g_lagcomp.c -- keeps a short history of client positions so hitscan and
+// melee traces can be run against where the shooter saw their targets
+//
+
+#include "g_local.h"
+
+/*
+================
+G_StoreClientHistory
+
+Called at the end of every server frame.
+================
+*/
+void G_StoreClientHistory( void ) {
+	int				i, j;
+	gentity_t		*ent;
+	gclient_t		*client;
+	clientHistory_t	*h;
+
+	for ( i = 0 ; i < level.maxclients ; i++ ) {
+		ent = &g_entities[i];
+		client = ent->client;
+		if ( !ent->inuse || client->pers.connected != CON_CONNECTED ||
+			client->sess.sessionTeam == TEAM_SPECTATOR ) {
+			continue;
+		}
+
+		// a teleport (or respawn) makes the old positions meaningless
+		if ( ( client->ps.eFlags ^ client->historyEFlags ) & EF_TELEPORT_BIT ) {
+			client->historyFrames = 0;
+		}
+		client->historyEFlags = client->ps.eFlags;
+
+		if ( !client->history ) {
+			client->history = G_ArenaAlloc( ARENA_CLIENT( i ), NUM_CLIENT_HISTORY * sizeof( clientHistory_t ) );
+			client->historyHead = 0;
+			client->historyFrames = 0;
+		}
+
+		if ( client->historyFrames &&
+			client->history[ ( client->historyHead - 1 ) & ( NUM_CLIENT_HISTORY - 1 ) ].time == level.time ) {
+			continue;
+		}
+
+		h = &client->history[ client->historyHead ];
+		h->time = level.time;
+		VectorCopy( ent->r.currentOrigin, h->origin );
+		for ( j = 0 ; j < 3 ; j++ ) {
+			h->mins[j] = ent->r.mins[j];
+			h->maxs[j] = ent->r.maxs[j];
+		}
+		client->historyHead = ( client->historyHead + 1 ) & ( NUM_CLIENT_HISTORY - 1 );
+		if ( client->historyFrames < NUM_CLIENT_HISTORY ) {
+			client->historyFrames++;
+		}
+	}
+}
+
+/*
+================
+G_ClientPositionAt
+
+Finds where the client was at the given time.  Returns qfalse if
+the history doesn't reach back that far or the client hasn't moved.
+================
+*/
+static qboolean G_ClientPositionAt( gclient_t *client, int time, vec3_t origin, vec3_t mins, vec3_t maxs ) {
+	clientHistory_t	*older, *newer;
+	float			frac;
+	int				i, j;
+
+	if ( !client->historyFrames ) {
+		return qfalse;
+	}
+
+	newer = &client->history[ ( client->historyHead - 1 ) & ( NUM_CLIENT_HISTORY - 1 ) ];
+	if ( time >= newer->time ) {
+		return qfalse;
+	}
+
+	for ( i = 2 ; i <= client->historyFrames ; i++ ) {
+		older = &client->history[ ( client->historyHead - i ) & ( NUM_CLIENT_HISTORY - 1 ) ];
+		if ( older->time <= time ) {
+			frac = (float)( time - older->time ) / (float)( newer->time - older->time );
+			for ( j = 0 ; j < 3 ; j++ ) {
+				origin[j] = older->origin[j] + frac * ( newer->origin[j] - older->origin[j] );
+				mins[j] = older->mins[j] + frac * ( newer->mins[j] - older->mins[j] );
+				maxs[j] = older->maxs[j] + frac * ( newer->maxs[j] - older->maxs[j] );
+			}
+			return qtrue;
+		}
+		newer = older;
+	}
+
+	// older than anything kept, use the oldest
+	VectorCopy( newer->origin, origin );
+	for ( j = 0 ; j < 3 ; j++ ) {
+		mins[j] = newer->mins[j];
+		maxs[j] = newer->maxs[j];
+	}
+	return qtrue;
+}
+
+/*
+================
+G_RewindClients
+
+Moves every other client that the trace could reach back to where it
+was when the shooter's current command was made.  All the traces of
+one attack should be run between this and G_RestoreClients.
+================
+*/
+void G_RewindClients( gentity_t *shooter, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end ) {
+	int			i, j, time;
+	gentity_t	*ent;
+	gclient_t	*client;
+	vec3_t		moveMins, moveMaxs;
+	vec3_t		origin, bmins, bmaxs;
+
+	if ( !g_lagCompensation.integer || !shooter->client ) {
+		return;
+	}
+
+	time = shooter->client->pers.cmd.serverTime;
+	if ( time >= level.time ) {
+		return;
+	}
+
+	// swept bounds of the trace
+	for ( i = 0 ; i < 3 ; i++ ) {
+		if ( end[i] > start[i] ) {
+			moveMins[i] = start[i];
+			moveMaxs[i] = end[i];
+		} else {
+			moveMins[i] = end[i];
+			moveMaxs[i] = start[i];
+		}
+		if ( mins ) {
+			moveMins[i] += mins[i];
+		}
+		if ( maxs ) {
+			moveMaxs[i] += maxs[i];
+		}
+	}
+
+	for ( i = 0 ; i < level.maxclients ; i++ ) {
+		ent = &g_entities[i];
+		client = ent->client;
+		if ( ent == shooter || !ent->inuse || !ent->r.linked || client->rewound ) {
+			continue;
+		}
+		if ( !G_ClientPositionAt( client, time, origin, bmins, bmaxs ) ) {
+			continue;
+		}
+
+		// only move the ones the trace can touch in either place
+		for ( j = 0 ; j < 3 ; j++ ) {
+			if ( ( origin[j] + bmins[j] > moveMaxs[j] || origin[j] + bmaxs[j] < moveMins[j] ) &&
+				( ent->r.absmin[j] > moveMaxs[j] || ent->r.absmax[j] < moveMins[j] ) ) {
+				break;
+			}
+		}
+		if ( j < 3 ) {
+			continue;
+		}
+
+		VectorCopy( ent->r.currentOrigin, client->rewindOrigin );
+		VectorCopy( ent->r.mins, client->rewindMins );
+		VectorCopy( ent->r.maxs, client->rewindMaxs );
+		client->rewound = qtrue;
+
+		VectorCopy( origin, ent->r.currentOrigin );
+		VectorCopy( bmins, ent->r.mins );
+		VectorCopy( bmaxs, ent->r.maxs );
+		trap_LinkEntity( ent );
+	}
+}
+
+/*
+================
+G_RestoreClients
+
+Puts back everything G_RewindClients moved.
+================
+*/
+void G_RestoreClients( void ) {
+	int			i;
+	gentity_t	*ent;
+	gclient_t	*client;
+
+	for ( i = 0 ; i < level.maxclients ; i++ ) {
+		ent = &g_entities[i];
+		client = ent->client;
+		if ( !client || !client->rewound ) {
+			continue;
+		}
+		VectorCopy( client->rewindOrigin, ent->r.currentOrigin );
+		VectorCopy( client->rewindMins, ent->r.mins );
+		VectorCopy( client->rewindMaxs, ent->r.maxs );
+		client->rewound = qfalse;
+		trap_LinkEntity( ent );
+	}
+}
@@ -40,6 +40,9 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #define INFINITE			1000000
 
 #define	FRAMETIME			100					// msec
+
+#define	EVENT_WHEEL_SLOTS	16					// must be a power of two
+#define	EVENT_WHEEL_MSEC	32					// EVENT_WHEEL_SLOTS * EVENT_WHEEL_MSEC must exceed EVENT_VALID_MSEC
 #define	CARNAGE_REWARD_TIME	3000
 #define REWARD_SPRITE_TIME	2000
 
@@ -67,6 +70,26 @@ typedef enum {
 typedef struct gentity_s gentity_t;
 typedef struct gclient_s gclient_t;
 
+// stages timed by G_RunFrame when g_profile is set
+typedef enum {
+	PROFILE_PMOVE,
+	PROFILE_MISSILES,		// user missiles and their explosions
+	PROFILE_RADAR,
+
+	PROFILE_NUM_STAGES
+} profileStage_t;
+
+// active lists walked by G_RunFrame, clients are run separately
+typedef enum {
+	ENTLIST_NONE,			// waiting on the event wheel to be freed
+	ENTLIST_MISSILE,		// ET_MISSILE and ET_BEAMHEAD
+	ENTLIST_EXPLOSION,
+	ENTLIST_MOVER,
+	ENTLIST_THINK,			// everything else
+
+	ENTLIST_NUM
+} entityList_t;
+
 struct gentity_s {
 	entityState_t	s;				// communicated by server to clients
 	entityShared_t	r;				// shared by both the server system and game
@@ -94,6 +117,14 @@ struct gentity_s {
 	int			eventTime;			// events will be cleared EVENT_VALID_MSEC after set
 	qboolean	freeAfterEvent;
 	qboolean	unlinkAfterEvent;
+	qboolean	eventQueued;		// linked on the event wheel
+	int			eventSlot;
+	gentity_t	*eventPrev;
+	gentity_t	*eventNext;
+
+	entityList_t	runList;		// active list this entity is linked on
+	gentity_t	*runPrev;
+	gentity_t	*runNext;
 
 	qboolean	physicsObject;		// if true, it can be pushed by movers and fall off edges
 									// all game items are physicsObjects, 
@@ -281,6 +312,15 @@ typedef struct {
 } clientPersistant_t;
 
 
+// one server frame of a client's position, kept for lag compensation
+#define NUM_CLIENT_HISTORY	32		// power of two
+
+typedef struct {
+	int			time;				// level.time it was stored
+	vec3_t		origin;
+	short		mins[3], maxs[3];
+} clientHistory_t;
+
 // this structure is cleared on each ClientSpawn(),
 // except for 'client->pers' and 'client->sess'
 extern struct gclient_s {
@@ -331,12 +371,23 @@ extern struct gclient_s {
 	gentity_t	*guidetarget;		// guided weapon when firing one
 	gentity_t	*playerEntity;
 	char		*modelName;
-	tierConfig_g tiers[8];
+	tierConfig_g *tiers;		// shared by all clients using the same model
 	
 	// END ADDING
 
 	int			switchTeamTime;		// time the player switched teams
 	char		*areabits;
+
+	// position history for lag compensation, NUM_CLIENT_HISTORY
+	// entries from the client's arena once it is first stored
+	clientHistory_t	*history;
+	int			historyHead;
+	int			historyFrames;
+	int			historyEFlags;
+	qboolean	rewound;			// moved back by G_RewindClients
+	vec3_t		rewindOrigin;
+	vec3_t		rewindMins;
+	vec3_t		rewindMaxs;
 };
 
 
@@ -422,6 +473,21 @@ typedef struct {
 	gentity_t	*bodyQue[BODY_QUEUE_SIZE];
 	int			lastRadarUpdateTime;	// when did the radar last update
 
+	// active entity lists, see G_SetRunList
+	gentity_t	*runListHead[ENTLIST_NUM];
+	gentity_t	*runListTail[ENTLIST_NUM];
+	gentity_t	*runNext;				// next entity G_RunFrame will visit
+
+	// non-client entities waiting for their event to expire
+	gentity_t	*eventWheel[EVENT_WHEEL_SLOTS];
+	int			eventWheelTick;			// last tick expired by G_RunEventWheel
+
+	// stage costs when g_profile is set, reported by the gameprofile command
+	int			profileFrames;
+	int			profileMsec[PROFILE_NUM_STAGES];		// accumulated during the current frame
+	int			profileTotalMsec[PROFILE_NUM_STAGES];
+	int			profileMaxMsec[PROFILE_NUM_STAGES];
+
 	#if MAPLENSFLARES	// JUHOX: level locals for the lens flare editor
 	qboolean	lfeFMM;	// FMM = fine move mode
 #endif
@@ -466,6 +532,9 @@ gentity_t *G_TempEntity( vec3_t origin, int event );
 void	G_Sound( gentity_t *ent, int channel, int soundIndex );
 void	G_FreeEntity( gentity_t *e );
 qboolean	G_EntitiesFree( void );
+void	G_SetRunList( gentity_t *ent, entityList_t list );
+void	G_ScheduleEvent( gentity_t *ent );
+void	G_RunEventWheel( void );
 
 void	G_TouchTriggers (gentity_t *ent);
 void	G_TouchSolids (gentity_t *ent);
@@ -485,6 +554,7 @@ const char *BuildShaderStateConfig( void );
 // g_combat.c
 //
 qboolean CanDamage (gentity_t *targ, vec3_t origin);
+qboolean G_CanDamageCached( gentity_t *targ, vec3_t origin );
 void G_Damage (gentity_t *targ, gentity_t *inflictor, gentity_t *attacker, vec3_t dir, vec3_t point, int damage, int dflags, int mod);
 qboolean G_RadiusDamage (vec3_t origin, gentity_t *attacker, float damage, float radius, gentity_t *ignore, int mod);
 int G_InvulnerabilityEffect( gentity_t *targ, vec3_t dir, vec3_t point, vec3_t impactpoint, vec3_t bouncedir );
@@ -600,6 +670,7 @@ void FindIntermissionPoint( void );
 void SetLeader(int team, int client);
 void CheckTeamLeader( int team );
 void G_RunThink (gentity_t *ent);
+void G_ProfileFrame( void );
 void AddTournamentQueue(gclient_t *client);
 void QDECL G_LogPrintf( const char *fmt, ... ) __attribute__ ((format (printf, 1, 2)));
 void SendScoreboardMessageToAllClients( void );
@@ -633,7 +704,18 @@ qboolean CheckObeliskAttack( gentity_t *obelisk, gentity_t *attacker );
 //
 // g_mem.c
 //
+typedef enum {
+	ARENA_LEVEL,		// until the next map or map_restart
+	ARENA_CLIENTS,		// ARENA_CLIENT( clientNum ), until the client disconnects
+
+	NUM_ARENAS = ARENA_CLIENTS + MAX_CLIENTS
+} memArena_t;
+
+#define ARENA_CLIENT(n)		( ARENA_CLIENTS + (n) )
+
 void *G_Alloc( int size );
+void *G_ArenaAlloc( int arena, int size );
+void G_FreeArena( int arena );
 void G_InitMemory( void );
 void Svcmd_GameMem_f( void );
 
@@ -679,6 +761,13 @@ qboolean G_weapPhysParser_MainParse( char *filename, int clientNum, int *weaponM
 //
 void G_RadarUpdateCS( void );
 
+//
+// g_lagcomp.c
+//
+void G_StoreClientHistory( void );
+void G_RewindClients( gentity_t *shooter, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end );
+void G_RestoreClients( void );
+
 //
 // g_weapPhysParser.c
 //
@@ -720,6 +809,8 @@ extern	vmCvar_t	g_forcerespawn;
 extern	vmCvar_t	g_inactivity;
 extern	vmCvar_t	g_debugMove;
 extern	vmCvar_t	g_debugAlloc;
+extern	vmCvar_t	g_profile;
+extern	vmCvar_t	g_lagCompensation;
 extern	vmCvar_t	g_debugDamage;
 extern	vmCvar_t	g_synchronousClients;
 extern	vmCvar_t	g_motd;
@@ -60,6 +60,8 @@ vmCvar_t	g_inactivity;
 vmCvar_t	g_debugMove;
 vmCvar_t	g_debugDamage;
 vmCvar_t	g_debugAlloc;
+vmCvar_t	g_profile;
+vmCvar_t	g_lagCompensation;
 vmCvar_t	g_weaponRespawn;
 vmCvar_t	g_weaponTeamRespawn;
 vmCvar_t	g_motd;
@@ -156,6 +158,8 @@ static cvarTable_t		gameCvarTable[] = {
 	{ &g_debugMove, "g_debugMove", "0", 0, 0, qfalse },
 	{ &g_debugDamage, "g_debugDamage", "0", 0, 0, qfalse },
 	{ &g_debugAlloc, "g_debugAlloc", "0", 0, 0, qfalse },
+	{ &g_profile, "g_profile", "0", 0, 0, qfalse },
+	{ &g_lagCompensation, "g_lagCompensation", "1", CVAR_ARCHIVE, 0, qfalse },
 	{ &g_motd, "g_motd", "", 0, 0, qfalse },
 	{ &g_blood, "com_blood", "1", 0, 0, qfalse },
 
@@ -1460,6 +1464,27 @@ void G_RunThink (gentity_t *ent) {
 	ent->think (ent);
 }
 
+/*
+================
+G_ProfileFrame
+
+Adds the stage costs of the frame that just ran to the totals.
+Pmove time is whatever ClientThink accumulated since the last frame.
+================
+*/
+void G_ProfileFrame( void ) {
+	int		i;
+
+	for ( i = 0 ; i < PROFILE_NUM_STAGES ; i++ ) {
+		level.profileTotalMsec[i] += level.profileMsec[i];
+		if ( level.profileMsec[i] > level.profileMaxMsec[i] ) {
+			level.profileMaxMsec[i] = level.profileMsec[i];
+		}
+		level.profileMsec[i] = 0;
+	}
+	level.profileFrames++;
+}
+
 /*
 ================
 G_RunFrame
@@ -1469,6 +1494,8 @@ Advances the non-player objects in the world
 */
 void G_RunFrame( int levelTime ) {
 	int			i;
+	int			list;
+	int			startTime;
 	gentity_t	*ent;
 
 	// if we are waiting for the level to restart, do nothing
@@ -1483,11 +1510,14 @@ void G_RunFrame( int levelTime ) {
 	// get any cvar changes
 	G_UpdateCvars();
 
+	// clear events that are too old on non-client entities
+	G_RunEventWheel();
+
 	//
-	// go through all allocated objects
+	// go through the clients
 	//
 	ent = &g_entities[0];
-	for (i=0 ; i<level.num_entities ; i++, ent++) {
+	for (i=0 ; i < level.maxclients ; i++, ent++) {
 		if ( !ent->inuse ) {
 			continue;
 		}
@@ -1503,42 +1533,92 @@ void G_RunFrame( int levelTime ) {
 					//ent->client->ps.events[1] = 0;
 				}
 			}
-			if ( ent->freeAfterEvent ) {
-				G_FreeEntity( ent );
-				continue;
-			} else if ( ent->unlinkAfterEvent ) {
+			if ( ent->unlinkAfterEvent ) {
 				ent->unlinkAfterEvent = qfalse;
 				trap_UnlinkEntity( ent );
 			}
 		}
-		if ( ent->freeAfterEvent ) {
-			continue;
-		}
 		if ( !ent->r.linked && ent->neverFree ) {
 			continue;
 		}
-		if ( ent->s.eType == ET_MISSILE ) {
-			G_RunUserMissile( ent );
-			continue;
-		}
-		if ( ent->s.eType == ET_EXPLOSION ) {
-			G_RunUserExplosion( ent );
-			continue;
-		}
-		if ( ent->s.eType == ET_BEAMHEAD ) {
-			G_RunUserMissile( ent );
-		}
-		if ( ent->s.eType == ET_MOVER ) {
-			G_RunMover( ent );
-			continue;
-		}
+		G_RunClient( ent );
+	}
 
-		if ( i < MAX_CLIENTS ) {
-			G_RunClient( ent );
-			continue;
+	//
+	// go through the active lists of everything else
+	//
+	for ( list = ENTLIST_MISSILE ; list < ENTLIST_NUM ; list++ ) {
+		startTime = g_profile.integer ? trap_Milliseconds() : 0;
+		for ( ent = level.runListHead[list] ; ent ; ent = level.runNext ) {
+			// G_SetRunList and G_FreeEntity step this past anything
+			// taken off the list while ent is being run
+			level.runNext = ent->runNext;
+
+			if ( ent->freeAfterEvent ) {
+				if ( level.time - ent->eventTime > EVENT_VALID_MSEC ) {
+					G_FreeEntity( ent );
+				} else {
+					// park it on the event wheel until the event has gone out
+					G_SetRunList( ent, ENTLIST_NONE );
+					G_ScheduleEvent( ent );
+				}
+				continue;
+			}
+			if ( !ent->r.linked && ent->neverFree ) {
+				continue;
+			}
+
+			// an entity that belongs on a list walked later is run there,
+			// one whose list is already done (new entities start out on
+			// ENTLIST_THINK) is moved and run right away
+			switch ( ent->s.eType ) {
+			case ET_MISSILE:
+			case ET_BEAMHEAD:
+				if ( list != ENTLIST_MISSILE ) {
+					G_SetRunList( ent, ENTLIST_MISSILE );
+					if ( list < ENTLIST_MISSILE ) {
+						continue;
+					}
+				}
+				G_RunUserMissile( ent );
+				if ( ent->s.eType == ET_BEAMHEAD ) {
+					G_RunThink( ent );
+				}
+				break;
+			case ET_EXPLOSION:
+				if ( list != ENTLIST_EXPLOSION ) {
+					G_SetRunList( ent, ENTLIST_EXPLOSION );
+					if ( list < ENTLIST_EXPLOSION ) {
+						continue;
+					}
+				}
+				G_RunUserExplosion( ent );
+				break;
+			case ET_MOVER:
+				if ( list != ENTLIST_MOVER ) {
+					G_SetRunList( ent, ENTLIST_MOVER );
+					if ( list < ENTLIST_MOVER ) {
+						continue;
+					}
+				}
+				G_RunMover( ent );
+				break;
+			default:
+				if ( list != ENTLIST_THINK ) {
+					G_SetRunList( ent, ENTLIST_THINK );
+					if ( list < ENTLIST_THINK ) {
+						continue;
+					}
+				}
+				G_RunThink( ent );
+				break;
+			}
 		}
+		level.runNext = NULL;
 
-		G_RunThink( ent );
+		if ( g_profile.integer && ( list == ENTLIST_MISSILE || list == ENTLIST_EXPLOSION ) ) {
+			level.profileMsec[PROFILE_MISSILES] += trap_Milliseconds() - startTime;
+		}
 	}
 
 	// perform final fixups on the players
@@ -1548,7 +1628,13 @@ void G_RunFrame( int levelTime ) {
 			ClientEndFrame( ent );
 		}
 	}
+	G_StoreClientHistory();
+	startTime = g_profile.integer ? trap_Milliseconds() : 0;
 	G_RadarUpdateCS();
+	if ( g_profile.integer ) {
+		level.profileMsec[PROFILE_RADAR] += trap_Milliseconds() - startTime;
+		G_ProfileFrame();
+	}
 
 	// see if it is time to do a tournement restart
 	CheckTournament();
@@ -30,32 +30,206 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #define POOLSIZE	(256 * 1024)
 
-static char		memoryPool[POOLSIZE];
-static int		allocPoint;
+// the pool is handed out to arenas in blocks, so an arena that ends
+// returns its blocks for the others to use
+#define MEM_BLOCK_SIZE		1024
+#define NUM_MEM_BLOCKS		(POOLSIZE / MEM_BLOCK_SIZE)
+#define MEM_ALIGN			16
+
+typedef struct {
+	int				firstBlock;		// -1 when the arena owns nothing
+	int				runBlock;		// start of the run being filled
+	int				runOffset;		// bytes used in that run
+	int				runSize;
+
+	int				numBlocks;
+	int				peakBlocks;
+	int				bytes;			// allocated bytes, after rounding
+	int				allocs;
+	int				resets;
+} memArenaInfo_t;
+
+static char				memoryPool[POOLSIZE];
+static int				blockArena[NUM_MEM_BLOCKS];		// -1 = free
+static int				blockNext[NUM_MEM_BLOCKS];		// next block of the same arena
+static memArenaInfo_t	arenas[NUM_ARENAS];
+static int				numFreeBlocks;
 
-void *G_Alloc( int size ) {
-	char	*p;
+/*
+================
+G_ArenaName
+================
+*/
+static const char *G_ArenaName( int arena ) {
+	if ( arena == ARENA_LEVEL ) {
+		return "level";
+	}
+	return va( "client %i", arena - ARENA_CLIENTS );
+}
 
-	if ( g_debugAlloc.integer ) {
-		G_Printf( "G_Alloc of %i bytes (%i left)\n", size, POOLSIZE - allocPoint - ( ( size + 31 ) & ~31 ) );
+/*
+================
+G_AllocBlocks
+
+Finds a run of free blocks for the arena and links it in.
+================
+*/
+static int G_AllocBlocks( int arena, int count ) {
+	memArenaInfo_t	*a;
+	int				i, start;
+
+	start = 0;
+	for ( i = 0 ; i < NUM_MEM_BLOCKS ; i++ ) {
+		if ( blockArena[i] != -1 ) {
+			start = i + 1;
+			continue;
+		}
+		if ( i - start + 1 == count ) {
+			break;
+		}
+	}
+	if ( i == NUM_MEM_BLOCKS ) {
+		return -1;
+	}
+
+	a = &arenas[arena];
+	for ( i = start ; i < start + count ; i++ ) {
+		blockArena[i] = arena;
+		blockNext[i] = a->firstBlock;
+		a->firstBlock = i;
 	}
+	numFreeBlocks -= count;
+	a->numBlocks += count;
+	if ( a->numBlocks > a->peakBlocks ) {
+		a->peakBlocks = a->numBlocks;
+	}
+	return start;
+}
+
+/*
+================
+G_ArenaAlloc
+
+Allocations can not be freed one at a time, everything
+goes away together with G_FreeArena.
+================
+*/
+void *G_ArenaAlloc( int arena, int size ) {
+	memArenaInfo_t	*a;
+	int				count, block;
+	char			*p;
 
-	if ( allocPoint + size > POOLSIZE ) {
-	  G_Error( "G_Alloc: failed on allocation of %i bytes\n", size );
+	if ( arena < 0 || arena >= NUM_ARENAS ) {
+		G_Error( "G_ArenaAlloc: bad arena %i\n", arena );
 		return NULL;
 	}
+	a = &arenas[arena];
+
+	size = ( size + MEM_ALIGN - 1 ) & ~( MEM_ALIGN - 1 );
+
+	if ( g_debugAlloc.integer ) {
+		G_Printf( "G_ArenaAlloc of %i bytes from %s (%i blocks free)\n", size, G_ArenaName( arena ), numFreeBlocks );
+	}
+
+	if ( a->runOffset + size > a->runSize ) {
+		count = ( size + MEM_BLOCK_SIZE - 1 ) / MEM_BLOCK_SIZE;
+		block = G_AllocBlocks( arena, count );
+		if ( block < 0 ) {
+			G_Error( "G_Alloc: failed on allocation of %i bytes from %s\n", size, G_ArenaName( arena ) );
+			return NULL;
+		}
+		a->runBlock = block;
+		a->runOffset = 0;
+		a->runSize = count * MEM_BLOCK_SIZE;
+	}
 
-	p = &memoryPool[allocPoint];
+	p = &memoryPool[a->runBlock * MEM_BLOCK_SIZE + a->runOffset];
+	a->runOffset += size;
 
-	allocPoint += ( size + 31 ) & ~31;
+	a->allocs++;
+	a->bytes += size;
 
 	return p;
 }
 
+/*
+================
+G_FreeArena
+
+Returns all of the arena's blocks to the pool.
+================
+*/
+void G_FreeArena( int arena ) {
+	memArenaInfo_t	*a;
+	int				block, next;
+
+	a = &arenas[arena];
+	if ( a->firstBlock != -1 ) {
+		a->resets++;
+	}
+	for ( block = a->firstBlock ; block != -1 ; block = next ) {
+		next = blockNext[block];
+		blockArena[block] = -1;
+		blockNext[block] = -1;
+		numFreeBlocks++;
+	}
+
+	a->firstBlock = -1;
+	a->runBlock = 0;
+	a->runOffset = 0;
+	a->runSize = 0;
+	a->numBlocks = 0;
+	a->bytes = 0;
+}
+
+/*
+================
+G_Alloc
+
+Level lifetime allocation.
+================
+*/
+void *G_Alloc( int size ) {
+	return G_ArenaAlloc( ARENA_LEVEL, size );
+}
+
+/*
+================
+G_InitMemory
+================
+*/
 void G_InitMemory( void ) {
-	allocPoint = 0;
+	int		i;
+
+	memset( arenas, 0, sizeof( arenas ) );
+	for ( i = 0 ; i < NUM_ARENAS ; i++ ) {
+		arenas[i].firstBlock = -1;
+	}
+	for ( i = 0 ; i < NUM_MEM_BLOCKS ; i++ ) {
+		blockArena[i] = -1;
+		blockNext[i] = -1;
+	}
+	numFreeBlocks = NUM_MEM_BLOCKS;
 }
 
+/*
+================
+Svcmd_GameMem_f
+================
+*/
 void Svcmd_GameMem_f( void ) {
-	G_Printf( "Game memory status: %i out of %i bytes allocated\n", allocPoint, POOLSIZE );
+	memArenaInfo_t	*a;
+	int				i;
+
+	G_Printf( "Game memory status: %i out of %i bytes allocated\n",
+		( NUM_MEM_BLOCKS - numFreeBlocks ) * MEM_BLOCK_SIZE, POOLSIZE );
+	G_Printf( "arena       blocks   peak      bytes  allocs  resets\n" );
+	for ( i = 0 ; i < NUM_ARENAS ; i++ ) {
+		a = &arenas[i];
+		if ( !a->peakBlocks && !a->resets ) {
+			continue;
+		}
+		G_Printf( "%-10s  %6i %6i %10i %7i %7i\n", G_ArenaName( i ),
+			a->numBlocks, a->peakBlocks, a->bytes, a->allocs, a->resets );
+	}
 }
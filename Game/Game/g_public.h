@@ -46,6 +46,8 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #define SVF_CAPSULE				0x00000200	// use capsule for collision detection instead of bbox
 #define SVF_NOTSINGLECLIENT		0x00000400	// send entity to everyone but one client
 											// (entityShared_t->singleClient)
+#define SVF_RELEVANT			0x00000800	// always send the current state, never
+											// slow down its updates for distant viewers
 
 
 
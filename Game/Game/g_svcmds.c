@@ -392,6 +392,39 @@ void	Svcmd_EntityList_f (void) {
 	}
 }
 
+/*
+===================
+Svcmd_GameProfile_f
+
+Prints the per frame stage costs gathered while g_profile is set
+and starts counting again
+===================
+*/
+void	Svcmd_GameProfile_f (void) {
+	static const char	*stageNames[PROFILE_NUM_STAGES] = {
+		"pmove",
+		"missiles",
+		"radar"
+	};
+	int		i;
+
+	if ( !level.profileFrames ) {
+		G_Printf( "No frames profiled, set g_profile 1 first.\n" );
+		return;
+	}
+
+	G_Printf( "%i frames profiled\n", level.profileFrames );
+	G_Printf( "stage        mean msec   max msec\n" );
+	for ( i = 0 ; i < PROFILE_NUM_STAGES ; i++ ) {
+		G_Printf( "%-10s %11.3f %10i\n", stageNames[i],
+			(float)level.profileTotalMsec[i] / level.profileFrames, level.profileMaxMsec[i] );
+	}
+
+	level.profileFrames = 0;
+	memset( level.profileTotalMsec, 0, sizeof( level.profileTotalMsec ) );
+	memset( level.profileMaxMsec, 0, sizeof( level.profileMaxMsec ) );
+}
+
 gclient_t	*ClientForString( const char *s ) {
 	gclient_t	*cl;
 	int			i;
@@ -472,6 +505,11 @@ qboolean	ConsoleCommand( void ) {
 		Svcmd_ForceTeam_f();
 		return qtrue;
 	}
+	if (Q_stricmp (cmd, "gameprofile") == 0) {
+		Svcmd_GameProfile_f();
+		return qtrue;
+	}
+
 	if (Q_stricmp (cmd, "game_memory") == 0) {
 		Svcmd_GameMem_f();
 		return qtrue;
@@ -160,8 +160,7 @@ qboolean checkDefaultTierConfiguration(playerState_t *ps){
 }
 
 void checkTier(gclient_t *client){
-	int trigger;
-	int tier = 1;
+	int tier;
 	int tierUp = -1;
 	int tierDown = -1;
 	int desiredTier = -1;
@@ -169,12 +168,12 @@ void checkTier(gclient_t *client){
 	playerState_t *ps;
 	ps = &client->ps;
 	if(ps->timers[tmTransform]){return;}
-	while(client->tiers[tier].exists){
-		if(client->tiers[tier].requirementUseSkill && (ps->weapon == client->tiers[tier].requirementUseSkill)){
-			trigger = tier;
-			break;
-		}
-		++tier;
+	// tier requirements are only tested when the player asks for a change,
+	// so there is nothing to do until a key, a selection or a pending
+	// transition shows up
+	if(!ps->powerLevel[plTierChanged] && !ps->stats[stTransformState] && !ps->powerLevel[plTierSelectionMode] &&
+	   !(ps->bitFlags & (keyTierUp | keyTierDown))){
+		return;
 	}
 
 	desiredTier = ps->powerLevel[plTierDesired];
@@ -214,20 +213,62 @@ void checkTier(gclient_t *client){
 	ps->powerLevel[plTierSelectionMode]=0;
 }
 
-void setupTiers(gclient_t *client){
-	int	i;
+/*
+================
+findCharacterTiers
+
+Tier configs are parsed once per character and shared by every client
+using it.  An entry is only replaced once no client points at it, and
+there is one more entry than there are clients, so one is always free.
+================
+*/
+#define MAX_CHARACTER_TIERS (MAX_CLIENTS + 1)
+typedef struct{
+	char modelName[MAX_QPATH];
+	tierConfig_g tiers[8];
+}characterTiers_t;
+static characterTiers_t characterTiers[MAX_CHARACTER_TIERS];
+static int numCharacterTiers;
+static tierConfig_g *findCharacterTiers(gclient_t *client){
+	int i,j;
+	characterTiers_t *entry;
 	tierConfig_g *tier;
-	char *modelName;
 	char *tierPath;
-	char tempPath[MAX_QPATH];
-	modelName = client->modelName;
+	for(i=0;i<numCharacterTiers;i++){
+		if(!Q_stricmp(characterTiers[i].modelName,client->modelName)){
+			return characterTiers[i].tiers;
+		}
+	}
+	if(numCharacterTiers < MAX_CHARACTER_TIERS){
+		entry = &characterTiers[numCharacterTiers++];
+	}
+	else{
+		entry = NULL;
+		for(i=0;i<MAX_CHARACTER_TIERS && !entry;i++){
+			entry = &characterTiers[i];
+			for(j=0;j<level.maxclients;j++){
+				if(level.clients[j].tiers == entry->tiers && &level.clients[j] != client){
+					entry = NULL;
+					break;
+				}
+			}
+		}
+		if(!entry){
+			G_Error("findCharacterTiers: no free entry for %s\n",client->modelName);
+		}
+	}
+	Q_strncpyz(entry->modelName,client->modelName,sizeof(entry->modelName));
 	for(i=0;i<8;i++){
-		tier = &client->tiers[i];
+		tier = &entry->tiers[i];
 		memset(tier,0,sizeof(tierConfig_g));
-		tierPath = va("players/%s/tier%i/",modelName,i+1);
+		tierPath = va("players/%s/tier%i/",entry->modelName,i+1);
 		parseTier("players/tierDefault.cfg",tier);
 		parseTier(strcat(tierPath,"tier.cfg"),tier);
 	}
+	return entry->tiers;
+}
+void setupTiers(gclient_t *client){
+	client->tiers = findCharacterTiers(client);
 	syncTier(client);
 }
 void parseTier(char *path,tierConfig_g *tier){
@@ -500,6 +500,8 @@ G_UserRadiusDamage
 qboolean G_UserRadiusDamage ( vec3_t origin, gentity_t *attacker, gentity_t *ignore, float centerDamage, float radius,int extraKnockback ) {
 	int			entityList[MAX_GENTITIES];
 	int			numListedEntities;
+	gentity_t	*targets[MAX_GENTITIES];
+	int			numTargets;
 	
 	float		realDamage, distance;
 	gentity_t	*ent;
@@ -522,6 +524,9 @@ qboolean G_UserRadiusDamage ( vec3_t origin, gentity_t *attacker, gentity_t *ign
 
 	numListedEntities = trap_EntitiesInBox( mins, maxs, entityList, MAX_GENTITIES );
 
+	// gather everything in range first, so the visibility traces
+	// all run before any damage is dealt
+	numTargets = 0;
 	for ( e = 0 ; e < numListedEntities ; e++ ) {
 		ent = &g_entities[entityList[ e ]];
 
@@ -549,21 +554,26 @@ qboolean G_UserRadiusDamage ( vec3_t origin, gentity_t *attacker, gentity_t *ign
 			continue;
 		}
 
-		realDamage = centerDamage /** ( 1.0 - distance / radius )*/;
-
-		if(CanDamage(ent, origin)){
-			VectorSubtract (ent->r.currentOrigin, origin, dir);
-			// push the center of mass higher than the origin so players
-			// get knocked into the air more
-			dir[2] += 24;
-			G_LocationImpact(origin,ent,attacker);
-			if(ent->client){
-				ent->client->ps.powerLevel[plDamageGeneric] += realDamage;
-				if(ent->pain){ent->pain(ent,attacker,realDamage);}
-				/*if(ent->client->lasthurt_location == LOCATION_FRONT){
-					ent->client->ps.timers[tmBlind] = 10000;
-				}*/
-			}
+		if ( G_CanDamageCached( ent, origin ) ) {
+			targets[numTargets++] = ent;
+		}
+	}
+
+	realDamage = centerDamage /** ( 1.0 - distance / radius )*/;
+
+	for ( e = 0 ; e < numTargets ; e++ ) {
+		ent = targets[e];
+		VectorSubtract (ent->r.currentOrigin, origin, dir);
+		// push the center of mass higher than the origin so players
+		// get knocked into the air more
+		dir[2] += 24;
+		G_LocationImpact(origin,ent,attacker);
+		if(ent->client){
+			ent->client->ps.powerLevel[plDamageGeneric] += realDamage;
+			if(ent->pain){ent->pain(ent,attacker,realDamage);}
+			/*if(ent->client->lasthurt_location == LOCATION_FRONT){
+				ent->client->ps.timers[tmBlind] = 10000;
+			}*/
 		}
 	}
 	return hitClient;
@@ -592,7 +602,9 @@ void UserHitscan_Fire (gentity_t *self, g_userWeapon_t *weaponInfo, int weaponNu
 	// Note; if bounce is enabled, this will let the projectile bounce a max. of 10 times
 	for (i = 0; i < 10; i++) {
 
+		G_RewindClients( self, muzzle, NULL, NULL, end );
 		trap_Trace (&tr, muzzle, NULL, NULL, end, passent, MASK_SHOT);
+		G_RestoreClients();
 		traceEnt = &g_entities[ tr.entityNum ];
 		// snap the endpos to integers, but nudged towards the line
 		SnapVectorTowards( tr.endpos, muzzle );
@@ -935,7 +947,7 @@ void Fire_UserWeapon( gentity_t *self, vec3_t start, vec3_t dir, qboolean altfir
 		bolt = G_Spawn();
 		bolt->classname = "user_beam";
 		bolt->s.eType = ET_BEAMHEAD;
-		bolt->r.svFlags = SVF_USE_CURRENT_ORIGIN;
+		bolt->r.svFlags = SVF_USE_CURRENT_ORIGIN | SVF_RELEVANT;
 		bolt->startTimer = level.time + 800;
 		// Set the weapon number correct, depending on altfire status.
 		if ( !altfire ) {
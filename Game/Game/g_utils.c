@@ -369,6 +369,10 @@ void G_InitGentity( gentity_t *e ) {
 	e->classname = "noclass";
 	e->s.number = e - g_entities;
 	e->r.ownerNum = ENTITYNUM_NONE;
+
+	if ( e->s.number >= MAX_CLIENTS ) {
+		G_SetRunList( e, ENTLIST_THINK );
+	}
 }
 
 /*
@@ -468,12 +472,149 @@ void G_FreeEntity( gentity_t *ed ) {
 		return;
 	}
 
+	// take it off the active lists before the links are cleared
+	G_SetRunList( ed, ENTLIST_NONE );
+	if ( ed->eventQueued ) {
+		if ( ed->eventPrev ) {
+			ed->eventPrev->eventNext = ed->eventNext;
+		} else {
+			level.eventWheel[ed->eventSlot] = ed->eventNext;
+		}
+		if ( ed->eventNext ) {
+			ed->eventNext->eventPrev = ed->eventPrev;
+		}
+	}
+
 	memset (ed, 0, sizeof(*ed));
 	ed->classname = "freed";
 	ed->freetime = level.time;
 	ed->inuse = qfalse;
 }
 
+/*
+=================
+G_SetRunList
+
+Moves the entity to the tail of an active list, so an entity
+that changes type during G_RunFrame can still be run in the
+same frame if its new list hasn't been walked yet
+=================
+*/
+void G_SetRunList( gentity_t *ent, entityList_t list ) {
+	if ( ent->runList != ENTLIST_NONE ) {
+		if ( level.runNext == ent ) {
+			level.runNext = ent->runNext;
+		}
+		if ( ent->runPrev ) {
+			ent->runPrev->runNext = ent->runNext;
+		} else {
+			level.runListHead[ent->runList] = ent->runNext;
+		}
+		if ( ent->runNext ) {
+			ent->runNext->runPrev = ent->runPrev;
+		} else {
+			level.runListTail[ent->runList] = ent->runPrev;
+		}
+		ent->runPrev = ent->runNext = NULL;
+	}
+
+	ent->runList = list;
+	if ( list == ENTLIST_NONE ) {
+		return;
+	}
+
+	ent->runPrev = level.runListTail[list];
+	if ( ent->runPrev ) {
+		ent->runPrev->runNext = ent;
+	} else {
+		level.runListHead[list] = ent;
+	}
+	level.runListTail[list] = ent;
+}
+
+/*
+=================
+G_ScheduleEvent
+
+Puts the entity on the event wheel so G_RunEventWheel clears its
+event once it is older than EVENT_VALID_MSEC.  An entity that is
+already queued stays where it is; if its eventTime has moved on
+when the slot comes up it is simply queued again.
+Clients are checked every frame and never go on the wheel.
+=================
+*/
+void G_ScheduleEvent( gentity_t *ent ) {
+	int		tick;
+
+	if ( ent->s.number < MAX_CLIENTS || ent->eventQueued ) {
+		return;
+	}
+
+	// first tick at which level.time - eventTime > EVENT_VALID_MSEC
+	tick = ( ent->eventTime + EVENT_VALID_MSEC + EVENT_WHEEL_MSEC ) / EVENT_WHEEL_MSEC;
+	if ( tick <= level.eventWheelTick ) {
+		tick = level.eventWheelTick + 1;
+	}
+
+	ent->eventQueued = qtrue;
+	ent->eventSlot = tick & ( EVENT_WHEEL_SLOTS - 1 );
+	ent->eventPrev = NULL;
+	ent->eventNext = level.eventWheel[ent->eventSlot];
+	if ( ent->eventNext ) {
+		ent->eventNext->eventPrev = ent;
+	}
+	level.eventWheel[ent->eventSlot] = ent;
+}
+
+/*
+=================
+G_RunEventWheel
+
+Clears the events of every queued entity whose slot has come up,
+freeing or unlinking it if it asked for that
+=================
+*/
+void G_RunEventWheel( void ) {
+	int			tick, slot;
+	gentity_t	*ent, *next;
+
+	tick = level.time / EVENT_WHEEL_MSEC;
+	if ( tick - level.eventWheelTick > EVENT_WHEEL_SLOTS ) {
+		level.eventWheelTick = tick - EVENT_WHEEL_SLOTS;
+	}
+
+	while ( level.eventWheelTick < tick ) {
+		level.eventWheelTick++;
+		slot = level.eventWheelTick & ( EVENT_WHEEL_SLOTS - 1 );
+
+		// detach the slot so anything queued again goes round once more
+		ent = level.eventWheel[slot];
+		level.eventWheel[slot] = NULL;
+
+		for ( ; ent ; ent = next ) {
+			next = ent->eventNext;
+			ent->eventQueued = qfalse;
+			ent->eventPrev = ent->eventNext = NULL;
+
+			if ( !ent->inuse ) {
+				continue;
+			}
+			if ( level.time - ent->eventTime <= EVENT_VALID_MSEC ) {
+				G_ScheduleEvent( ent );
+				continue;
+			}
+
+			ent->s.event = 0;
+			if ( ent->freeAfterEvent ) {
+				G_FreeEntity( ent );
+			} else if ( ent->unlinkAfterEvent ) {
+				ent->unlinkAfterEvent = qfalse;
+				trap_UnlinkEntity( ent );
+			}
+		}
+	}
+}
+
 /*
 =================
 G_TempEntity
@@ -493,6 +634,8 @@ gentity_t *G_TempEntity( vec3_t origin, int event ) {
 	e->classname = "tempEntity";
 	e->eventTime = level.time;
 	e->freeAfterEvent = qtrue;
+	G_SetRunList( e, ENTLIST_NONE );
+	G_ScheduleEvent( e );
 
 	VectorCopy( origin, snapped );
 	SnapVector( snapped );		// save network bandwidth
@@ -572,6 +715,7 @@ void G_AddEvent( gentity_t *ent, int event, int eventParm ) {
 		ent->s.eventParm = eventParm;
 	}
 	ent->eventTime = level.time;
+	G_ScheduleEvent( ent );
 }
 
 
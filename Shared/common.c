@@ -32,7 +32,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #endif
 
 int demo_protocols[] =
-{ 67, 66, 0 };
+{ 71, 67, 66, 0 };
 
 #define MAX_NUM_ARGVS	50
 
@@ -2912,7 +2912,9 @@ void Com_Frame( void ) {
   
 
 	if ( setjmp (abortframe) ) {
-		return;			// an ERR_DROP was thrown
+		// an ERR_DROP was thrown, possibly with packets still batched
+		NET_ResetSendBatch();
+		return;
 	}
 
 	timeBeforeFirstEvents =0;
@@ -1252,13 +1252,271 @@ netField_t	playerStateFields[] =
 { PSF(attackPower), 32 },
 };
 
+/*
+============================================================================
+
+packed playerState arrays
+
+The integer arrays of the playerState hold power levels, timers and lock-on
+data that change by small amounts nearly every frame.  From protocol
+PROTOCOL_PACKED_PLAYERSTATE on, a changed entry is sent as a signed delta
+against the delta base in the narrowest width it fits, and timers that only
+counted toward zero by the elapsed command time are not sent at all.
+
+Values keep going through shorts like the old encoding, so both encodings
+decode to the same playerState.
+============================================================================
+*/
+
+typedef struct {
+	char	*name;
+	int		offset;
+	int		count;
+	qboolean	timer;		// counts toward zero by the command time
+} psArrayField_t;
+
+#define	PSA(x) #x,(size_t)&((playerState_t*)0)->x,ARRAY_LEN(((playerState_t*)0)->x)
+
+static psArrayField_t	playerStateArrays[] = 
+{
+{ PSA(stats), qfalse },
+{ PSA(lockonData), qfalse },
+{ PSA(persistant), qfalse },
+{ PSA(currentSkill), qfalse },
+{ PSA(powerups), qfalse },
+{ PSA(timers), qtrue },
+{ PSA(cooldownTimers), qtrue },
+{ PSA(sequenceTimers), qtrue },
+{ PSA(measureTimers), qtrue },
+{ PSA(powerLevel), qfalse },
+};
+
+#define	PS_DELTA_CLASS_BITS		2
+#define	PS_DELTA_CLASSES		4		// the last one sends the full short
+
+static const int psDeltaBits[PS_DELTA_CLASSES - 1] = { 4, 8, 12 };
+
+// how often each delta width was picked, for MSG_ReportPlayerstateBenchmark
+static int	psDeltaCounts[ARRAY_LEN( playerStateArrays )][PS_DELTA_CLASSES];
+static int	psDeltaSkipped[ARRAY_LEN( playerStateArrays )];
+
+/*
+=============
+MSG_PlayerstateExpected
+
+The value an entry will have if nothing but time touched it.
+=============
+*/
+static int MSG_PlayerstateExpected( psArrayField_t *field, int from, int msec ) {
+	from = (short)from;
+	if ( !field->timer || msec <= 0 ) {
+		return from;
+	}
+	if ( from > 0 ) {
+		return from > msec ? from - msec : 0;
+	}
+	if ( from < 0 ) {
+		return from < -msec ? from + msec : 0;
+	}
+	return 0;
+}
+
+/*
+=============
+MSG_WritePackedPlayerstate
+=============
+*/
+static void MSG_WritePackedPlayerstate( msg_t *msg, playerState_t *from, playerState_t *to ) {
+	int				i, j, c;
+	int				msec;
+	int				bits[ARRAY_LEN( playerStateArrays )];
+	int				basestatsbits, bufferbits;
+	int				*fromF, *toF;
+	int				expected, delta;
+	psArrayField_t	*field;
+	qboolean		changed;
+
+	msec = to->commandTime - from->commandTime;
+
+	changed = qfalse;
+	for ( i = 0, field = playerStateArrays ; i < ARRAY_LEN( playerStateArrays ) ; i++, field++ ) {
+		fromF = (int *)( (byte *)from + field->offset );
+		toF = (int *)( (byte *)to + field->offset );
+		bits[i] = 0;
+		for ( j = 0 ; j < field->count ; j++ ) {
+			expected = MSG_PlayerstateExpected( field, fromF[j], msec );
+			if ( (short)toF[j] != expected ) {
+				bits[i] |= 1<<j;
+			} else if ( fromF[j] != toF[j] ) {
+				psDeltaSkipped[i]++;
+			}
+		}
+		if ( bits[i] ) {
+			changed = qtrue;
+		}
+	}
+
+	basestatsbits = 0;
+	for (i=0 ; i<MAX_BASESTATS ; i++) {
+		if (to->baseStats[i] != from->baseStats[i]) {
+			basestatsbits |= 1<<i;
+		}
+	}
+
+	bufferbits = 0;
+	for (i=0 ; i<MAX_RBUFFERS ; i++) {
+		if (to->buffers[i] != from->buffers[i]) {
+			bufferbits |= 1<<i;
+		}
+	}
+
+	if ( !changed && !basestatsbits && !bufferbits ) {
+		MSG_WriteBits( msg, 0, 1 );	// no change
+		return;
+	}
+	MSG_WriteBits( msg, 1, 1 );	// changed
+
+	for ( i = 0, field = playerStateArrays ; i < ARRAY_LEN( playerStateArrays ) ; i++, field++ ) {
+		if ( !bits[i] ) {
+			MSG_WriteBits( msg, 0, 1 );	// no change
+			continue;
+		}
+		MSG_WriteBits( msg, 1, 1 );	// changed
+		MSG_WriteBits( msg, bits[i], field->count );
+
+		fromF = (int *)( (byte *)from + field->offset );
+		toF = (int *)( (byte *)to + field->offset );
+		for ( j = 0 ; j < field->count ; j++ ) {
+			if ( !( bits[i] & ( 1<<j ) ) ) {
+				continue;
+			}
+
+			// pick the narrowest delta that holds the change
+			delta = (short)toF[j] - MSG_PlayerstateExpected( field, fromF[j], msec );
+			for ( c = 0 ; c < PS_DELTA_CLASSES - 1 ; c++ ) {
+				if ( delta >= -( 1 << ( psDeltaBits[c] - 1 ) ) && delta < ( 1 << ( psDeltaBits[c] - 1 ) ) ) {
+					break;
+				}
+			}
+			psDeltaCounts[i][c]++;
+
+			MSG_WriteBits( msg, c, PS_DELTA_CLASS_BITS );
+			if ( c < PS_DELTA_CLASSES - 1 ) {
+				// biased, signed reads only work on whole bytes
+				MSG_WriteBits( msg, delta + ( 1 << ( psDeltaBits[c] - 1 ) ), psDeltaBits[c] );
+			} else {
+				MSG_WriteShort( msg, toF[j] );
+			}
+		}
+	}
+
+	if ( basestatsbits ) {
+		MSG_WriteBits( msg, 1, 1 );	// changed
+		MSG_WriteBits( msg, basestatsbits, MAX_BASESTATS );
+		for (i=0 ; i<MAX_BASESTATS ; i++)
+			if (basestatsbits & (1<<i) )
+				MSG_WriteFloat( msg, to->baseStats[i] );
+	} else {
+		MSG_WriteBits( msg, 0, 1 );	// no change
+	}
+
+	if ( bufferbits ) {
+		MSG_WriteBits( msg, 1, 1 );	// changed
+		MSG_WriteBits( msg, bufferbits, MAX_RBUFFERS );
+		for (i=0 ; i<MAX_RBUFFERS ; i++)
+			if (bufferbits & (1<<i) )
+				MSG_WriteFloat( msg, to->buffers[i] );
+	} else {
+		MSG_WriteBits( msg, 0, 1 );	// no change
+	}
+}
+
+/*
+=============
+MSG_ReadPackedPlayerstate
+=============
+*/
+static void MSG_ReadPackedPlayerstate( msg_t *msg, playerState_t *from, playerState_t *to ) {
+	int				i, j, c;
+	int				msec;
+	int				bits;
+	int				*fromF, *toF;
+	int				expected;
+	psArrayField_t	*field;
+
+	msec = to->commandTime - from->commandTime;
+
+	// entries that aren't sent only counted down
+	for ( i = 0, field = playerStateArrays ; i < ARRAY_LEN( playerStateArrays ) ; i++, field++ ) {
+		if ( !field->timer ) {
+			continue;
+		}
+		fromF = (int *)( (byte *)from + field->offset );
+		toF = (int *)( (byte *)to + field->offset );
+		for ( j = 0 ; j < field->count ; j++ ) {
+			toF[j] = MSG_PlayerstateExpected( field, fromF[j], msec );
+		}
+	}
+
+	if ( !MSG_ReadBits( msg, 1 ) ) {
+		return;
+	}
+
+	for ( i = 0, field = playerStateArrays ; i < ARRAY_LEN( playerStateArrays ) ; i++, field++ ) {
+		if ( !MSG_ReadBits( msg, 1 ) ) {
+			continue;
+		}
+		LOG( field->name );
+		bits = MSG_ReadBits( msg, field->count );
+
+		fromF = (int *)( (byte *)from + field->offset );
+		toF = (int *)( (byte *)to + field->offset );
+		for ( j = 0 ; j < field->count ; j++ ) {
+			if ( !( bits & ( 1<<j ) ) ) {
+				continue;
+			}
+			c = MSG_ReadBits( msg, PS_DELTA_CLASS_BITS );
+			if ( c < PS_DELTA_CLASSES - 1 ) {
+				expected = MSG_PlayerstateExpected( field, fromF[j], msec );
+				toF[j] = (short)( expected + MSG_ReadBits( msg, psDeltaBits[c] ) - ( 1 << ( psDeltaBits[c] - 1 ) ) );
+			} else {
+				toF[j] = MSG_ReadShort( msg );
+			}
+		}
+	}
+
+	// parse base stats
+	if ( MSG_ReadBits( msg, 1 ) ) {
+		LOG("PS_BASESTATS");
+		bits = MSG_ReadBits (msg, MAX_BASESTATS);
+		for (i=0 ; i<MAX_BASESTATS ; i++) {
+			if (bits & (1<<i) ) {
+				to->baseStats[i] = MSG_ReadFloat(msg);
+			}
+		}
+	}
+
+	// parse buffers
+	if ( MSG_ReadBits( msg, 1 ) ) {
+		LOG("PS_RBUFFERS");
+		bits = MSG_ReadBits (msg, MAX_RBUFFERS);
+		for (i=0 ; i<MAX_RBUFFERS ; i++) {
+			if (bits & (1<<i) ) {
+				to->buffers[i] = MSG_ReadFloat(msg);
+			}
+		}
+	}
+}
+
 /*
 =============
 MSG_WriteDeltaPlayerstate
 
+The arrays are packed for clients of protocol PROTOCOL_PACKED_PLAYERSTATE
+and up, older ones get them the old way.
 =============
 */
-void MSG_WriteDeltaPlayerstate( msg_t *msg, struct playerState_s *from, struct playerState_s *to ) {
+void MSG_WriteDeltaPlayerstate( msg_t *msg, struct playerState_s *from, struct playerState_s *to, int protocol ) {
 	int				i;
 	playerState_t	dummy;
 	int				statsbits;
@@ -1336,6 +1594,11 @@ void MSG_WriteDeltaPlayerstate( msg_t *msg, struct playerState_s *from, struct p
 	//
 	// send the arrays
 	//
+	if ( protocol >= PROTOCOL_PACKED_PLAYERSTATE ) {
+		MSG_WritePackedPlayerstate( msg, from, to );
+		return;
+	}
+
 	statsbits = 0;
 	for (i=0 ; i<MAX_STATS ; i++) {
 		if (to->stats[i] != from->stats[i]) {
@@ -1543,7 +1806,7 @@ void MSG_WriteDeltaPlayerstate( msg_t *msg, struct playerState_s *from, struct p
 MSG_ReadDeltaPlayerstate
 ===================
 */
-void MSG_ReadDeltaPlayerstate (msg_t *msg, playerState_t *from, playerState_t *to ) {
+void MSG_ReadDeltaPlayerstate (msg_t *msg, playerState_t *from, playerState_t *to, int protocol ) {
 	int			i, lc;
 	int			bits;
 	netField_t	*field;
@@ -1622,7 +1885,9 @@ void MSG_ReadDeltaPlayerstate (msg_t *msg, playerState_t *from, playerState_t *t
 
 
 	// read the arrays
-	if (MSG_ReadBits( msg, 1 ) ) {
+	if ( protocol >= PROTOCOL_PACKED_PLAYERSTATE ) {
+		MSG_ReadPackedPlayerstate( msg, from, to );
+	} else if (MSG_ReadBits( msg, 1 ) ) {
 		// parse stats
 		if ( MSG_ReadBits( msg, 1 ) ) {
 			LOG("PS_STATS");
@@ -1767,6 +2032,59 @@ void MSG_ReadDeltaPlayerstate (msg_t *msg, playerState_t *from, playerState_t *t
 	}
 }
 
+static int	psBenchSnapshots;
+static int	psBenchBits[2];		// legacy, packed
+
+/*
+=============
+MSG_BenchmarkPlayerstate
+
+Encodes a playerState delta both ways and keeps the sizes,
+so the encodings can be compared on a demo.
+=============
+*/
+void MSG_BenchmarkPlayerstate( playerState_t *from, playerState_t *to ) {
+	static byte	buf[MAX_MSGLEN];
+	msg_t		msg;
+
+	MSG_Init( &msg, buf, sizeof( buf ) );
+	MSG_WriteDeltaPlayerstate( &msg, from, to, PROTOCOL_PACKED_PLAYERSTATE - 1 );
+	psBenchBits[0] += msg.bit;
+
+	MSG_Init( &msg, buf, sizeof( buf ) );
+	MSG_WriteDeltaPlayerstate( &msg, from, to, PROTOCOL_PACKED_PLAYERSTATE );
+	psBenchBits[1] += msg.bit;
+
+	psBenchSnapshots++;
+}
+
+/*
+=============
+MSG_ReportPlayerstateBenchmark
+
+Prints the average playerState size of both encodings and
+how often each delta width was used, then starts over.
+=============
+*/
+void MSG_ReportPlayerstateBenchmark( void ) {
+	int		i;
+
+	if ( psBenchSnapshots ) {
+		Com_Printf( "playerstate: %i snapshots, %.1f bytes legacy, %.1f bytes packed\n", psBenchSnapshots,
+			psBenchBits[0] / 8.0f / psBenchSnapshots, psBenchBits[1] / 8.0f / psBenchSnapshots );
+		Com_Printf( "%-16s %8s %8s %8s %8s %8s\n", "array", "counted", "4 bit", "8 bit", "12 bit", "full" );
+		for ( i = 0 ; i < ARRAY_LEN( playerStateArrays ) ; i++ ) {
+			Com_Printf( "%-16s %8i %8i %8i %8i %8i\n", playerStateArrays[i].name, psDeltaSkipped[i],
+				psDeltaCounts[i][0], psDeltaCounts[i][1], psDeltaCounts[i][2], psDeltaCounts[i][3] );
+		}
+	}
+
+	psBenchSnapshots = 0;
+	Com_Memset( psBenchBits, 0, sizeof( psBenchBits ) );
+	Com_Memset( psDeltaCounts, 0, sizeof( psDeltaCounts ) );
+	Com_Memset( psDeltaSkipped, 0, sizeof( psDeltaSkipped ) );
+}
+
 int msg_hData[256] = {
 250315,			// 0
 41193,			// 1
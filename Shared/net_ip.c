@@ -20,6 +20,11 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 ===========================================================================
 */
 
+#ifdef __linux__
+	// recvmmsg and sendmmsg are GNU extensions
+#	define _GNU_SOURCE
+#endif
+
 #include "../../Shared/q_shared.h"
 #include "../../Shared/qcommon.h"
 
@@ -89,6 +94,10 @@ typedef int SOCKET;
 typedef int	ioctlarg_t;
 #	define socketError			errno
 
+#	ifdef __linux__
+#		define USE_NET_BATCH
+#	endif
+
 #endif
 
 static qboolean usingSocks = qfalse;
@@ -110,6 +119,9 @@ static cvar_t	*net_mcast6addr;
 static cvar_t	*net_mcast6iface;
 
 static cvar_t	*net_dropsim;
+#ifdef USE_NET_BATCH
+static cvar_t	*net_batch;
+#endif
 
 static struct sockaddr	socksRelayAddr;
 
@@ -132,6 +144,52 @@ static struct sockaddr_in6 boundto;
 
 #define	MAX_IPS		32
 
+// syscall counters, see NET_Stats_f
+typedef struct
+{
+	int recvCalls;
+	int recvPackets;
+	int sendCalls;
+	int sendPackets;
+} netStats_t;
+
+static netStats_t netStats;
+
+#ifdef USE_NET_BATCH
+#define NET_BATCH_PACKETS	16
+#define NET_BATCH_SENDLEN	2048	// larger packets bypass the send batch
+
+// Datagrams drained from one socket with a single recvmmsg. The batch is
+// consumed completely before the next socket is read.
+typedef struct
+{
+	SOCKET			sock;
+	int			count;
+	int			current;
+	struct mmsghdr		hdrs[NET_BATCH_PACKETS];
+	struct iovec		iovs[NET_BATCH_PACKETS];
+	struct sockaddr_storage	addrs[NET_BATCH_PACKETS];
+	byte			data[NET_BATCH_PACKETS][MAX_MSGLEN + 1];
+} netRecvBatch_t;
+
+// Outgoing datagrams queued between NET_BeginSendBatch and
+// NET_EndSendBatch, flushed with sendmmsg.
+typedef struct
+{
+	int			depth;
+	SOCKET			sock;
+	int			count;
+	struct mmsghdr		hdrs[NET_BATCH_PACKETS];
+	struct iovec		iovs[NET_BATCH_PACKETS];
+	struct sockaddr_storage	addrs[NET_BATCH_PACKETS];
+	netadrtype_t		types[NET_BATCH_PACKETS];
+	byte			data[NET_BATCH_PACKETS][NET_BATCH_SENDLEN];
+} netSendBatch_t;
+
+static netRecvBatch_t	recvBatch;
+static netSendBatch_t	sendBatch;
+#endif
+
 typedef struct
 {
 	char ifname[IF_NAMESIZE];
@@ -509,6 +567,87 @@ qboolean	NET_IsLocalAddress( netadr_t adr ) {
 
 //=============================================================================
 
+#ifdef USE_NET_BATCH
+/*
+==================
+NET_GetBatchedPacket
+
+Hand out the next datagram of the receive batch, refilling it from sock
+with a single recvmmsg once it runs dry. Clears sock from fdr when the
+socket has been drained.
+==================
+*/
+static qboolean NET_GetBatchedPacket(SOCKET sock, netadr_t *net_from, msg_t *net_message, fd_set *fdr)
+{
+	netRecvBatch_t	*batch = &recvBatch;
+	struct mmsghdr	*hdr;
+	int		i, ret, err;
+
+	while(1)
+	{
+		if(batch->sock == sock && batch->current < batch->count)
+		{
+			hdr = &batch->hdrs[batch->current];
+			
+			SockadrToNetadr((struct sockaddr *) hdr->msg_hdr.msg_name, net_from);
+			net_message->readcount = 0;
+
+			if(hdr->msg_len >= net_message->maxsize || (hdr->msg_hdr.msg_flags & MSG_TRUNC))
+			{
+				Com_Printf( "Oversize packet from %s\n", NET_AdrToString (*net_from) );
+				batch->current++;
+				continue;
+			}
+
+			Com_Memcpy(net_message->data, batch->data[batch->current], hdr->msg_len);
+			net_message->cursize = hdr->msg_len;
+			batch->current++;
+			return qtrue;
+		}
+
+		if(!FD_ISSET(sock, fdr))
+			return qfalse;
+
+		for(i = 0; i < NET_BATCH_PACKETS; i++)
+		{
+			batch->iovs[i].iov_base = batch->data[i];
+			batch->iovs[i].iov_len = sizeof(batch->data[i]);
+
+			Com_Memset(&batch->hdrs[i], 0, sizeof(batch->hdrs[i]));
+			batch->hdrs[i].msg_hdr.msg_name = &batch->addrs[i];
+			batch->hdrs[i].msg_hdr.msg_namelen = sizeof(batch->addrs[i]);
+			batch->hdrs[i].msg_hdr.msg_iov = &batch->iovs[i];
+			batch->hdrs[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		batch->sock = sock;
+		batch->count = batch->current = 0;
+
+		ret = recvmmsg(sock, batch->hdrs, NET_BATCH_PACKETS, MSG_DONTWAIT, NULL);
+		netStats.recvCalls++;
+
+		if(ret == SOCKET_ERROR)
+		{
+			err = socketError;
+
+			if(err == EAGAIN)
+				FD_CLR(sock, fdr);
+			else if(err != ECONNRESET)
+				Com_Printf( "NET_GetPacket: %s\n", NET_ErrorString() );
+
+			return qfalse;
+		}
+
+		// a short read means the socket is empty, don't poll it again
+		if(ret < NET_BATCH_PACKETS)
+			FD_CLR(sock, fdr);
+
+		batch->count = ret;
+		netStats.recvPackets += ret;
+	}
+}
+#endif
+
 /*
 ==================
 NET_GetPacket
@@ -522,21 +661,40 @@ qboolean NET_GetPacket(netadr_t *net_from, msg_t *net_message, fd_set *fdr)
 	struct sockaddr_storage from;
 	socklen_t	fromlen;
 	int		err;
+
+#ifdef USE_NET_BATCH
+	if(net_batch->integer)
+	{
+		// socks relays need the per-packet header handling below
+		if(ip_socket != INVALID_SOCKET && !usingSocks &&
+		   NET_GetBatchedPacket(ip_socket, net_from, net_message, fdr))
+			return qtrue;
+
+		if(ip6_socket != INVALID_SOCKET &&
+		   NET_GetBatchedPacket(ip6_socket, net_from, net_message, fdr))
+			return qtrue;
+	}
+#endif
 	
 	if(ip_socket != INVALID_SOCKET && FD_ISSET(ip_socket, fdr))
 	{
 		fromlen = sizeof(from);
 		ret = recvfrom( ip_socket, (void *)net_message->data, net_message->maxsize, 0, (struct sockaddr *) &from, &fromlen );
+		netStats.recvCalls++;
 		
 		if (ret == SOCKET_ERROR)
 		{
 			err = socketError;
 
-			if( err != EAGAIN && err != ECONNRESET )
+			if(err == EAGAIN)
+				FD_CLR(ip_socket, fdr);
+			else if(err != ECONNRESET)
 				Com_Printf( "NET_GetPacket: %s\n", NET_ErrorString() );
 		}
 		else
 		{
+			netStats.recvPackets++;
+
 
 			memset( ((struct sockaddr_in *)&from)->sin_zero, 0, 8 );
 		
@@ -571,16 +729,21 @@ qboolean NET_GetPacket(netadr_t *net_from, msg_t *net_message, fd_set *fdr)
 	{
 		fromlen = sizeof(from);
 		ret = recvfrom(ip6_socket, (void *)net_message->data, net_message->maxsize, 0, (struct sockaddr *) &from, &fromlen);
+		netStats.recvCalls++;
 		
 		if (ret == SOCKET_ERROR)
 		{
 			err = socketError;
 
-			if( err != EAGAIN && err != ECONNRESET )
+			if(err == EAGAIN)
+				FD_CLR(ip6_socket, fdr);
+			else if(err != ECONNRESET)
 				Com_Printf( "NET_GetPacket: %s\n", NET_ErrorString() );
 		}
 		else
 		{
+			netStats.recvPackets++;
+
 			SockadrToNetadr((struct sockaddr *) &from, net_from);
 			net_message->readcount = 0;
 		
@@ -599,16 +762,21 @@ qboolean NET_GetPacket(netadr_t *net_from, msg_t *net_message, fd_set *fdr)
 	{
 		fromlen = sizeof(from);
 		ret = recvfrom(multicast6_socket, (void *)net_message->data, net_message->maxsize, 0, (struct sockaddr *) &from, &fromlen);
+		netStats.recvCalls++;
 		
 		if (ret == SOCKET_ERROR)
 		{
 			err = socketError;
 
-			if( err != EAGAIN && err != ECONNRESET )
+			if(err == EAGAIN)
+				FD_CLR(multicast6_socket, fdr);
+			else if(err != ECONNRESET)
 				Com_Printf( "NET_GetPacket: %s\n", NET_ErrorString() );
 		}
 		else
 		{
+			netStats.recvPackets++;
+
 			SockadrToNetadr((struct sockaddr *) &from, net_from);
 			net_message->readcount = 0;
 		
@@ -631,6 +799,141 @@ qboolean NET_GetPacket(netadr_t *net_from, msg_t *net_message, fd_set *fdr)
 
 static char socksBuf[4096];
 
+/*
+==================
+NET_SendError
+==================
+*/
+static void NET_SendError( netadrtype_t type ) {
+	int err = socketError;
+
+	// wouldblock is silent
+	if( err == EAGAIN ) {
+		return;
+	}
+
+	// some PPP links do not allow broadcasts and return an error
+	if( ( err == EADDRNOTAVAIL ) && ( ( type == NA_BROADCAST ) ) ) {
+		return;
+	}
+
+	Com_Printf( "NET_SendPacket: %s\n", NET_ErrorString() );
+}
+
+#ifdef USE_NET_BATCH
+/*
+==================
+NET_FlushSendBatch
+
+Push all queued datagrams out with as few sendmmsg calls as possible.
+A datagram that fails is reported and dropped, like a failed sendto.
+==================
+*/
+static void NET_FlushSendBatch( void ) {
+	netSendBatch_t	*batch = &sendBatch;
+	int		sent = 0, ret;
+
+	while( sent < batch->count ) {
+		ret = sendmmsg( batch->sock, &batch->hdrs[sent], batch->count - sent, 0 );
+		netStats.sendCalls++;
+
+		if( ret == SOCKET_ERROR ) {
+			NET_SendError( batch->types[sent] );
+			sent++;
+		}
+		else if( ret > 0 ) {
+			netStats.sendPackets += ret;
+			sent += ret;
+		}
+		else
+			sent++;
+	}
+
+	batch->count = 0;
+}
+
+/*
+==================
+NET_QueueBatchedPacket
+==================
+*/
+static void NET_QueueBatchedPacket( SOCKET sock, const void *data, int length,
+	const struct sockaddr_storage *addr, socklen_t addrlen, netadrtype_t type ) {
+	netSendBatch_t	*batch = &sendBatch;
+	int		i;
+
+	// a batch only ever targets one socket
+	if( batch->count && batch->sock != sock ) {
+		NET_FlushSendBatch();
+	}
+
+	batch->sock = sock;
+	i = batch->count++;
+
+	Com_Memcpy( batch->data[i], data, length );
+	Com_Memcpy( &batch->addrs[i], addr, addrlen );
+	batch->types[i] = type;
+
+	batch->iovs[i].iov_base = batch->data[i];
+	batch->iovs[i].iov_len = length;
+
+	Com_Memset( &batch->hdrs[i], 0, sizeof( batch->hdrs[i] ) );
+	batch->hdrs[i].msg_hdr.msg_name = &batch->addrs[i];
+	batch->hdrs[i].msg_hdr.msg_namelen = addrlen;
+	batch->hdrs[i].msg_hdr.msg_iov = &batch->iovs[i];
+	batch->hdrs[i].msg_hdr.msg_iovlen = 1;
+
+	if( batch->count == NET_BATCH_PACKETS ) {
+		NET_FlushSendBatch();
+	}
+}
+#endif
+
+/*
+==================
+NET_BeginSendBatch
+
+Packets sent until the matching NET_EndSendBatch may be held back and
+handed to the kernel together. Calls nest.
+==================
+*/
+void NET_BeginSendBatch( void ) {
+#ifdef USE_NET_BATCH
+	sendBatch.depth++;
+#endif
+}
+
+/*
+==================
+NET_EndSendBatch
+==================
+*/
+void NET_EndSendBatch( void ) {
+#ifdef USE_NET_BATCH
+	if( sendBatch.depth > 0 && --sendBatch.depth == 0 && sendBatch.count ) {
+		NET_FlushSendBatch();
+	}
+#endif
+}
+
+/*
+==================
+NET_ResetSendBatch
+
+Closes any batches left open and sends what they held. A Com_Error
+longjmps past the NET_EndSendBatch calls, so the frame that catches
+it calls this.
+==================
+*/
+void NET_ResetSendBatch( void ) {
+#ifdef USE_NET_BATCH
+	sendBatch.depth = 0;
+	if( sendBatch.count ) {
+		NET_FlushSendBatch();
+	}
+#endif
+}
+
 /*
 ==================
 Sys_SendPacket
@@ -657,6 +960,23 @@ void Sys_SendPacket( int length, const void *data, netadr_t to ) {
 	memset(&addr, 0, sizeof(addr));
 	NetadrToSockadr( &to, (struct sockaddr *) &addr );
 
+#ifdef USE_NET_BATCH
+	if( sendBatch.depth && net_batch->integer && length <= NET_BATCH_SENDLEN && !( usingSocks && to.type == NA_IP ) ) {
+		if( addr.ss_family == AF_INET ) {
+			NET_QueueBatchedPacket( ip_socket, data, length, &addr, sizeof(struct sockaddr_in), to.type );
+		}
+		else if( addr.ss_family == AF_INET6 ) {
+			NET_QueueBatchedPacket( ip6_socket, data, length, &addr, sizeof(struct sockaddr_in6), to.type );
+		}
+		return;
+	}
+
+	// keep ordering with anything still waiting in the batch
+	if( sendBatch.count ) {
+		NET_FlushSendBatch();
+	}
+#endif
+
 	if( usingSocks && to.type == NA_IP ) {
 		socksBuf[0] = 0;	// reserved
 		socksBuf[1] = 0;
@@ -673,20 +993,13 @@ void Sys_SendPacket( int length, const void *data, netadr_t to ) {
 		else if(addr.ss_family == AF_INET6)
 			ret = sendto( ip6_socket, data, length, 0, (struct sockaddr *) &addr, sizeof(struct sockaddr_in6) );
 	}
-	if( ret == SOCKET_ERROR ) {
-		int err = socketError;
-
-		// wouldblock is silent
-		if( err == EAGAIN ) {
-			return;
-		}
-
-		// some PPP links do not allow broadcasts and return an error
-		if( ( err == EADDRNOTAVAIL ) && ( ( to.type == NA_BROADCAST ) ) ) {
-			return;
-		}
+	netStats.sendCalls++;
 
-		Com_Printf( "NET_SendPacket: %s\n", NET_ErrorString() );
+	if( ret == SOCKET_ERROR ) {
+		NET_SendError( to.type );
+	}
+	else {
+		netStats.sendPackets++;
 	}
 }
 
@@ -1475,6 +1788,10 @@ static qboolean NET_GetCvars( void ) {
 
 	net_dropsim = Cvar_Get("net_dropsim", "", CVAR_TEMP);
 
+#ifdef USE_NET_BATCH
+	net_batch = Cvar_Get("net_batch", "1", CVAR_ARCHIVE);
+#endif
+
 	return modified ? qtrue : qfalse;
 }
 
@@ -1546,7 +1863,12 @@ void NET_Config( qboolean enableNetworking ) {
 			closesocket( socks_socket );
 			socks_socket = INVALID_SOCKET;
 		}
-		
+
+#ifdef USE_NET_BATCH
+		recvBatch.count = recvBatch.current = 0;
+		sendBatch.count = 0;
+		sendBatch.depth = 0;
+#endif
 	}
 
 	if( start )
@@ -1582,6 +1904,7 @@ void NET_Init( void ) {
 	NET_Config( qtrue );
 	
 	Cmd_AddCommand ("net_restart", NET_Restart_f);
+	Cmd_AddCommand ("net_stats", NET_Stats_f);
 }
 
 
@@ -1617,6 +1940,9 @@ void NET_Event(fd_set *fdr)
 	netadr_t from;
 	msg_t netmsg;
 	
+	// answers to the packets read here go out together
+	NET_BeginSendBatch();
+
 	while(1)
 	{
 		MSG_Init(&netmsg, bufData, sizeof(bufData));
@@ -1638,6 +1964,8 @@ void NET_Event(fd_set *fdr)
 		else
 			break;
 	}
+
+	NET_EndSendBatch();
 }
 
 /*
@@ -1701,3 +2029,23 @@ void NET_Restart_f(void)
 {
 	NET_Config(qtrue);
 }
+
+/*
+====================
+NET_Stats_f
+
+Print the socket syscall counters gathered since the last call and reset them
+====================
+*/
+void NET_Stats_f(void)
+{
+#ifdef USE_NET_BATCH
+	Com_Printf("batched I/O: %s\n", net_batch->integer ? "enabled" : "disabled");
+#else
+	Com_Printf("batched I/O: not supported on this platform\n");
+#endif
+	Com_Printf("recv: %i packets in %i calls\n", netStats.recvPackets, netStats.recvCalls);
+	Com_Printf("send: %i packets in %i calls\n", netStats.sendPackets, netStats.sendCalls);
+
+	Com_Memset(&netStats, 0, sizeof(netStats));
+}
@@ -106,8 +106,10 @@ void MSG_WriteDeltaEntity( msg_t *msg, struct entityState_s *from, struct entity
 void MSG_ReadDeltaEntity( msg_t *msg, entityState_t *from, entityState_t *to, 
 						 int number );
 
-void MSG_WriteDeltaPlayerstate( msg_t *msg, struct playerState_s *from, struct playerState_s *to );
-void MSG_ReadDeltaPlayerstate( msg_t *msg, struct playerState_s *from, struct playerState_s *to );
+void MSG_WriteDeltaPlayerstate( msg_t *msg, struct playerState_s *from, struct playerState_s *to, int protocol );
+void MSG_ReadDeltaPlayerstate( msg_t *msg, struct playerState_s *from, struct playerState_s *to, int protocol );
+void MSG_BenchmarkPlayerstate( struct playerState_s *from, struct playerState_s *to );
+void MSG_ReportPlayerstateBenchmark( void );
 
 
 void MSG_ReportChangeVectors_f( void );
@@ -169,6 +171,7 @@ typedef struct {
 void		NET_Init( void );
 void		NET_Shutdown( void );
 void		NET_Restart_f( void );
+void		NET_Stats_f( void );
 void		NET_Config( qboolean enableNetworking );
 void		NET_FlushPacketQueue(void);
 void		NET_SendPacket (netsrc_t sock, int length, const void *data, netadr_t to);
@@ -186,6 +189,9 @@ qboolean	NET_GetLoopPacket (netsrc_t sock, netadr_t *net_from, msg_t *net_messag
 void		NET_JoinMulticast6(void);
 void		NET_LeaveMulticast6(void);
 void		NET_Sleep(int msec);
+void		NET_BeginSendBatch( void );
+void		NET_EndSendBatch( void );
+void		NET_ResetSendBatch( void );
 
 
 #define	MAX_MSGLEN				32768		// max length of a message, which may
@@ -251,7 +257,8 @@ PROTOCOL
 ==============================================================
 */
 
-#define	PROTOCOL_VERSION	71
+#define	PROTOCOL_VERSION	72
+#define	PROTOCOL_PACKED_PLAYERSTATE	72	// first protocol with delta packed playerState arrays
 #define PROTOCOL_LEGACY_VERSION	68
 // 1.31 - 67
 
@@ -644,6 +651,10 @@ int		FS_FileIsInPAK(const char *filename, int *pChecksum );
 
 int		FS_Write( const void *buffer, int len, fileHandle_t f );
 
+FILE	*FS_FileForHandle( fileHandle_t f );
+// the stdio FILE behind a handle opened for writing, for code that
+// writes it from a thread other than the main one
+
 int		FS_Read2( void *buffer, int len, fileHandle_t f );
 int		FS_Read( void *buffer, int len, fileHandle_t f );
 // properly handles partial reads and reads from other dlls